@@ -0,0 +1,472 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+
+#ifndef _WIN32
+#include <dirent.h>
+#endif
+
+#include "alloc_counter.h"
+#include "arena_db.hpp"
+#include "dbc_generator.h"
+#include "dbcparser.h"
+#include "decoder.h"
+#include "log.hpp"
+#include "stream_writer.h"
+#include "text_normalizer.h"
+#include "vsi_serializer.hpp"
+
+#include <boost/algorithm/string/replace.hpp>
+#include <cereal/archives/binary.hpp>
+#include <cereal/archives/json.hpp>
+#include <cereal/archives/xml.hpp>
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto logger = spdlog::stdout_color_mt("cdb");
+    logger->set_level(spdlog::level::err);
+    return logger;
+}();
+
+// Every heap allocation of the process is counted, see AllocationCounter
+CANDB_COUNTING_OPERATOR_NEW
+
+namespace {
+const char* kReferenceFile = "tesla_can.dbc";
+
+const std::vector<std::string> kDefaultFiles{ "tesla_can.dbc",
+    "acura_ilx_2016_can.dbc", "acura_ilx_2016_nidec.dbc",
+    "gm_global_a_chassis.dbc", "gm_global_a_lowspeed.dbc",
+    "gm_global_a_object.dbc", "gm_global_a_powertrain.dbc",
+    "honda_accord_touring_2016_can.dbc", "honda_civic_touring_2016_can.dbc",
+    "honda_crv_ex_2017_can.dbc", "honda_crv_touring_2016_can.dbc",
+    "subaru_outback_2016_eyesight.dbc", "toyota_prius_2017_can0.dbc",
+    "toyota_prius_2017_can1.dbc" };
+
+std::string loadDBCFile(const std::string& filename)
+{
+    std::fstream file{ filename.c_str() };
+    if (!file.good()) {
+        throw std::runtime_error(
+            fmt::format("File {} does not exists", filename));
+    }
+
+    std::string buff;
+    std::copy(std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>(), std::back_inserter(buff));
+    return buff;
+}
+
+// All *.dbc files of the opendbc checkout, the known list elsewhere
+std::vector<std::string> opendbcFiles()
+{
+    std::vector<std::string> files;
+#ifndef _WIN32
+    if (auto dir = opendir(OPENDBC_DIR)) {
+        while (auto entry = readdir(dir)) {
+            const std::string name{ entry->d_name };
+            if (name.size() > 4 && name.substr(name.size() - 4) == ".dbc") {
+                files.push_back(name);
+            }
+        }
+        closedir(dir);
+    }
+#endif
+    if (files.empty()) {
+        files = kDefaultFiles;
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+const CANdb_t& referenceDb()
+{
+    static const CANdb_t db = [] {
+        CANdb::DBCParser parser;
+        parser.parse(loadDBCFile(std::string{ OPENDBC_DIR } + kReferenceFile));
+        return parser.getDb();
+    }();
+    return db;
+}
+
+// Reports heap allocations per iteration as the "allocs/op" counter
+class AllocationCounter {
+public:
+    explicit AllocationCounter(benchmark::State& state)
+        : _state(state)
+        , _start(CANdb::alloc::current().allocations)
+    {
+    }
+
+    ~AllocationCounter()
+    {
+        const auto count = CANdb::alloc::current().allocations - _start;
+        _state.counters["allocs/op"] = benchmark::Counter(
+            static_cast<double>(count), benchmark::Counter::kAvgIterations);
+    }
+
+private:
+    benchmark::State& _state;
+    std::uint64_t _start;
+};
+
+void BM_Parse(benchmark::State& state, const std::string& data)
+{
+    bool success = true;
+    {
+        AllocationCounter allocations{ state };
+        for (auto _ : state) {
+            CANdb::DBCParser parser;
+            success = parser.parse(data) && success;
+            benchmark::DoNotOptimize(success);
+        }
+    }
+    state.SetBytesProcessed(
+        static_cast<std::int64_t>(state.iterations() * data.size()));
+    if (!success) {
+        state.SkipWithError("parse failed");
+    }
+}
+
+// One parser for all iterations, the grammar is loaded once
+void BM_ParseReused(benchmark::State& state, const std::string& data)
+{
+    CANdb::DBCParser parser;
+    bool success = true;
+    for (auto _ : state) {
+        success = parser.parse(data) && success;
+        benchmark::DoNotOptimize(success);
+    }
+    state.SetBytesProcessed(
+        static_cast<std::int64_t>(state.iterations() * data.size()));
+    if (!success) {
+        state.SkipWithError("parse failed");
+    }
+}
+
+void BM_GetDbCopy(benchmark::State& state)
+{
+    CANdb::DBCParser parser;
+    parser.parse(loadDBCFile(std::string{ OPENDBC_DIR } + kReferenceFile));
+
+    AllocationCounter allocations{ state };
+    for (auto _ : state) {
+        auto db = parser.getDb();
+        benchmark::DoNotOptimize(db);
+    }
+}
+
+template <typename Archive> void BM_Serialize(benchmark::State& state)
+{
+    const auto& db = referenceDb();
+    std::ostringstream os;
+    std::size_t bytes = 0;
+    {
+        AllocationCounter allocations{ state };
+        for (auto _ : state) {
+            os.str("");
+            {
+                Archive ar{ os };
+                ar(db);
+            }
+            bytes += static_cast<std::size_t>(os.tellp());
+        }
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(bytes));
+}
+
+// Streaming writer producing the same document as the cereal archive
+void BM_Stream(benchmark::State& state, bool xml)
+{
+    const auto& db = referenceDb();
+    CANdb::OutputBuffer out;
+    std::size_t bytes = 0;
+    {
+        AllocationCounter allocations{ state };
+        for (auto _ : state) {
+            out.clear();
+            if (xml) {
+                CANdb::writeXml(db, out);
+            } else {
+                CANdb::writeJson(db, out);
+            }
+            bytes += out.str().size();
+        }
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(bytes));
+}
+
+void BM_MessageLookup(benchmark::State& state)
+{
+    const auto& db = referenceDb();
+    std::vector<std::uint32_t> ids;
+    for (const auto& msg : db.messages) {
+        ids.push_back(msg.first.id);
+    }
+    std::shuffle(ids.begin(), ids.end(), std::mt19937{ 42 });
+
+    AllocationCounter allocations{ state };
+    std::size_t i = 0;
+    for (auto _ : state) {
+        const auto it = db.messages.find(CANmessage{ ids[i++ % ids.size()] });
+        benchmark::DoNotOptimize(it);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_SignalLookup(benchmark::State& state)
+{
+    const auto& db = referenceDb();
+    std::vector<std::pair<std::uint32_t, const std::string*>> signals;
+    for (const auto& msg : db.messages) {
+        for (const auto& sig : msg.second) {
+            signals.emplace_back(msg.first.id, &sig.signal_name);
+        }
+    }
+    std::shuffle(signals.begin(), signals.end(), std::mt19937{ 42 });
+
+    AllocationCounter allocations{ state };
+    std::size_t i = 0;
+    for (auto _ : state) {
+        const auto& key = signals[i++ % signals.size()];
+        const auto& msg = db.messages.find(CANmessage{ key.first })->second;
+        const auto it = std::find_if(msg.begin(), msg.end(),
+            [&key](const CANsignal& sig) {
+                return sig.signal_name == *key.second;
+            });
+        benchmark::DoNotOptimize(it);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_Decode(benchmark::State& state)
+{
+    const auto& db = referenceDb();
+    CANdb::Decoder decoder{ db,
+        static_cast<CANdb::Decoder::Mode>(state.range(0)) };
+
+    std::mt19937 rng{ 42 };
+    std::vector<std::pair<std::uint32_t, std::array<std::uint8_t, 8>>> frames;
+    for (std::size_t n = 0; n < 1024; ++n) {
+        for (const auto& msg : db.messages) {
+            std::array<std::uint8_t, 8> payload{};
+            payload[0] = static_cast<std::uint8_t>(rng() % 4);
+            frames.emplace_back(msg.first.id, payload);
+        }
+    }
+
+    AllocationCounter allocations{ state };
+    std::size_t i = 0;
+    std::uint64_t sum = 0;
+    for (auto _ : state) {
+        const auto& frame = frames[i++ % frames.size()];
+        decoder.decode(frame.first, frame.second.data(), frame.second.size(),
+            [&sum](const CANmessage&, const CANsignal&, std::uint64_t raw) {
+                sum += raw;
+            });
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Large synthetic database for the heap vs arena comparison
+const std::string& generatedDbc()
+{
+    static const std::string data = [] {
+        CANdb::GeneratorOptions options;
+        options.messages = 2000;
+        return CANdb::generateDbc(options);
+    }();
+    return data;
+}
+
+// Vendor style file where comments and attributes outweigh the layout
+const std::string& attributeHeavyDbc()
+{
+    static const std::string data = [] {
+        CANdb::GeneratorOptions options;
+        options.messages = 1000;
+        options.commentRatio = 1;
+        options.attributeRatio = 1;
+        options.valueTableRatio = 1;
+        options.commentLength = 200;
+        return CANdb::generateDbc(options);
+    }();
+    return data;
+}
+
+void BM_ParseSections(benchmark::State& state)
+{
+    const auto& data = attributeHeavyDbc();
+    const auto sections = static_cast<unsigned>(state.range(0));
+    AllocationCounter allocations{ state };
+    for (auto _ : state) {
+        CANdb::DBCParser parser;
+        parser.setSections(sections);
+        benchmark::DoNotOptimize(parser.parse(data));
+    }
+    state.SetBytesProcessed(
+        static_cast<std::int64_t>(state.iterations() * data.size()));
+}
+
+void BM_ParseHeap(benchmark::State& state)
+{
+    const auto& data = generatedDbc();
+    AllocationCounter allocations{ state };
+    for (auto _ : state) {
+        CANdb::DBCParser parser;
+        benchmark::DoNotOptimize(parser.parse(data));
+    }
+    state.SetBytesProcessed(
+        static_cast<std::int64_t>(state.iterations() * data.size()));
+}
+
+// The parser and its grammar outlive the loop, only the database is timed
+void BM_TeardownHeap(benchmark::State& state)
+{
+    const auto& data = generatedDbc();
+    CANdb::DBCParser parser;
+    parser.parse(data);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto db = std::make_unique<CANdb_t>(parser.getDb());
+        state.ResumeTiming();
+        db.reset();
+    }
+}
+
+#if CANDB_HAS_PMR
+void BM_ParseArena(benchmark::State& state)
+{
+    const auto& data = generatedDbc();
+    AllocationCounter allocations{ state };
+    for (auto _ : state) {
+        CANdb::ArenaDatabase arena{ data.size() };
+        CANdb::DBCParser parser;
+        benchmark::DoNotOptimize(parser.parse(data, arena.db()));
+    }
+    state.SetBytesProcessed(
+        static_cast<std::int64_t>(state.iterations() * data.size()));
+}
+
+void BM_TeardownArena(benchmark::State& state)
+{
+    const auto& data = generatedDbc();
+    CANdb::DBCParser parser;
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto arena = std::make_unique<CANdb::ArenaDatabase>(data.size());
+        parser.parse(data, arena->db());
+        state.ResumeTiming();
+        arena.reset();
+    }
+}
+#endif
+
+// CRLF file with a Windows-1252 letter every kilobyte
+const std::string& vendorDbc()
+{
+    static const std::string data = [] {
+        CANdb::GeneratorOptions options;
+        options.messages = 1000;
+        options.commentRatio = 1;
+        options.commentLength = 200;
+        options.crlf = true;
+        auto text = CANdb::generateDbc(options);
+        for (std::size_t i = 0; i < text.size(); i += 1024) {
+            if (std::isalpha(static_cast<unsigned char>(text[i])) != 0) {
+                text[i] = '\xE9';
+            }
+        }
+        return text;
+    }();
+    return data;
+}
+
+// Line ending conversion of the parser before normalizeText()
+std::string dos2unix(const std::string& data)
+{
+    std::string out;
+    boost::replace_all_copy(std::back_inserter(out), data, "\r\n", "\n");
+    return out;
+}
+
+void BM_Dos2Unix(benchmark::State& state)
+{
+    const auto& data = vendorDbc();
+    AllocationCounter allocations{ state };
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(dos2unix(data));
+    }
+    state.SetBytesProcessed(
+        static_cast<std::int64_t>(state.iterations() * data.size()));
+}
+
+void BM_Normalize(benchmark::State& state)
+{
+    const auto& data = vendorDbc();
+    const auto encoding = static_cast<CANdb::TextEncoding>(state.range(0));
+    AllocationCounter allocations{ state };
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(CANdb::normalizeText(data, encoding));
+    }
+    state.SetBytesProcessed(
+        static_cast<std::int64_t>(state.iterations() * data.size()));
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    for (const auto& file : opendbcFiles()) {
+        benchmark::RegisterBenchmark(("parse/" + file).c_str(), BM_Parse,
+            loadDBCFile(std::string{ OPENDBC_DIR } + file));
+        benchmark::RegisterBenchmark(("parse/reused/" + file).c_str(),
+            BM_ParseReused, loadDBCFile(std::string{ OPENDBC_DIR } + file));
+    }
+    benchmark::RegisterBenchmark("getDb/copy", BM_GetDbCopy);
+    benchmark::RegisterBenchmark(
+        "serialize/json", BM_Serialize<cereal::JSONOutputArchive>);
+    benchmark::RegisterBenchmark(
+        "serialize/xml", BM_Serialize<cereal::XMLOutputArchive>);
+    benchmark::RegisterBenchmark("serialize/json/stream", BM_Stream, false);
+    benchmark::RegisterBenchmark("serialize/xml/stream", BM_Stream, true);
+    benchmark::RegisterBenchmark(
+        "serialize/binary", BM_Serialize<cereal::BinaryOutputArchive>);
+    benchmark::RegisterBenchmark("serialize/cvsi", BM_Serialize<VSISerializer>);
+    benchmark::RegisterBenchmark("lookup/message", BM_MessageLookup);
+    benchmark::RegisterBenchmark("lookup/signal", BM_SignalLookup);
+    benchmark::RegisterBenchmark("decode", BM_Decode)
+        ->Arg(static_cast<int>(CANdb::Decoder::Mode::Full))
+        ->Arg(static_cast<int>(CANdb::Decoder::Mode::ChangeDetection));
+    benchmark::RegisterBenchmark("sections/full", BM_ParseSections)
+        ->Arg(static_cast<int>(CANdb::kAllSections));
+    benchmark::RegisterBenchmark("sections/layout", BM_ParseSections)
+        ->Arg(static_cast<int>(CANdb::kLayoutOnly));
+    benchmark::RegisterBenchmark("sections/values", BM_ParseSections)
+        ->Arg(static_cast<int>(
+            CANdb::sectionBit(CANdb::Section::ValueDescriptions)));
+    benchmark::RegisterBenchmark("alloc/parse/heap", BM_ParseHeap);
+    benchmark::RegisterBenchmark("alloc/teardown/heap", BM_TeardownHeap);
+#if CANDB_HAS_PMR
+    benchmark::RegisterBenchmark("alloc/parse/arena", BM_ParseArena);
+    benchmark::RegisterBenchmark("alloc/teardown/arena", BM_TeardownArena);
+#endif
+    benchmark::RegisterBenchmark("normalize/dos2unix", BM_Dos2Unix);
+    benchmark::RegisterBenchmark("normalize/utf8", BM_Normalize)
+        ->Arg(static_cast<int>(CANdb::TextEncoding::Utf8));
+    benchmark::RegisterBenchmark("normalize/cp1252", BM_Normalize)
+        ->Arg(static_cast<int>(CANdb::TextEncoding::Windows1252));
+    benchmark::RegisterBenchmark("normalize/detect", BM_Normalize)
+        ->Arg(static_cast<int>(CANdb::TextEncoding::Detect));
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    return EXIT_SUCCESS;
+}
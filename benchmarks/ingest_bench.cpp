@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <unistd.h>
+
+#include "dbcparser.h"
+#include "ingest.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto logger = spdlog::stdout_color_mt("cdb");
+    logger->set_level(spdlog::level::err);
+    return logger;
+}();
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+std::uint64_t now()
+{
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now().time_since_epoch())
+            .count());
+}
+
+std::string loadDBCFile(const std::string& filename)
+{
+    std::fstream file{ filename.c_str() };
+    if (!file.good()) {
+        throw std::runtime_error(
+            fmt::format("File {} does not exists", filename));
+    }
+
+    std::string buff;
+    std::copy(std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>(), std::back_inserter(buff));
+    return buff;
+}
+
+std::uint64_t percentile(const std::vector<std::uint64_t>& sorted, double p)
+{
+    if (sorted.empty()) {
+        return 0;
+    }
+    const auto idx = static_cast<std::size_t>(p * (sorted.size() - 1));
+    return sorted[idx];
+}
+} // namespace
+
+// Usage: ingest_bench [dbc file] [frame count]
+int main(int argc, char* argv[])
+{
+    const std::string file
+        = argc > 1 ? argv[1] : OPENDBC_DIR "tesla_can.dbc";
+    const std::size_t frameCount
+        = argc > 2 ? std::stoul(argv[2]) : std::size_t{ 1000000 };
+
+    CANdb::DBCParser parser;
+    if (!parser.parse(loadDBCFile(file))) {
+        std::cerr << "Unable to parse " << file << std::endl;
+        return EXIT_FAILURE;
+    }
+    const auto db = parser.getDb();
+
+    std::vector<std::uint32_t> ids;
+    for (const auto& msg : db.messages) {
+        ids.push_back(msg.first.id);
+    }
+    if (ids.empty()) {
+        std::cerr << "No messages in " << file << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    for (const auto mode : { CANdb::Decoder::Mode::Full,
+             CANdb::Decoder::Mode::ChangeDetection }) {
+        CANdb::Decoder decoder{ db, mode };
+        std::vector<std::uint64_t> latencies;
+        latencies.reserve(frameCount);
+
+        int fds[2];
+        if (pipe(fds) != 0) {
+            return EXIT_FAILURE;
+        }
+        CANdb::FdFrameSource source{ fds[0] };
+
+        std::uint64_t signals = 0;
+        auto decode = CANdb::makeDecodingConsumer(decoder,
+            [&signals](const CANmessage&, const CANsignal&, std::uint64_t) {
+                ++signals;
+            });
+        CANdb::IngestPipeline pipeline{ source,
+            [&](const CANdb::FrameRecord* frames, std::size_t count) {
+                decode(frames, count);
+                const auto t = now();
+                for (std::size_t i = 0; i < count; ++i) {
+                    latencies.push_back(t - frames[i].timestamp);
+                }
+            } };
+
+        const auto start = Clock::now();
+        pipeline.start();
+
+        // Periodic traffic: every id cycles, most payloads repeat
+        std::mt19937 rng{ 42 };
+        std::vector<CANdb::FrameRecord> batch(64);
+        std::vector<std::uint8_t> counters(ids.size());
+        for (std::size_t sent = 0; sent < frameCount;) {
+            const auto n = std::min(batch.size(), frameCount - sent);
+            for (std::size_t i = 0; i < n; ++i) {
+                const auto slot = (sent + i) % ids.size();
+                auto& frame = batch[i];
+                frame = CANdb::FrameRecord{};
+                frame.id = ids[slot];
+                frame.dlc = 8;
+                if (rng() % 8 == 0) {
+                    ++counters[slot];
+                }
+                frame.payload[0] = counters[slot];
+                frame.timestamp = now();
+            }
+            CANdb::writeFrames(fds[1], batch.data(), n);
+            sent += n;
+        }
+        close(fds[1]);
+        pipeline.join();
+        close(fds[0]);
+
+        const auto elapsed = std::chrono::duration<double>(
+            Clock::now() - start)
+                                 .count();
+        std::sort(latencies.begin(), latencies.end());
+
+        std::cout << fmt::format(
+            "{:<16} frames={} signals={} throughput={:.0f} frames/s "
+            "p50={}ns p90={}ns p99={}ns p99.9={}ns max={}ns\n",
+            mode == CANdb::Decoder::Mode::Full ? "full" : "change-detect",
+            latencies.size(), signals, latencies.size() / elapsed,
+            percentile(latencies, 0.5), percentile(latencies, 0.9),
+            percentile(latencies, 0.99), percentile(latencies, 0.999),
+            latencies.empty() ? 0 : latencies.back());
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+#include "alloc_counter.h"
+#include "dbc_generator.h"
+#include "dbcparser.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto logger = spdlog::stdout_color_mt("cdb");
+    logger->set_level(spdlog::level::err);
+    return logger;
+}();
+
+CANDB_COUNTING_OPERATOR_NEW
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct Sample {
+    std::size_t messages;
+    std::size_t bytes;
+    double ms;
+    std::size_t peak;
+};
+
+std::string bar(double value, double max, std::size_t width)
+{
+    const auto n = max > 0 ? static_cast<std::size_t>(value / max * width) : 0;
+    return std::string(std::max<std::size_t>(n, 1), '#');
+}
+} // namespace
+
+// Usage: scaling_bench [max messages] [signals per message] [csv file]
+int main(int argc, char* argv[])
+{
+    const std::size_t maxMessages
+        = argc > 1 ? std::stoul(argv[1]) : std::size_t{ 16000 };
+    const std::size_t signals
+        = argc > 2 ? std::stoul(argv[2]) : std::size_t{ 16 };
+
+    std::vector<Sample> samples;
+    for (std::size_t messages = 250; messages <= maxMessages; messages *= 2) {
+        CANdb::GeneratorOptions options;
+        options.messages = messages;
+        options.signalsPerMessage = signals;
+        options.multiplexedRatio = 0.1;
+        options.commentRatio = 0.3;
+        options.attributeRatio = 0.5;
+        options.valueTableRatio = 0.2;
+        options.crlf = true;
+        const auto dbc = CANdb::generateDbc(options);
+
+        CANdb::AllocationScope allocations;
+        const auto start = Clock::now();
+        bool success;
+        {
+            CANdb::DBCParser parser;
+            success = parser.parse(dbc);
+        }
+        const std::chrono::duration<double, std::milli> elapsed
+            = Clock::now() - start;
+        if (!success) {
+            std::cerr << "Parse of " << messages << " messages failed"
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+        samples.push_back(Sample{
+            messages, dbc.size(), elapsed.count(), allocations.peakBytes() });
+    }
+    if (samples.empty()) {
+        return EXIT_FAILURE;
+    }
+
+    // Exponent k of time ~ size^k between neighbouring samples, k > 1 means
+    // superlinear growth
+    std::cout << fmt::format("{:>9} {:>9} {:>9} {:>11} {:>9} {:>11} {:>6}\n",
+        "messages", "signals", "MB", "parse ms", "ns/byte", "peak MB", "k");
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        const auto& s = samples[i];
+        std::string k = "-";
+        if (i > 0) {
+            const auto& p = samples[i - 1];
+            k = fmt::format("{:.2f}",
+                std::log(s.ms / p.ms)
+                    / std::log(static_cast<double>(s.bytes) / p.bytes));
+        }
+        std::cout << fmt::format(
+            "{:>9} {:>9} {:>9.2f} {:>11.1f} {:>9.1f} {:>11.1f} {:>6}\n",
+            s.messages, s.messages * signals, s.bytes / 1e6, s.ms,
+            s.ms * 1e6 / s.bytes, s.peak / 1e6, k);
+    }
+
+    const auto maxMs = samples.back().ms;
+    const auto maxPeak = static_cast<double>(samples.back().peak);
+    std::cout << "\nparse time\n";
+    for (const auto& s : samples) {
+        std::cout << fmt::format("{:>9} {}\n", s.messages, bar(s.ms, maxMs, 60));
+    }
+    std::cout << "\npeak memory\n";
+    for (const auto& s : samples) {
+        std::cout << fmt::format(
+            "{:>9} {}\n", s.messages, bar(s.peak, maxPeak, 60));
+    }
+
+    if (argc > 3) {
+        std::ofstream csv{ argv[3] };
+        csv << "messages,signals,bytes,parse_ms,peak_bytes\n";
+        for (const auto& s : samples) {
+            csv << fmt::format("{},{},{},{:.3f},{}\n", s.messages,
+                s.messages * signals, s.bytes, s.ms, s.peak);
+        }
+    }
+    return EXIT_SUCCESS;
+}
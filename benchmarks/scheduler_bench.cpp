@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <random>
+
+#include "dbcparser.h"
+#include "log.hpp"
+#include "scheduler.h"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto logger = spdlog::stdout_color_mt("cdb");
+    logger->set_level(spdlog::level::err);
+    return logger;
+}();
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+const std::vector<std::string> kDefaultFiles{ "tesla_can.dbc",
+    "acura_ilx_2016_can.dbc", "gm_global_a_chassis.dbc",
+    "gm_global_a_powertrain.dbc", "honda_civic_touring_2016_can.dbc",
+    "subaru_outback_2016_eyesight.dbc", "toyota_prius_2017_can0.dbc" };
+
+std::string loadDBCFile(const std::string& filename)
+{
+    std::fstream file{ filename.c_str() };
+    if (!file.good()) {
+        throw std::runtime_error(
+            fmt::format("File {} does not exists", filename));
+    }
+
+    std::string buff;
+    std::copy(std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>(), std::back_inserter(buff));
+    return buff;
+}
+
+// Merges all databases, the first definition of an id wins
+CANdb_t loadDatabases(const std::vector<std::string>& files)
+{
+    CANdb_t merged;
+    for (const auto& file : files) {
+        CANdb::DBCParser parser;
+        if (!parser.parse(loadDBCFile(file))) {
+            std::cerr << "Skipping " << file << ", parse failed" << std::endl;
+            continue;
+        }
+        for (const auto& msg : parser.getDb().messages) {
+            merged.messages.insert(msg);
+        }
+    }
+    return merged;
+}
+
+/**
+ * Synthetic bus traffic: ids are drawn from a Zipf-like distribution so a
+ * few ids dominate, payload bytes change now and then.
+ */
+std::vector<CANdb::FrameRecord> makeTraffic(
+    const CANdb_t& db, std::size_t count)
+{
+    std::vector<const CANmessage*> messages;
+    for (const auto& msg : db.messages) {
+        messages.push_back(&msg.first);
+    }
+
+    std::vector<double> weights;
+    for (std::size_t i = 0; i < messages.size(); ++i) {
+        weights.push_back(1.0 / (i + 1));
+    }
+    std::mt19937 rng{ 42 };
+    std::discrete_distribution<std::size_t> pick{ weights.begin(),
+        weights.end() };
+
+    std::vector<CANdb::FrameRecord> frames(count);
+    for (auto& frame : frames) {
+        const auto& msg = *messages[pick(rng)];
+        frame.id = msg.id;
+        frame.dlc = static_cast<std::uint8_t>(std::min<std::uint32_t>(msg.dlc, 8));
+        for (std::size_t b = 0; b < frame.dlc; ++b) {
+            frame.payload[b] = static_cast<std::uint8_t>(rng() % 4);
+        }
+    }
+    return frames;
+}
+} // namespace
+
+// Usage: scheduler_bench [frame count] [dbc files...]
+int main(int argc, char* argv[])
+{
+    const std::size_t frameCount
+        = argc > 1 ? std::stoul(argv[1]) : std::size_t{ 2000000 };
+
+    std::vector<std::string> files;
+    for (int i = 2; i < argc; ++i) {
+        files.push_back(argv[i]);
+    }
+    if (files.empty()) {
+        for (const auto& file : kDefaultFiles) {
+            files.push_back(OPENDBC_DIR + file);
+        }
+    }
+
+    const auto db = loadDatabases(files);
+    if (db.messages.empty()) {
+        std::cerr << "No messages loaded" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const auto traffic = makeTraffic(db, frameCount);
+
+    const auto maxWorkers
+        = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    double baseline = 0;
+
+    for (std::size_t workers = 1; workers <= maxWorkers; workers *= 2) {
+        const std::size_t lanesPerWorker = 8;
+        std::vector<CANdb::Decoder> decoders;
+        for (std::size_t i = 0; i < workers * lanesPerWorker; ++i) {
+            decoders.emplace_back(db, CANdb::Decoder::Mode::Full);
+        }
+
+        std::atomic<std::uint64_t> signals{ 0 };
+        const auto start = Clock::now();
+        {
+            CANdb::DecodeScheduler scheduler{ workers,
+                CANdb::makeDecodingHandler(decoders,
+                    [&signals](const CANmessage&, const CANsignal&,
+                        std::uint64_t) {
+                        signals.fetch_add(1, std::memory_order_relaxed);
+                    }),
+                lanesPerWorker };
+            scheduler.submit(traffic.data(), traffic.size());
+            scheduler.finish();
+
+            const auto elapsed
+                = std::chrono::duration<double>(Clock::now() - start).count();
+            const auto rate = traffic.size() / elapsed;
+            if (workers == 1) {
+                baseline = rate;
+            }
+
+            const auto stats = scheduler.stats();
+            const auto busiest = *std::max_element(
+                stats.framesPerWorker.begin(), stats.framesPerWorker.end());
+            std::cout << fmt::format(
+                "workers={:<3} frames/s={:<12.0f} speedup={:.2f} "
+                "signals={} stolen={} busiest-worker-share={:.2f}\n",
+                workers, rate, rate / baseline, signals.load(),
+                stats.stolenBatches,
+                static_cast<double>(busiest) / traffic.size());
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
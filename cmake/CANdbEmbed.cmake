@@ -0,0 +1,21 @@
+# candb_embed_dbc(<target> <file.dbc>)
+#
+# Compiles file.dbc into constant tables at build time and adds them to
+# target. The database is read with CANdb::embedded::<name>(), where name is
+# the file name without extension made a C identifier, declared with
+# CANDB_DECLARE_EMBEDDED_DBC(<name>) from embedded_db.h.
+function(candb_embed_dbc target dbc_file)
+    get_filename_component(dbc_path ${dbc_file} ABSOLUTE)
+    get_filename_component(dbc_name ${dbc_file} NAME_WE)
+    string(MAKE_C_IDENTIFIER ${dbc_name} symbol)
+    set(output ${CMAKE_CURRENT_BINARY_DIR}/embedded_${symbol}.cpp)
+
+    add_custom_command(
+        OUTPUT ${output}
+        COMMAND dbcembed -i ${dbc_path} -o ${output} -n ${symbol}
+        DEPENDS dbcembed ${dbc_path}
+        COMMENT "Embedding ${dbc_name}.dbc"
+        VERBATIM)
+    target_sources(${target} PRIVATE ${output})
+    target_link_libraries(${target} CANdbc)
+endfunction()
@@ -0,0 +1,60 @@
+#include "alloc_counter.h"
+
+#include <atomic>
+
+using namespace CANdb;
+
+namespace {
+std::atomic<bool> gInstalled{ false };
+std::atomic<std::uint64_t> gAllocations{ 0 };
+std::atomic<std::size_t> gLive{ 0 };
+std::atomic<std::size_t> gPeak{ 0 };
+} // namespace
+
+void alloc::onAllocate(std::size_t size) noexcept
+{
+    gInstalled.store(true, std::memory_order_relaxed);
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+
+    const auto live = gLive.fetch_add(size, std::memory_order_relaxed) + size;
+    auto peak = gPeak.load(std::memory_order_relaxed);
+    while (live > peak
+        && !gPeak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+void alloc::onDeallocate(std::size_t size) noexcept
+{
+    gLive.fetch_sub(size, std::memory_order_relaxed);
+}
+
+bool alloc::hooksInstalled() noexcept
+{
+    return gInstalled.load(std::memory_order_relaxed);
+}
+
+AllocationStats alloc::current() noexcept
+{
+    AllocationStats stats;
+    stats.allocations = gAllocations.load(std::memory_order_relaxed);
+    stats.liveBytes = gLive.load(std::memory_order_relaxed);
+    stats.peakBytes = gPeak.load(std::memory_order_relaxed);
+    return stats;
+}
+
+AllocationScope::AllocationScope() noexcept
+{
+    gPeak.store(gLive.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    _start = alloc::current();
+}
+
+std::size_t AllocationScope::peakBytes() const noexcept
+{
+    const auto peak = gPeak.load(std::memory_order_relaxed);
+    return peak > _start.liveBytes ? peak - _start.liveBytes : 0;
+}
+
+std::uint64_t AllocationScope::allocations() const noexcept
+{
+    return gAllocations.load(std::memory_order_relaxed) - _start.allocations;
+}
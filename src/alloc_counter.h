@@ -0,0 +1,78 @@
+#ifndef ALLOC_COUNTER_H_R7MZP2WA
+#define ALLOC_COUNTER_H_R7MZP2WA
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace CANdb {
+
+/**
+ * Process-wide allocation counters. The library never replaces the global
+ * operator new itself, an executable opts in by expanding
+ * CANDB_COUNTING_OPERATOR_NEW once in one of its translation units.
+ */
+struct AllocationStats {
+    std::uint64_t allocations{ 0 };
+    std::size_t liveBytes{ 0 };
+    std::size_t peakBytes{ 0 };
+};
+
+namespace alloc {
+    void onAllocate(std::size_t size) noexcept;
+    void onDeallocate(std::size_t size) noexcept;
+
+    // True once the counting operator new has seen an allocation
+    bool hooksInstalled() noexcept;
+
+    AllocationStats current() noexcept;
+} // namespace alloc
+
+/**
+ * Peak heap growth and allocation count between construction and the calls
+ * to peakBytes()/allocations(). Scopes must not overlap, they share the
+ * global peak.
+ */
+class AllocationScope {
+public:
+    AllocationScope() noexcept;
+
+    std::size_t peakBytes() const noexcept;
+    std::uint64_t allocations() const noexcept;
+
+private:
+    AllocationStats _start;
+};
+
+} // namespace CANdb
+
+// Size header keeps the allocation size for operator delete
+#define CANDB_COUNTING_OPERATOR_NEW                                            \
+    void* operator new(std::size_t size)                                       \
+    {                                                                          \
+        constexpr std::size_t header = alignof(std::max_align_t);              \
+        auto p = static_cast<char*>(std::malloc(size + header));               \
+        if (p == nullptr) {                                                    \
+            throw std::bad_alloc();                                            \
+        }                                                                      \
+        *reinterpret_cast<std::size_t*>(p) = size;                             \
+        CANdb::alloc::onAllocate(size);                                        \
+        return p + header;                                                     \
+    }                                                                          \
+    void operator delete(void* ptr) noexcept                                   \
+    {                                                                          \
+        if (ptr == nullptr) {                                                  \
+            return;                                                            \
+        }                                                                      \
+        constexpr std::size_t header = alignof(std::max_align_t);              \
+        auto p = static_cast<char*>(ptr) - header;                             \
+        CANdb::alloc::onDeallocate(*reinterpret_cast<std::size_t*>(p));        \
+        std::free(p);                                                          \
+    }                                                                          \
+    void operator delete(void* ptr, std::size_t) noexcept                      \
+    {                                                                          \
+        operator delete(ptr);                                                  \
+    }
+
+#endif /* end of include guard: ALLOC_COUNTER_H_R7MZP2WA */
@@ -0,0 +1,53 @@
+#ifndef ARENA_DB_HPP_Q4TZ8MCE
+#define ARENA_DB_HPP_Q4TZ8MCE
+
+#include "cantypes.hpp"
+
+#if CANDB_HAS_PMR
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+
+namespace CANdb {
+
+/**
+ * Database living entirely in a monotonic arena. Strings, signal vectors and
+ * map nodes are bump allocated from consecutive blocks, which keeps a parsed
+ * database close together in memory. The database destructor is never run:
+ * destroying the ArenaDatabase releases the arena blocks in one step instead
+ * of freeing every node separately.
+ *
+ *     ArenaDatabase arena;
+ *     DBCParser parser;
+ *     parser.parse(dbcFile, arena.db());
+ */
+class ArenaDatabase {
+public:
+    explicit ArenaDatabase(std::size_t initialSize = 64 * 1024,
+        std::pmr::memory_resource* upstream
+        = std::pmr::get_default_resource())
+        : _arena(initialSize, upstream)
+        , _db(new (_arena.allocate(sizeof(pmr::CANdb_t), alignof(pmr::CANdb_t)))
+                  pmr::CANdb_t(&_arena))
+    {
+    }
+
+    ArenaDatabase(const ArenaDatabase&) = delete;
+    ArenaDatabase& operator=(const ArenaDatabase&) = delete;
+
+    pmr::CANdb_t& db() noexcept { return *_db; }
+    const pmr::CANdb_t& db() const noexcept { return *_db; }
+
+    std::pmr::memory_resource* resource() noexcept { return &_arena; }
+
+private:
+    std::pmr::monotonic_buffer_resource _arena;
+    pmr::CANdb_t* _db;
+};
+
+} // namespace CANdb
+
+#endif
+
+#endif /* end of include guard: ARENA_DB_HPP_Q4TZ8MCE */
@@ -0,0 +1,349 @@
+#include "attributes.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+
+using namespace CANdb;
+
+namespace {
+const char kSeparators[] = " \t\r\n,;";
+
+struct Token {
+    std::string text;
+    bool quoted;
+};
+
+// Splits a statement into words and quoted strings, ',' and ';' separate
+std::vector<Token> tokenize(const std::string& statement)
+{
+    std::vector<Token> tokens;
+    std::size_t i = 0;
+    while (i < statement.size()) {
+        const auto c = statement[i];
+        if (c == '"') {
+            const auto end = statement.find('"', i + 1);
+            if (end == std::string::npos) {
+                return {};
+            }
+            tokens.push_back(
+                Token{ statement.substr(i + 1, end - i - 1), true });
+            i = end + 1;
+        } else if (std::strchr(kSeparators, c) != nullptr) {
+            ++i;
+        } else {
+            auto end = i;
+            while (end < statement.size()
+                && std::strchr(kSeparators, statement[end]) == nullptr
+                && statement[end] != '"') {
+                ++end;
+            }
+            tokens.push_back(Token{ statement.substr(i, end - i), false });
+            i = end;
+        }
+    }
+    return tokens;
+}
+
+bool objectKind(const Token& token, ObjectKind& kind)
+{
+    if (token.quoted) {
+        return false;
+    }
+    if (token.text == "BO_") {
+        kind = ObjectKind::Message;
+    } else if (token.text == "SG_") {
+        kind = ObjectKind::Signal;
+    } else if (token.text == "BU_") {
+        kind = ObjectKind::Node;
+    } else if (token.text == "EV_") {
+        kind = ObjectKind::EnvVar;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool toInteger(const std::string& text, std::int64_t& value)
+{
+    if (text.empty()) {
+        return false;
+    }
+    const auto hex = text.size() > 2 && text[0] == '0'
+        && (text[1] == 'x' || text[1] == 'X');
+    char* end = nullptr;
+    value = std::strtoll(text.c_str(), &end, hex ? 16 : 10);
+    if (*end == '.') {
+        value = static_cast<std::int64_t>(std::strtod(text.c_str(), &end));
+    }
+    return *end == '\0';
+}
+
+bool toReal(const std::string& text, double& value)
+{
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return *end == '\0';
+}
+} // namespace
+
+const char* CANdb::toString(AttributeType type) noexcept
+{
+    switch (type) {
+    case AttributeType::Int:
+        return "INT";
+    case AttributeType::Hex:
+        return "HEX";
+    case AttributeType::Float:
+        return "FLOAT";
+    case AttributeType::String:
+        return "STRING";
+    case AttributeType::Enum:
+        return "ENUM";
+    }
+    return "unknown";
+}
+
+const char* CANdb::toString(ObjectKind kind) noexcept
+{
+    switch (kind) {
+    case ObjectKind::Network:
+        return "network";
+    case ObjectKind::Node:
+        return "node";
+    case ObjectKind::Message:
+        return "message";
+    case ObjectKind::Signal:
+        return "signal";
+    case ObjectKind::EnvVar:
+        return "environment variable";
+    }
+    return "unknown";
+}
+
+std::size_t AttributeStore::KeyHash::operator()(const Key& key) const noexcept
+{
+    auto h = std::hash<std::string>{}(key.name);
+    const auto mix = [&h](std::uint64_t v) {
+        h ^= static_cast<std::size_t>(v) + 0x9e3779b97f4a7c15ull + (h << 6)
+            + (h >> 2);
+    };
+    mix(key.attribute);
+    mix(static_cast<std::uint64_t>(key.kind));
+    mix(key.id);
+    return h;
+}
+
+bool AttributeStore::define(const std::string& statement)
+{
+    // BA_DEF_ [BO_|SG_|BU_|EV_] "name" TYPE [min max | "enum", ...];
+    const auto tokens = tokenize(statement);
+    std::size_t i = 1;
+    if (tokens.size() < 3 || tokens[0].text != "BA_DEF_") {
+        return false;
+    }
+
+    AttributeDefinition definition;
+    definition.kind = ObjectKind::Network;
+    if (objectKind(tokens[i], definition.kind)) {
+        ++i;
+    }
+    if (i + 1 >= tokens.size() || !tokens[i].quoted) {
+        return false;
+    }
+    definition.name = tokens[i++].text;
+
+    const auto& type = tokens[i++].text;
+    if (type == "INT") {
+        definition.type = AttributeType::Int;
+    } else if (type == "HEX") {
+        definition.type = AttributeType::Hex;
+    } else if (type == "FLOAT") {
+        definition.type = AttributeType::Float;
+    } else if (type == "STRING") {
+        definition.type = AttributeType::String;
+    } else if (type == "ENUM") {
+        definition.type = AttributeType::Enum;
+    } else {
+        return false;
+    }
+
+    if (definition.type == AttributeType::Enum) {
+        for (; i < tokens.size(); ++i) {
+            definition.enumValues.push_back(tokens[i].text);
+        }
+    } else if (definition.type != AttributeType::String
+        && i + 1 < tokens.size()) {
+        if (!toReal(tokens[i].text, definition.min)
+            || !toReal(tokens[i + 1].text, definition.max)) {
+            return false;
+        }
+    }
+
+    const auto existing = _ids.find(definition.name);
+    if (existing != _ids.end()) {
+        _definitions[existing->second] = std::move(definition);
+    } else {
+        _ids.emplace(
+            definition.name, static_cast<std::uint32_t>(_definitions.size()));
+        _definitions.push_back(std::move(definition));
+    }
+    return true;
+}
+
+bool AttributeStore::convert(const AttributeDefinition& definition,
+    const std::string& token, bool quoted, AttributeValue& value) const
+{
+    value.type = definition.type;
+    switch (definition.type) {
+    case AttributeType::Int:
+    case AttributeType::Hex:
+        if (!toInteger(token, value.integer)) {
+            return false;
+        }
+        value.real = static_cast<double>(value.integer);
+        return true;
+    case AttributeType::Float:
+        if (!toReal(token, value.real)) {
+            return false;
+        }
+        value.integer = static_cast<std::int64_t>(value.real);
+        return true;
+    case AttributeType::String:
+        value.text = token;
+        return true;
+    case AttributeType::Enum: {
+        // Defaults name the enum value, assignments give its index
+        const auto& names = definition.enumValues;
+        if (quoted) {
+            const auto it = std::find(names.begin(), names.end(), token);
+            if (it == names.end()) {
+                return false;
+            }
+            value.integer = it - names.begin();
+        } else if (!toInteger(token, value.integer) || value.integer < 0
+            || static_cast<std::size_t>(value.integer) >= names.size()) {
+            return false;
+        }
+        value.real = static_cast<double>(value.integer);
+        value.text = names[static_cast<std::size_t>(value.integer)];
+        return true;
+    }
+    }
+    return false;
+}
+
+bool AttributeStore::setDefault(const std::string& statement)
+{
+    // BA_DEF_DEF_ "name" value;
+    const auto tokens = tokenize(statement);
+    if (tokens.size() != 3 || tokens[0].text != "BA_DEF_DEF_"
+        || !tokens[1].quoted) {
+        return false;
+    }
+    const auto it = _ids.find(tokens[1].text);
+    if (it == _ids.end()) {
+        return false;
+    }
+    auto& definition = _definitions[it->second];
+    AttributeValue value;
+    if (!convert(definition, tokens[2].text, tokens[2].quoted, value)) {
+        return false;
+    }
+    definition.defaultValue = std::move(value);
+    definition.hasDefault = true;
+    return true;
+}
+
+bool AttributeStore::set(const std::string& statement)
+{
+    // BA_ "name" [BO_ id | SG_ id signal | BU_ node | EV_ var] value;
+    const auto tokens = tokenize(statement);
+    if (tokens.size() < 3 || tokens[0].text != "BA_" || !tokens[1].quoted) {
+        return false;
+    }
+    const auto it = _ids.find(tokens[1].text);
+    if (it == _ids.end()) {
+        return false;
+    }
+
+    Key key{ it->second, ObjectKind::Network, 0, {} };
+    std::size_t i = 2;
+    if (tokens.size() > 3 && objectKind(tokens[i], key.kind)) {
+        ++i;
+        const auto numbered = key.kind == ObjectKind::Message
+            || key.kind == ObjectKind::Signal;
+        std::int64_t id = 0;
+        if (numbered && !toInteger(tokens[i++].text, id)) {
+            return false;
+        }
+        key.id = static_cast<std::uint32_t>(id);
+        if (key.kind != ObjectKind::Message && i < tokens.size()) {
+            key.name = tokens[i++].text;
+        }
+    }
+    if (i + 1 != tokens.size()) {
+        return false;
+    }
+
+    AttributeValue value;
+    if (!convert(_definitions[it->second], tokens[i].text, tokens[i].quoted,
+            value)) {
+        return false;
+    }
+    _values[std::move(key)] = std::move(value);
+    return true;
+}
+
+std::size_t AttributeStore::id(const std::string& attribute) const noexcept
+{
+    const auto it = _ids.find(attribute);
+    return it == _ids.end() ? kNoAttribute : it->second;
+}
+
+const AttributeDefinition* AttributeStore::definition(
+    const std::string& attribute) const noexcept
+{
+    const auto i = id(attribute);
+    return i == kNoAttribute ? nullptr : &_definitions[i];
+}
+
+const AttributeValue* AttributeStore::find(
+    std::size_t attribute, const ObjectRef& object) const
+{
+    if (attribute >= _definitions.size()) {
+        return nullptr;
+    }
+    const auto it = _values.find(Key{ static_cast<std::uint32_t>(attribute),
+        object.kind, object.id, object.name });
+    if (it != _values.end()) {
+        return &it->second;
+    }
+    const auto& definition = _definitions[attribute];
+    return definition.hasDefault ? &definition.defaultValue : nullptr;
+}
+
+const AttributeValue* AttributeStore::find(
+    const std::string& attribute, const ObjectRef& object) const
+{
+    return find(id(attribute), object);
+}
+
+AttributeColumn AttributeStore::messageColumn(const std::string& attribute,
+    const std::vector<std::uint32_t>& messageIds) const
+{
+    AttributeColumn column;
+    column.ids = messageIds;
+    column.values.reserve(messageIds.size());
+
+    const auto i = id(attribute);
+    for (const auto messageId : messageIds) {
+        const auto value = find(i, ObjectRef::message(messageId));
+        column.values.push_back(value != nullptr ? value->real : 0.0);
+    }
+    return column;
+}
@@ -0,0 +1,147 @@
+#ifndef ATTRIBUTES_H_C3LZ6QKR
+#define ATTRIBUTES_H_C3LZ6QKR
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CANdb {
+
+enum class AttributeType { Int, Hex, Float, String, Enum };
+enum class ObjectKind : std::uint8_t { Network, Node, Message, Signal, EnvVar };
+
+const char* toString(AttributeType type) noexcept;
+const char* toString(ObjectKind kind) noexcept;
+
+struct AttributeValue {
+    AttributeType type{ AttributeType::Int };
+    std::int64_t integer{ 0 }; // Int, Hex and the index of an Enum
+    double real{ 0 }; // Float, integers converted
+    std::string text; // String and the name of an Enum
+};
+
+struct AttributeDefinition {
+    std::string name;
+    ObjectKind kind;
+    AttributeType type;
+    double min{ 0 };
+    double max{ 0 };
+    std::vector<std::string> enumValues;
+    bool hasDefault{ false };
+    AttributeValue defaultValue;
+};
+
+// Object an attribute is attached to. Signals are identified by message id
+// and name, nodes and environment variables by name.
+struct ObjectRef {
+    ObjectKind kind;
+    std::uint32_t id;
+    std::string name;
+
+    static ObjectRef network() { return { ObjectKind::Network, 0, {} }; }
+    static ObjectRef message(std::uint32_t id)
+    {
+        return { ObjectKind::Message, id, {} };
+    }
+    static ObjectRef signal(std::uint32_t messageId, const std::string& name)
+    {
+        return { ObjectKind::Signal, messageId, name };
+    }
+    static ObjectRef node(const std::string& name)
+    {
+        return { ObjectKind::Node, 0, name };
+    }
+    static ObjectRef envVar(const std::string& name)
+    {
+        return { ObjectKind::EnvVar, 0, name };
+    }
+};
+
+// One attribute of many objects, values[i] belongs to ids[i]
+struct AttributeColumn {
+    std::vector<std::uint32_t> ids;
+    std::vector<double> values;
+};
+
+/**
+ * Typed BA_DEF_/BA_DEF_DEF_/BA_ attributes of a database. Values are
+ * converted to the type of their definition, enum values keep index and
+ * name. Lookups hash (attribute, object kind, id, name) into one table, so
+ * find() is a single probe once the attribute id is known.
+ */
+class AttributeStore {
+public:
+    static constexpr std::size_t kNoAttribute = ~std::size_t{ 0 };
+
+    // Statement parsers, false if the statement is malformed or references
+    // an undefined attribute
+    bool define(const std::string& statement);
+    bool setDefault(const std::string& statement);
+    bool set(const std::string& statement);
+
+    bool empty() const noexcept { return _definitions.empty(); }
+    std::size_t size() const noexcept { return _values.size(); }
+
+    const std::vector<AttributeDefinition>& definitions() const noexcept
+    {
+        return _definitions;
+    }
+
+    std::size_t id(const std::string& attribute) const noexcept;
+    const AttributeDefinition* definition(const std::string& attribute) const
+        noexcept;
+
+    // Value set for object, otherwise the default, nullptr without both
+    const AttributeValue* find(
+        std::size_t attribute, const ObjectRef& object) const;
+    const AttributeValue* find(
+        const std::string& attribute, const ObjectRef& object) const;
+
+    // Numeric values of a message attribute for messageIds, in that order
+    AttributeColumn messageColumn(const std::string& attribute,
+        const std::vector<std::uint32_t>& messageIds) const;
+
+    // Column over all messages of db, ordered by id
+    template <typename DB>
+    AttributeColumn messageColumn(
+        const std::string& attribute, const DB& db) const
+    {
+        std::vector<std::uint32_t> ids;
+        ids.reserve(db.messages.size());
+        for (const auto& msg : db.messages) {
+            ids.push_back(msg.first.id);
+        }
+        return messageColumn(attribute, ids);
+    }
+
+private:
+    struct Key {
+        std::uint32_t attribute;
+        ObjectKind kind;
+        std::uint32_t id;
+        std::string name;
+
+        bool operator==(const Key& rhs) const noexcept
+        {
+            return attribute == rhs.attribute && kind == rhs.kind
+                && id == rhs.id && name == rhs.name;
+        }
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const noexcept;
+    };
+
+    bool convert(const AttributeDefinition& definition,
+        const std::string& token, bool quoted, AttributeValue& value) const;
+
+    std::vector<AttributeDefinition> _definitions;
+    std::unordered_map<std::string, std::uint32_t> _ids;
+    std::unordered_map<Key, AttributeValue, KeyHash> _values;
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: ATTRIBUTES_H_C3LZ6QKR */
@@ -0,0 +1,224 @@
+#include "bus_registry.h"
+#include "dbcparser.h"
+#include "log.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <spdlog/fmt/fmt.h>
+#include <thread>
+
+using namespace CANdb;
+
+namespace {
+// Interned strings compare by address
+bool same(std::string_view lhs, std::string_view rhs) noexcept
+{
+    return lhs.data() == rhs.data() && lhs.size() == rhs.size();
+}
+
+bool sameLayout(const EmbeddedSignal& lhs, const EmbeddedSignal& rhs) noexcept
+{
+    return same(lhs.signal_name, rhs.signal_name)
+        && lhs.startBit == rhs.startBit && lhs.signalSize == rhs.signalSize
+        && lhs.byteOrder == rhs.byteOrder
+        && same(lhs.value_type, rhs.value_type) && lhs.factor == rhs.factor
+        && lhs.offset == rhs.offset && same(lhs.multiplexer, rhs.multiplexer);
+}
+
+// Why two definitions of a message differ, empty if they do not
+std::string difference(
+    const EmbeddedMessageEntry& lhs, const EmbeddedMessageEntry& rhs)
+{
+    if (!same(lhs.first.name, rhs.first.name)) {
+        return fmt::format("name {} vs {}", lhs.first.name, rhs.first.name);
+    }
+    if (lhs.first.dlc != rhs.first.dlc) {
+        return fmt::format("dlc {} vs {}", lhs.first.dlc, rhs.first.dlc);
+    }
+    if (lhs.second.size() != rhs.second.size()) {
+        return fmt::format(
+            "{} vs {} signals", lhs.second.size(), rhs.second.size());
+    }
+    for (std::size_t i = 0; i < lhs.second.size(); ++i) {
+        if (!sameLayout(lhs.second[i], rhs.second[i])) {
+            return fmt::format("signal {} vs {}", lhs.second[i].signal_name,
+                rhs.second[i].signal_name);
+        }
+    }
+    return {};
+}
+} // namespace
+
+std::string_view StringPool::intern(std::string_view s)
+{
+    const auto it = _index.find(s);
+    if (it != _index.end()) {
+        return *it;
+    }
+    _strings.emplace_back(s);
+    _bytes += s.size();
+    const std::string_view stored{ _strings.back() };
+    _index.insert(stored);
+    return stored;
+}
+
+bool BusRegistry::load(const std::vector<std::string>& dbcs, unsigned threads)
+{
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min<unsigned>(threads, dbcs.size());
+
+    std::vector<CANdb_t> databases(dbcs.size());
+    std::vector<char> parsed(dbcs.size(), 0);
+    std::atomic<std::size_t> next{ 0 };
+    const auto worker = [&]() {
+        for (auto i = next++; i < dbcs.size(); i = next++) {
+            DBCParser parser;
+            parsed[i] = parser.parse(dbcs[i]);
+            databases[i] = parser.getDb();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    for (std::size_t i = 0; i < parsed.size(); ++i) {
+        if (!parsed[i]) {
+            cdb_error("Database of bus {} failed to parse", _buses.size() + i);
+            return false;
+        }
+    }
+    // Interning is sequential, the pool is not shared between threads
+    for (const auto& db : databases) {
+        add(db);
+    }
+    return true;
+}
+
+std::size_t BusRegistry::add(const CANdb_t& db)
+{
+    auto bus = std::make_unique<Bus>();
+
+    // Spans point into the vectors, reserve them so they never reallocate
+    std::size_t signalCount = 0;
+    std::size_t valueCount = 0;
+    for (const auto& msg : db.messages) {
+        signalCount += msg.second.size();
+        for (const auto& sig : msg.second) {
+            valueCount += sig.values.entries.size();
+        }
+    }
+    bus->values.reserve(valueCount);
+    bus->signals.reserve(signalCount);
+    bus->messages.reserve(db.messages.size());
+
+    bool hasDirect = false;
+    bus->direct.assign(EmbeddedMessages::kDirectSize, 0);
+    for (const auto& msg : db.messages) {
+        const auto firstSignal = bus->signals.size();
+        for (const auto& sig : msg.second) {
+            const auto firstValue = bus->values.size();
+            for (const auto& v : sig.values.entries) {
+                bus->values.push_back(
+                    EmbeddedValue{ v.raw, _strings.intern(v.description) });
+            }
+            bus->signals.push_back(EmbeddedSignal{
+                _strings.intern(sig.signal_name), sig.startBit,
+                sig.signalSize, sig.byteOrder, _strings.intern(sig.value_type),
+                sig.factor, sig.offset, sig.min, sig.max,
+                _strings.intern(sig.unit), _strings.intern(sig.receiver),
+                sig.type,
+                { bus->values.data() + firstValue,
+                    bus->values.size() - firstValue },
+                _strings.intern(sig.multiplexer) });
+        }
+
+        if (msg.first.id < EmbeddedMessages::kDirectSize
+            && bus->messages.size() < 0xFFFF) {
+            bus->direct[msg.first.id]
+                = static_cast<std::uint16_t>(bus->messages.size() + 1);
+            hasDirect = true;
+        }
+        bus->messages.push_back(EmbeddedMessageEntry{
+            EmbeddedMessage{ msg.first.id, _strings.intern(msg.first.name),
+                msg.first.dlc, _strings.intern(msg.first.ecu) },
+            { bus->signals.data() + firstSignal,
+                bus->signals.size() - firstSignal } });
+    }
+    if (!hasDirect) {
+        bus->direct.clear();
+    }
+
+    for (const auto& ecu : db.ecus) {
+        bus->ecus.push_back(_strings.intern(ecu));
+    }
+    for (const auto& symbol : db.symbols) {
+        bus->symbols.push_back(_strings.intern(symbol));
+    }
+
+    bus->view = EmbeddedDb{ _strings.intern(db.version),
+        { bus->ecus.data(), bus->ecus.size() },
+        { bus->symbols.data(), bus->symbols.size() },
+        { { bus->messages.data(), bus->messages.size() },
+            hasDirect ? bus->direct.data() : nullptr } };
+
+    _buses.push_back(std::move(bus));
+    cdb_debug("Bus {} added, string pool {} strings, {} bytes",
+        _buses.size() - 1, _strings.size(), _strings.bytes());
+    return _buses.size() - 1;
+}
+
+const EmbeddedMessageEntry* BusRegistry::find(
+    std::size_t bus, std::uint32_t id) const noexcept
+{
+    if (bus >= _buses.size()) {
+        return nullptr;
+    }
+    const auto& messages = _buses[bus]->view.messages;
+    const auto it = messages.find(id);
+    return it != messages.end() ? it : nullptr;
+}
+
+std::vector<BusConflict> BusRegistry::conflicts() const
+{
+    struct Entry {
+        std::uint32_t id;
+        std::size_t bus;
+        const EmbeddedMessageEntry* message;
+    };
+
+    std::vector<Entry> entries;
+    for (std::size_t bus = 0; bus < _buses.size(); ++bus) {
+        for (const auto& msg : _buses[bus]->messages) {
+            entries.push_back(Entry{ msg.first.id, bus, &msg });
+        }
+    }
+    std::sort(entries.begin(), entries.end(),
+        [](const Entry& lhs, const Entry& rhs) {
+            return lhs.id != rhs.id ? lhs.id < rhs.id : lhs.bus < rhs.bus;
+        });
+
+    std::vector<BusConflict> conflicts;
+    for (std::size_t first = 0; first < entries.size();) {
+        auto last = first + 1;
+        for (; last < entries.size() && entries[last].id == entries[first].id;
+             ++last) {
+            auto reason
+                = difference(*entries[first].message, *entries[last].message);
+            if (!reason.empty()) {
+                conflicts.push_back(BusConflict{ entries[first].id,
+                    entries[first].bus, entries[last].bus,
+                    std::move(reason) });
+            }
+        }
+        first = last;
+    }
+    return conflicts;
+}
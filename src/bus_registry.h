@@ -0,0 +1,99 @@
+#ifndef BUS_REGISTRY_H_Q5MZ8RTD
+#define BUS_REGISTRY_H_Q5MZ8RTD
+
+#include "cantypes.hpp"
+#include "embedded_db.h"
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace CANdb {
+
+/**
+ * Interned strings. Every distinct string is stored once and the returned
+ * views stay valid for the lifetime of the pool, so two interned strings
+ * are equal exactly when their data pointers are.
+ */
+class StringPool {
+public:
+    std::string_view intern(std::string_view s);
+
+    std::size_t size() const noexcept { return _strings.size(); }
+    std::size_t bytes() const noexcept { return _bytes; }
+
+private:
+    std::deque<std::string> _strings; // never moves its elements
+    std::unordered_set<std::string_view> _index;
+    std::size_t _bytes{ 0 };
+};
+
+// Message defined differently on two buses
+struct BusConflict {
+    std::uint32_t id;
+    std::size_t firstBus;
+    std::size_t secondBus;
+    std::string reason;
+};
+
+/**
+ * Databases of a gateway, one per bus. Names, units, ECUs and value
+ * descriptions of all buses share one StringPool and every bus is exposed
+ * through the read-only EmbeddedDb view, so lookups by (bus, id) use the
+ * direct index of standard ids.
+ */
+class BusRegistry {
+public:
+    BusRegistry() = default;
+    BusRegistry(const BusRegistry&) = delete;
+    BusRegistry& operator=(const BusRegistry&) = delete;
+
+    /**
+     * Parses dbcs, the contents of one DBC file per bus, on up to threads
+     * threads (0 for one per core) and adds them in order. Returns false
+     * and adds nothing if any of them fails to parse.
+     */
+    bool load(const std::vector<std::string>& dbcs, unsigned threads = 0);
+
+    // Interns db as the next bus and returns its index
+    std::size_t add(const CANdb_t& db);
+
+    std::size_t buses() const noexcept { return _buses.size(); }
+    const EmbeddedDb& bus(std::size_t index) const
+    {
+        return _buses.at(index)->view;
+    }
+    const StringPool& strings() const noexcept { return _strings; }
+
+    // Message id on bus, nullptr if either is unknown
+    const EmbeddedMessageEntry* find(std::size_t bus, std::uint32_t id) const
+        noexcept;
+
+    /**
+     * Messages with the same id but a different name, DLC or signal layout
+     * on two buses. Messages of all buses are sorted by (id, bus) and every
+     * run of equal ids is compared against its first entry.
+     */
+    std::vector<BusConflict> conflicts() const;
+
+private:
+    struct Bus {
+        std::vector<EmbeddedValue> values;
+        std::vector<EmbeddedSignal> signals;
+        std::vector<EmbeddedMessageEntry> messages;
+        std::vector<std::uint16_t> direct;
+        std::vector<std::string_view> ecus;
+        std::vector<std::string_view> symbols;
+        EmbeddedDb view;
+    };
+
+    StringPool _strings;
+    std::vector<std::unique_ptr<Bus>> _buses;
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: BUS_REGISTRY_H_Q5MZ8RTD */
@@ -1,68 +1,256 @@
 #ifndef CANTYPES_HPP_ML9DFK7A
 #define CANTYPES_HPP_ML9DFK7A
 
+#include <algorithm>
 #include <cstdint>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
+#if defined(__has_include)
+#if __has_include(<memory_resource>) && __cplusplus >= 201703L
+#include <memory_resource>
+#define CANDB_HAS_PMR 1
+#endif
+#endif
+
 #include <cereal/archives/xml.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
 
 enum class CANsignalType { Int, Float, String };
 
-struct CANsignal {
-    std::string signal_name;
+namespace CANdb {
+
+/**
+ * Allocator policies of the database types. StdAllocator gives the plain
+ * std::string/std::vector/std::map types (CANdb_t and friends), PmrAllocator
+ * the std::pmr variants used to build a database into an arena.
+ */
+struct StdAllocator {
+    template <typename T> using allocator = std::allocator<T>;
+};
+
+#if CANDB_HAS_PMR
+struct PmrAllocator {
+    template <typename T> using allocator = std::pmr::polymorphic_allocator<T>;
+};
+#endif
+
+template <typename A>
+using BasicString = std::basic_string<char, std::char_traits<char>,
+    typename A::template allocator<char>>;
+
+template <typename A, typename T>
+using BasicVector = std::vector<T, typename A::template allocator<T>>;
+
+} // namespace CANdb
+
+template <typename A> struct BasicCANvalueDescription {
+    std::uint64_t raw;
+    CANdb::BasicString<A> description;
+};
+
+/**
+ * Raw value to text lookup of a single signal built from its VAL_ entries.
+ * Entries are sorted by raw value and searched with a binary search, compact
+ * value sets additionally get a dense index table (slot = index + 1, 0 marks
+ * a hole). Only indices are stored, so copies of a database stay valid.
+ */
+template <typename A> struct BasicCANvalueTable {
+    using String = CANdb::BasicString<A>;
+    using Description = BasicCANvalueDescription<A>;
+
+    CANdb::BasicVector<A, Description> entries;
+    std::uint64_t denseBase{ 0 };
+    CANdb::BasicVector<A, std::uint32_t> dense;
+
+    const String* find(std::uint64_t raw) const noexcept
+    {
+        if (!dense.empty()) {
+            const auto slot = raw - denseBase;
+            if (raw < denseBase || slot >= dense.size() || dense[slot] == 0) {
+                return nullptr;
+            }
+            return &entries[dense[slot] - 1].description;
+        }
+
+        const auto it = std::lower_bound(entries.begin(), entries.end(), raw,
+            [](const Description& e, std::uint64_t r) { return e.raw < r; });
+        if (it == entries.end() || it->raw != raw) {
+            return nullptr;
+        }
+        return &it->description;
+    }
+
+    bool empty() const noexcept { return entries.empty(); }
+};
+
+template <typename A> struct BasicCANsignal {
+    CANdb::BasicString<A> signal_name;
     std::uint8_t startBit;
     std::uint8_t signalSize;
     std::uint8_t byteOrder;
-    std::string value_type;
+    CANdb::BasicString<A> value_type;
     std::uint8_t factor;
     std::uint8_t offset;
     std::int8_t min;
     std::int8_t max;
-    std::string unit;
-    std::string receiver;
+    CANdb::BasicString<A> unit;
+    CANdb::BasicString<A> receiver;
     CANsignalType type;
+    BasicCANvalueTable<A> values;
+    // "M" for the multiplexer switch, "m<n>" for signals sent when it is n
+    CANdb::BasicString<A> multiplexer;
 
-    bool operator==(const CANsignal& rhs) const
+    bool operator==(const BasicCANsignal& rhs) const
     {
         return signal_name == rhs.signal_name;
     }
 };
 
-struct CANmessage {
+template <typename A> struct BasicCANmessage {
     std::uint32_t id;
-    std::string name;
+    CANdb::BasicString<A> name;
     std::uint32_t dlc;
-    std::string ecu;
+    CANdb::BasicString<A> ecu;
 };
 
 namespace std {
-template <> struct less<CANmessage> {
-    bool operator()(const CANmessage& lhs, const CANmessage& rhs) const
+template <typename A> struct less<BasicCANmessage<A>> {
+    bool operator()(
+        const BasicCANmessage<A>& lhs, const BasicCANmessage<A>& rhs) const
     {
         return lhs.id < rhs.id;
     }
 };
 } // namespace std
 
-struct CANdb_t {
+template <typename A> struct BasicCANdb {
+    using allocator_type = typename A::template allocator<char>;
+    using String = CANdb::BasicString<A>;
+    template <typename T> using Vector = CANdb::BasicVector<A, T>;
+
     struct ValTable {
-        std::string identifier;
+        String identifier;
 
         struct ValTableEntry {
-            std::uint32_t id;
-            std::string ident;
+            std::int64_t id;
+            String ident;
         };
-        std::vector<ValTableEntry> entries;
+        Vector<ValTableEntry> entries;
     };
 
-    std::map<CANmessage, std::vector<CANsignal>> messages;
-    std::string version;
-    std::vector<std::string> nodes;
-    std::vector<std::string> symbols;
-    std::vector<std::string> ecus;
-    std::vector<ValTable> val_tables;
+    using Message = BasicCANmessage<A>;
+    using Signals = Vector<BasicCANsignal<A>>;
+    using Messages = std::map<Message, Signals, std::less<Message>,
+        typename A::template allocator<std::pair<const Message, Signals>>>;
+
+    BasicCANdb() = default;
+
+    // All containers of the database allocate from alloc
+    explicit BasicCANdb(const allocator_type& alloc)
+        : messages(alloc)
+        , version(alloc)
+        , nodes(alloc)
+        , symbols(alloc)
+        , ecus(alloc)
+        , val_tables(alloc)
+    {
+    }
+
+    allocator_type get_allocator() const
+    {
+        return allocator_type(messages.get_allocator());
+    }
+
+    Messages messages;
+    String version;
+    Vector<String> nodes;
+    Vector<String> symbols;
+    Vector<String> ecus;
+    Vector<ValTable> val_tables;
 };
 
+using CANvalueDescription = BasicCANvalueDescription<CANdb::StdAllocator>;
+using CANvalueTable = BasicCANvalueTable<CANdb::StdAllocator>;
+using CANsignal = BasicCANsignal<CANdb::StdAllocator>;
+using CANmessage = BasicCANmessage<CANdb::StdAllocator>;
+using CANdb_t = BasicCANdb<CANdb::StdAllocator>;
+
+#if CANDB_HAS_PMR
+namespace CANdb {
+namespace pmr {
+    using CANvalueTable = BasicCANvalueTable<PmrAllocator>;
+    using CANsignal = BasicCANsignal<PmrAllocator>;
+    using CANmessage = BasicCANmessage<PmrAllocator>;
+    using CANdb_t = BasicCANdb<PmrAllocator>;
+} // namespace pmr
+} // namespace CANdb
+#endif
+
+template <class Archive>
+void serialize(Archive& ar, CANvalueDescription& value)
+{
+    ar(cereal::make_nvp("raw", value.raw),
+        cereal::make_nvp("description", value.description));
+}
+
+template <class Archive> void serialize(Archive& ar, CANvalueTable& table)
+{
+    ar(cereal::make_nvp("entries", table.entries),
+        cereal::make_nvp("denseBase", table.denseBase),
+        cereal::make_nvp("dense", table.dense));
+}
+
+template <class Archive> void serialize(Archive& ar, CANsignal& signal)
+{
+    ar(cereal::make_nvp("signal_name", signal.signal_name),
+        cereal::make_nvp("startBit", signal.startBit),
+        cereal::make_nvp("signalSize", signal.signalSize),
+        cereal::make_nvp("byteOrder", signal.byteOrder),
+        cereal::make_nvp("value_type", signal.value_type),
+        cereal::make_nvp("factor", signal.factor),
+        cereal::make_nvp("offset", signal.offset),
+        cereal::make_nvp("min", signal.min),
+        cereal::make_nvp("max", signal.max),
+        cereal::make_nvp("unit", signal.unit),
+        cereal::make_nvp("receiver", signal.receiver),
+        cereal::make_nvp("type", signal.type),
+        cereal::make_nvp("values", signal.values),
+        cereal::make_nvp("multiplexer", signal.multiplexer));
+}
+
+template <class Archive> void serialize(Archive& ar, CANmessage& message)
+{
+    ar(cereal::make_nvp("id", message.id),
+        cereal::make_nvp("name", message.name),
+        cereal::make_nvp("dlc", message.dlc),
+        cereal::make_nvp("ecu", message.ecu));
+}
+
+template <class Archive>
+void serialize(Archive& ar, CANdb_t::ValTable::ValTableEntry& entry)
+{
+    ar(cereal::make_nvp("id", entry.id), cereal::make_nvp("ident", entry.ident));
+}
+
+template <class Archive> void serialize(Archive& ar, CANdb_t::ValTable& table)
+{
+    ar(cereal::make_nvp("identifier", table.identifier),
+        cereal::make_nvp("entries", table.entries));
+}
+
+template <class Archive> void serialize(Archive& ar, CANdb_t& db)
+{
+    ar(cereal::make_nvp("version", db.version),
+        cereal::make_nvp("nodes", db.nodes),
+        cereal::make_nvp("symbols", db.symbols),
+        cereal::make_nvp("ecus", db.ecus),
+        cereal::make_nvp("val_tables", db.val_tables),
+        cereal::make_nvp("messages", db.messages));
+}
+
 #endif /* end of include guard: CANTYPES_HPP_ML9DFK7A */
@@ -0,0 +1,232 @@
+#include "dbc_generator.h"
+
+#include <algorithm>
+#include <random>
+#include <spdlog/fmt/fmt.h>
+
+using namespace CANdb;
+
+namespace {
+constexpr std::size_t kMuxGroups = 4;
+constexpr std::size_t kMuxSwitchBits = 8;
+
+const char* kWords[] = { "signal", "status", "request", "counter", "checksum",
+    "torque", "speed", "wheel", "brake", "steering", "valid", "value",
+    "invalid", "reserved", "sensor", "actuator" };
+
+class Generator {
+public:
+    explicit Generator(const GeneratorOptions& options)
+        : _options(options)
+        , _rng(options.seed)
+        , _eol(options.crlf ? "\r\n" : "\n")
+    {
+    }
+
+    std::string run()
+    {
+        header();
+        for (std::size_t i = 0; i < _options.messages; ++i) {
+            message(i);
+        }
+        _out += _eol;
+        comments();
+        attributes();
+        values();
+        return std::move(_out);
+    }
+
+private:
+    bool chance(double ratio)
+    {
+        // 24 bits of the generator keep the result exact on every platform
+        return (_rng() & 0xFFFFFF) < ratio * 0x1000000;
+    }
+
+    std::uint32_t below(std::uint32_t n) { return n == 0 ? 0 : _rng() % n; }
+
+    std::string ecu(std::size_t i) const
+    {
+        return fmt::format("ECU_{:03}", i % std::max<std::size_t>(_options.ecus, 1));
+    }
+
+    std::uint32_t messageId(std::size_t i) const
+    {
+        // Standard ids first, extended ids (flag bit 31) after 0x7FF
+        if (i < 0x7FF) {
+            return static_cast<std::uint32_t>(i + 1);
+        }
+        return 0x80000000u | static_cast<std::uint32_t>(0x10000 + i);
+    }
+
+    std::string signalName(std::size_t msg, std::size_t sig) const
+    {
+        return fmt::format("Msg{:05}_{}{:03}", msg,
+            kWords[(msg + sig) % (sizeof(kWords) / sizeof(kWords[0]))], sig);
+    }
+
+    std::string text(std::size_t length)
+    {
+        std::string r;
+        while (r.size() < length) {
+            if (!r.empty()) {
+                r += (below(16) == 0) ? _eol : " ";
+            }
+            r += kWords[below(sizeof(kWords) / sizeof(kWords[0]))];
+        }
+        return r;
+    }
+
+    void line(const std::string& s)
+    {
+        _out += s;
+        _out += _eol;
+    }
+
+    void header()
+    {
+        line("VERSION \"\"");
+        line("");
+        line("NS_ :");
+        for (const auto ns : { "NS_DESC_", "CM_", "BA_DEF_", "BA_", "VAL_",
+                 "BA_DEF_DEF_", "VAL_TABLE_", "SIG_VALTYPE_" }) {
+            line(fmt::format("  {}", ns));
+        }
+        line("");
+        line("BS_:");
+        line("");
+
+        std::string bu = "BU_:";
+        for (std::size_t i = 0; i < std::max<std::size_t>(_options.ecus, 1); ++i) {
+            bu += " " + ecu(i);
+        }
+        line(bu);
+        line("");
+    }
+
+    void message(std::size_t i)
+    {
+        const auto signals = std::max<std::size_t>(_options.signalsPerMessage, 1);
+        const bool multiplexed = signals > 1 && chance(_options.multiplexedRatio);
+        const std::size_t dlc = signals <= 8 ? 8 : 64;
+        const auto bits = dlc * 8;
+
+        line(fmt::format("BO_ {} Msg{:05}_{}: {} {}", messageId(i), i,
+            kWords[i % (sizeof(kWords) / sizeof(kWords[0]))], dlc, ecu(i)));
+
+        for (std::size_t s = 0; s < signals; ++s) {
+            std::string mux;
+            std::size_t start, size;
+            if (!multiplexed) {
+                size = std::max<std::size_t>(bits / signals, 1);
+                start = (s * size) % bits;
+            } else if (s == 0) {
+                mux = " M";
+                start = 0;
+                size = kMuxSwitchBits;
+            } else {
+                const auto group = (s - 1) % kMuxGroups;
+                const auto slot = (s - 1) / kMuxGroups;
+                const auto perGroup = (signals - 1 + kMuxGroups - 1) / kMuxGroups;
+                size = std::max<std::size_t>(
+                    (bits - kMuxSwitchBits) / perGroup, 1);
+                start = kMuxSwitchBits
+                    + (slot * size) % (bits - kMuxSwitchBits);
+                mux = fmt::format(" m{}", group);
+            }
+            size = std::min<std::size_t>(size, 64);
+
+            // Drawn one by one, argument evaluation order is unspecified
+            const auto sign = size > 1 && below(4) == 0 ? '-' : '+';
+            const auto factor = below(2) == 0 ? "1" : "0.1";
+            const auto offset = below(4) == 0 ? below(100) : 0;
+            const auto max = below(1000);
+            const auto unit = below(2) == 0 ? "" : "km/h";
+            line(fmt::format("  SG_ {}{} : {}|{}@1{} ({},{}) [0|{}] \"{}\" {}",
+                signalName(i, s), mux, start, size, sign, factor, offset, max,
+                unit, ecu(i + 1 + s)));
+        }
+        line("");
+    }
+
+    void comments()
+    {
+        for (std::size_t i = 0; i < _options.messages; ++i) {
+            if (chance(_options.commentRatio)) {
+                line(fmt::format("CM_ BO_ {} \"{}\";", messageId(i),
+                    text(_options.commentLength)));
+            }
+            for (std::size_t s = 0; s < signalCount(); ++s) {
+                if (chance(_options.commentRatio)) {
+                    line(fmt::format("CM_ SG_ {} {} \"{}\";", messageId(i),
+                        signalName(i, s), text(_options.commentLength)));
+                }
+            }
+        }
+        _out += _eol;
+    }
+
+    void attributes()
+    {
+        if (_options.attributeRatio <= 0) {
+            return;
+        }
+        line("BA_DEF_ BO_ \"GenMsgCycleTime\" INT 0 10000;");
+        line("BA_DEF_ SG_ \"GenSigStartValue\" INT 0 65535;");
+        line("BA_DEF_ \"BusType\" STRING ;");
+        line("");
+        line("BA_DEF_DEF_ \"GenMsgCycleTime\" 100;");
+        line("BA_DEF_DEF_ \"GenSigStartValue\" 0;");
+        line("BA_DEF_DEF_ \"BusType\" \"CAN\";");
+        line("");
+        line("BA_ \"BusType\" \"CAN FD\";");
+        for (std::size_t i = 0; i < _options.messages; ++i) {
+            if (chance(_options.attributeRatio)) {
+                line(fmt::format("BA_ \"GenMsgCycleTime\" BO_ {} {};",
+                    messageId(i), 10 * (1 + below(100))));
+            }
+            for (std::size_t s = 0; s < signalCount(); ++s) {
+                if (chance(_options.attributeRatio)) {
+                    line(fmt::format("BA_ \"GenSigStartValue\" SG_ {} {} {};",
+                        messageId(i), signalName(i, s), below(256)));
+                }
+            }
+        }
+        line("");
+    }
+
+    void values()
+    {
+        for (std::size_t i = 0; i < _options.messages; ++i) {
+            for (std::size_t s = 0; s < signalCount(); ++s) {
+                if (!chance(_options.valueTableRatio)) {
+                    continue;
+                }
+                std::string val = fmt::format(
+                    "VAL_ {} {}", messageId(i), signalName(i, s));
+                const auto count = 2 + below(6);
+                for (std::uint32_t v = count; v-- > 0;) {
+                    val += fmt::format(" {} \"{}\"", v,
+                        kWords[below(sizeof(kWords) / sizeof(kWords[0]))]);
+                }
+                line(val + " ;");
+            }
+        }
+    }
+
+    std::size_t signalCount() const
+    {
+        return std::max<std::size_t>(_options.signalsPerMessage, 1);
+    }
+
+    const GeneratorOptions& _options;
+    std::mt19937 _rng;
+    const char* _eol;
+    std::string _out;
+};
+} // namespace
+
+std::string CANdb::generateDbc(const GeneratorOptions& options)
+{
+    return Generator{ options }.run();
+}
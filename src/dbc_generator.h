@@ -0,0 +1,37 @@
+#ifndef DBC_GENERATOR_H_Q8VJ3MZC
+#define DBC_GENERATOR_H_Q8VJ3MZC
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace CANdb {
+
+struct GeneratorOptions {
+    std::size_t messages{ 100 };
+    std::size_t signalsPerMessage{ 8 };
+    std::size_t ecus{ 16 };
+    // Ratios in [0, 1]
+    double multiplexedRatio{ 0 };
+    double commentRatio{ 0 };
+    double attributeRatio{ 0 };
+    double valueTableRatio{ 0 };
+    std::size_t commentLength{ 80 };
+    bool crlf{ false };
+    std::uint32_t seed{ 1 };
+};
+
+/**
+ * Writes a synthetic DBC file of the requested shape. The output depends on
+ * the options only: choices come from std::mt19937, whose sequence is fixed
+ * by the standard, without the implementation defined distributions.
+ *
+ * Messages get disjoint Intel signals, multiplexed messages use an 8-bit
+ * switch followed by four groups sharing the remaining bits. Ratios select
+ * which messages and signals receive CM_, BA_ and VAL_ entries.
+ */
+std::string generateDbc(const GeneratorOptions& options);
+
+} // namespace CANdb
+
+#endif /* end of include guard: DBC_GENERATOR_H_Q8VJ3MZC */
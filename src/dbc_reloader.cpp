@@ -0,0 +1,156 @@
+#include "dbc_reloader.h"
+#include "dbcparser.h"
+#include "log.hpp"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+using namespace CANdb;
+
+DbcReloader::DbcReloader(std::string path, std::size_t maxReaders)
+    : _path(std::move(path))
+    , _cell(maxReaders)
+{
+    const auto slash = _path.find_last_of('/');
+    _directory = slash == std::string::npos ? "." : _path.substr(0, slash + 1);
+    _name = slash == std::string::npos ? _path : _path.substr(slash + 1);
+}
+
+DbcReloader::~DbcReloader() { stop(); }
+
+bool DbcReloader::reload()
+{
+    std::lock_guard<std::mutex> lock{ _reloadMutex };
+
+    std::vector<Diagnostic> diagnostics;
+    std::ifstream file{ _path, std::ios::binary };
+    if (!file.good()) {
+        diagnostics.push_back(Diagnostic{ 0, 0, "",
+            fmt::format("Unable to open {}: {}", _path,
+                std::strerror(errno)) });
+    } else {
+        const std::string data{ std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>() };
+
+        DBCParser parser;
+        parser.enableRecovery();
+        if (parser.parse(data)) {
+            const auto& db = parser.getDb();
+            const auto generation = _generation + 1;
+            std::unique_ptr<const DbcSnapshot> snapshot{ new DbcSnapshot{
+                db, parser.attributes(), generation } };
+            const auto& published = *snapshot;
+            _cell.publish(std::move(snapshot));
+            cdb_info("{} reloaded, generation {}, {} retired snapshots",
+                _path, generation, _cell.pending());
+            if (_onReload) {
+                _onReload(published);
+            }
+            // Counters change after the handlers, pollers see their effects
+            _generation = generation;
+            return true;
+        }
+        diagnostics = parser.diagnostics();
+        if (diagnostics.empty()) {
+            diagnostics.push_back(
+                Diagnostic{ 0, 0, "", "Parsing failed without diagnostics" });
+        }
+    }
+
+    cdb_warn("{} failed to reload, keeping generation {}", _path,
+        _generation.load());
+    if (_onFailure) {
+        _onFailure(diagnostics);
+    }
+    ++_failures;
+    return false;
+}
+
+bool DbcReloader::start()
+{
+    if (_watcher.joinable()) {
+        return true;
+    }
+
+    _inotify = inotify_init1(IN_CLOEXEC);
+    if (_inotify < 0) {
+        cdb_error("inotify_init1 failed: {}", std::strerror(errno));
+        return false;
+    }
+    if (inotify_add_watch(
+            _inotify, _directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO)
+        < 0) {
+        cdb_error("Unable to watch {}: {}", _directory, std::strerror(errno));
+        ::close(_inotify);
+        _inotify = -1;
+        return false;
+    }
+    if (::pipe(_stopPipe) != 0) {
+        cdb_error("pipe failed: {}", std::strerror(errno));
+        ::close(_inotify);
+        _inotify = -1;
+        return false;
+    }
+
+    _watcher = std::thread{ [this]() { watch(); } };
+    return true;
+}
+
+void DbcReloader::stop()
+{
+    if (!_watcher.joinable()) {
+        return;
+    }
+    const char stop = 0;
+    while (::write(_stopPipe[1], &stop, 1) < 0 && errno == EINTR) {
+    }
+    _watcher.join();
+
+    ::close(_inotify);
+    ::close(_stopPipe[0]);
+    ::close(_stopPipe[1]);
+    _inotify = _stopPipe[0] = _stopPipe[1] = -1;
+}
+
+void DbcReloader::watch()
+{
+    alignas(inotify_event) char buffer[4096];
+    pollfd fds[2] = { { _inotify, POLLIN, 0 }, { _stopPipe[0], POLLIN, 0 } };
+
+    while (true) {
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            cdb_error("Watch of {} failed: {}", _path, std::strerror(errno));
+            return;
+        }
+        if (fds[1].revents != 0) {
+            return;
+        }
+
+        const auto n = ::read(_inotify, buffer, sizeof(buffer));
+        if (n <= 0) {
+            continue;
+        }
+        // Several events of one save are handled with a single reload
+        bool changed = false;
+        for (ssize_t offset = 0; offset < n;) {
+            const auto event
+                = reinterpret_cast<const inotify_event*>(buffer + offset);
+            if (event->len != 0 && _name == event->name) {
+                changed = true;
+            }
+            offset += sizeof(inotify_event) + event->len;
+        }
+        if (changed) {
+            reload();
+        }
+    }
+}
+#endif
@@ -0,0 +1,90 @@
+#ifndef DBC_RELOADER_H_N3VX7PGA
+#define DBC_RELOADER_H_N3VX7PGA
+
+#include "attributes.h"
+#include "cantypes.hpp"
+#include "parse_recovery.h"
+#include "snapshot_cell.hpp"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace CANdb {
+
+// Database of one successful parse, never modified after publishing
+struct DbcSnapshot {
+    CANdb_t db;
+    AttributeStore attributes;
+    std::uint64_t generation; // 1 for the first successful parse
+};
+
+#ifdef __linux__
+/**
+ * Keeps the database of a DBC file current while it is edited. An inotify
+ * watch on the directory of the file (editors often replace files by
+ * renaming) triggers a parse on a background thread. Successful parses are
+ * published through a SnapshotCell, readers pick them up without locking.
+ * A failed parse keeps the previous snapshot and reports its diagnostics.
+ *
+ * Handlers are called on the thread doing the reload and must be set
+ * before start().
+ */
+class DbcReloader {
+public:
+    using Cell = SnapshotCell<DbcSnapshot>;
+    using ReloadHandler = std::function<void(const DbcSnapshot&)>;
+    using FailureHandler
+        = std::function<void(const std::vector<Diagnostic>&)>;
+
+    explicit DbcReloader(std::string path, std::size_t maxReaders = 64);
+    ~DbcReloader();
+
+    DbcReloader(const DbcReloader&) = delete;
+    DbcReloader& operator=(const DbcReloader&) = delete;
+
+    void onReload(ReloadHandler handler) { _onReload = std::move(handler); }
+    void onFailure(FailureHandler handler)
+    {
+        _onFailure = std::move(handler);
+    }
+
+    // Parses the file now, false if it failed and the snapshot was kept
+    bool reload();
+
+    // Starts watching, false if the watch could not be set up
+    bool start();
+    void stop();
+
+    // One per reader thread
+    Cell::Reader reader() { return _cell.reader(); }
+
+    std::uint64_t generation() const noexcept { return _generation; }
+    std::uint64_t failures() const noexcept { return _failures; }
+
+private:
+    void watch();
+
+    std::string _path;
+    std::string _directory;
+    std::string _name;
+    Cell _cell;
+    ReloadHandler _onReload;
+    FailureHandler _onFailure;
+
+    std::mutex _reloadMutex;
+    std::atomic<std::uint64_t> _generation{ 0 };
+    std::atomic<std::uint64_t> _failures{ 0 };
+
+    int _inotify{ -1 };
+    int _stopPipe[2]{ -1, -1 };
+    std::thread _watcher;
+};
+#endif
+
+} // namespace CANdb
+
+#endif /* end of include guard: DBC_RELOADER_H_N3VX7PGA */
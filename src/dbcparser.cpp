@@ -1,9 +1,16 @@
 #include "dbcparser.h"
+#include "attributes.h"
 #include "Resource.h"
 #include "lambda_visitor.hpp"
 #include "log.hpp"
+#include "parse_recovery.h"
+#include "parse_task.h"
+#include "section_skipper.h"
+#include "text_normalizer.h"
+#include "value_table.h"
 
 #include <fstream>
+#include <memory>
 #include <peglib.h>
 
 #include <boost/algorithm/string/classification.hpp>
@@ -48,6 +55,13 @@ auto to_vector(const T& container) -> std::vector<typename T::value_type>
 using namespace CANdb;
 using strings = std::vector<std::string>;
 
+namespace {
+// Unwinds out of peg::parser::parse() when the observer cancels, actions
+// only turn peg::parse_error into a failed match
+struct ParseCancelled {
+};
+} // namespace
+
 std::string withLines(const std::string& dbcFile)
 {
     strings split;
@@ -67,31 +81,196 @@ std::string withLines(const std::string& dbcFile)
     return buff;
 }
 
-// Changes \r\n to \n
-std::string dos2unix(const std::string& data)
+// Compares strings of different allocators
+template <typename S> bool equals(const S& lhs, const std::string& rhs)
 {
-    std::string noWindowsShit;
-    boost::replace_all_copy(
-        std::back_inserter(noWindowsShit), data, "\r\n", "\n");
+    return lhs.size() == rhs.size()
+        && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
 
-    return noWindowsShit;
+void DBCParser::GrammarDeleter::operator()(
+    peg::parser* grammar) const noexcept
+{
+    delete grammar;
 }
 
 bool DBCParser::parse(const std::string& data) noexcept
 {
-    Resource dbc{ _resource_dbc_grammar_peg, _resource_dbc_grammar_peg_len };
+    can_db = CANdb_t{};
+    _attributes = AttributeStore{};
+    return parseInto(data, can_db);
+}
 
-    auto noTabsData = dos2unix(data);
+bool DBCParser::parse(InputStream& input) noexcept
+{
+    std::string data;
+    try {
+        readAll(input, data);
+    } catch (const std::exception& ex) {
+        cdb_error("Unable to read DBC input: {}", ex.what());
+        can_db = CANdb_t{};
+        _attributes = AttributeStore{};
+        _diagnostics = { Diagnostic{ 0, 0, "", ex.what() } };
+        return false;
+    }
+    return parse(data);
+}
 
-    peg::parser parser;
+#if CANDB_HAS_PMR
+bool DBCParser::parse(const std::string& data, pmr::CANdb_t& db) noexcept
+{
+    _attributes = AttributeStore{};
+    return parseInto(data, db);
+}
+#endif
 
-    parser.log = [](size_t l, size_t k, const std::string& s) {
+bool DBCParser::materialize(unsigned sections) noexcept
+{
+    return materializeInto(sections, can_db);
+}
+
+#if CANDB_HAS_PMR
+bool DBCParser::materialize(unsigned sections, pmr::CANdb_t& db) noexcept
+{
+    return materializeInto(sections, db);
+}
+#endif
+
+template <typename A>
+bool DBCParser::materializeInto(unsigned sections, BasicCANdb<A>& db) noexcept
+{
+    // The deferred statements follow the grammar order already, a header
+    // repeating the version makes them a complete file
+    std::string data = "VERSION \"";
+    data.append(db.version.data(), db.version.size());
+    data += "\"\n\n";
+
+    if ((sections & sectionBit(Section::Attributes)) != 0) {
+        sections |= sectionBit(Section::AttributeDefinitions);
+    }
+
+    // Input line of each line of data, 0 for the header
+    std::vector<std::size_t> lines(2, 0);
+    DeferredSections remaining;
+    for (const auto& statement : _deferred.statements) {
+        if ((sections & sectionBit(statement.section)) != 0) {
+            data.append(_deferred.text, statement.offset, statement.length);
+            // The last statement of the input may lack its newline
+            const auto begin = _deferred.text.begin() + statement.offset;
+            const auto end = begin + statement.length;
+            auto count = std::count(begin, end, '\n');
+            if (begin != end && *(end - 1) != '\n') {
+                ++count;
+            }
+            for (std::ptrdiff_t k = 0; k < count; ++k) {
+                lines.push_back(statement.line + k);
+            }
+        } else {
+            remaining.statements.push_back(statement);
+            remaining.statements.back().offset = remaining.text.size();
+            remaining.text.append(
+                _deferred.text, statement.offset, statement.length);
+        }
+    }
+    if (remaining.statements.size() == _deferred.statements.size()) {
+        return true;
+    }
+
+    const auto enabled = _sections;
+    _sections = kAllSections;
+    auto deferred = std::move(_deferred);
+    const auto success = parseInto(data, db);
+    _sections = enabled;
+    // Recovery reports and drops the statements that failed, otherwise
+    // the parse stopped early and everything selected stays deferred
+    _deferred = success || (_recovering && !_cancelled) ? std::move(remaining)
+                                                         : std::move(deferred);
+    for (auto& diagnostic : _diagnostics) {
+        diagnostic.line = diagnostic.line > 0 && diagnostic.line <= lines.size()
+            ? lines[diagnostic.line - 1]
+            : 0;
+    }
+    return success;
+}
+
+template <typename A>
+bool DBCParser::parseInto(const std::string& data, BasicCANdb<A>& db) noexcept
+{
+    using DB = BasicCANdb<A>;
+    using String = typename DB::String;
+    using Signal = BasicCANsignal<A>;
+    using ValTable = typename DB::ValTable;
+    using ValTableEntry = typename ValTable::ValTableEntry;
+    using Description = typename BasicCANvalueTable<A>::Description;
+
+    // Everything stored in db allocates from its allocator, the std::string
+    // and deque scratch space of the actions is released after the parse
+    const auto alloc = db.get_allocator();
+    const auto toString = [&alloc](const std::string& s) {
+        return String(s.data(), s.size(), alloc);
+    };
+    const auto assignStrings = [](auto& target, const auto& source) {
+        target.clear();
+        target.reserve(source.size());
+        for (const auto& s : source) {
+            target.emplace_back(s.data(), s.size());
+        }
+    };
+
+    auto noTabsData = normalizeText(data, _encoding);
+
+    _deferred = DeferredSections{};
+    if ((_sections & kAllSections) != kAllSections) {
+        noTabsData = skipSections(noTabsData, _sections, _deferred);
+    }
+
+    // The last report of a failed parse becomes its diagnostic
+    std::size_t errorLine = 0;
+    std::size_t errorColumn = 0;
+    std::string errorMessage;
+    const auto log = [&errorLine, &errorColumn, &errorMessage](
+                         size_t l, size_t k, const std::string& s) {
         cdb_error("Parser log {}:{} {}", l, k, s);
+        errorLine = l;
+        errorColumn = k;
+        errorMessage = s;
     };
 
-    if (!parser.load_grammar(dbc.data(), dbc.size())) {
-        cdb_error("Unable to parse grammar");
-        return false;
+    // Actions and the log capture this call's state, they are assigned anew
+    // on every parse
+    if (!_grammar) {
+        Resource dbc{ _resource_dbc_grammar_peg,
+            _resource_dbc_grammar_peg_len };
+        _grammar.reset(new peg::parser);
+        _grammar->log = log;
+        if (!_grammar->load_grammar(dbc.data(), dbc.size())) {
+            cdb_error("Unable to parse grammar");
+            _grammar.reset();
+            return false;
+        }
+    }
+    auto& parser = *_grammar;
+    parser.log = log;
+
+    _profile = ParseProfile{};
+    std::unique_ptr<ParseProfiler> profiler;
+    if (_profiling) {
+        profiler = std::make_unique<ParseProfiler>(noTabsData);
+        for (auto& rule : parser.get_grammar()) {
+            const auto id = profiler->rule(rule.first);
+            auto& p = *profiler;
+            rule.second.enter
+                = [&p, id](const char*, size_t, peg::any&) { p.enter(id); };
+            rule.second.leave = [&p, id](const char* s, size_t, size_t len,
+                                    peg::any&, peg::any&) {
+                p.leave(id, s, peg::success(len));
+            };
+        }
+    } else {
+        for (auto& rule : parser.get_grammar()) {
+            rule.second.enter = nullptr;
+            rule.second.leave = nullptr;
+        }
     }
 
     parser.enable_trace(
@@ -99,19 +278,42 @@ bool DBCParser::parse(const std::string& data) noexcept
             const peg::SemanticValues&, const peg::Context&,
             const peg::any&) { cdb_trace(" Parsing {} \"{}\"", a, k); });
 
-    cdb_debug("DBC file  = \n{}", withLines(noTabsData));
+    if (kDefaultLogger->should_log(spdlog::level::debug)) {
+        cdb_debug("DBC file  = \n{}", withLines(noTabsData));
+    }
+
+    // A recovery pass parses a header of headerSize bytes followed by the
+    // input from offset base on. Offsets given to the observer and committed,
+    // the end of the last statement that parsed, are offsets of the input.
+    const char* text = noTabsData.c_str();
+    std::size_t textSize = noTabsData.size();
+    std::size_t headerSize = 0;
+    std::size_t base = 0;
+    std::size_t committed = 0;
+    const auto step = [this, &text, &textSize, &headerSize, &base, &committed](
+                          const peg::SemanticValues& sv, ParseSection section) {
+        const auto end
+            = static_cast<std::size_t>(sv.c_str() + sv.length() - text);
+        committed = base + (end > headerSize ? end - headerSize : 0);
+        if (_observer != nullptr
+            && !_observer->statement(committed, textSize, section)) {
+            throw ParseCancelled{};
+        }
+    };
 
     strings phrases;
     std::deque<std::string> idents, signs;
     std::deque<std::int64_t> numbers;
-    using PhrasePair = std::pair<std::uint32_t, std::string>;
+    using PhrasePair = std::pair<std::int64_t, std::string>;
     std::vector<PhrasePair> phrasesPairs;
 
-    parser["version"] = [this, &phrases](const peg::SemanticValues&) {
+    parser["version"] = [&db, &phrases, &toString, &step](
+                            const peg::SemanticValues& sv) {
+        step(sv, ParseSection::Header);
         if (phrases.empty()) {
             throw peg::parse_error("Version phrase not found");
         }
-        can_db.version = take_back(phrases);
+        db.version = toString(take_back(phrases));
     };
 
     parser["phrase"] = [&phrases](const peg::SemanticValues& sv) {
@@ -120,8 +322,10 @@ bool DBCParser::parse(const std::string& data) noexcept
         phrases.push_back(s);
     };
 
-    parser["ns"] = [this, &idents](const peg::SemanticValues& sv) {
-        can_db.symbols = to_vector(idents);
+    parser["ns"] = [&db, &idents, &assignStrings, &step](
+                       const peg::SemanticValues& sv) {
+        step(sv, ParseSection::Header);
+        assignStrings(db.symbols, idents);
         cdb_debug("Found symbols {}", sv.token());
         idents.clear();
     };
@@ -132,7 +336,8 @@ bool DBCParser::parse(const std::string& data) noexcept
         idents.push_back(s);
     };
 
-    parser["bs"] = [](const peg::SemanticValues&) {
+    parser["bs"] = [&step](const peg::SemanticValues& sv) {
+        step(sv, ParseSection::Header);
         // TODO: Implement me
         cdb_warn("TAG BS Not implemented");
     };
@@ -142,14 +347,18 @@ bool DBCParser::parse(const std::string& data) noexcept
         signs.push_back(sv.token());
     };
 
-    parser["bu"] = [&idents, this](const peg::SemanticValues& sv) {
-        can_db.ecus = to_vector(idents);
+    parser["bu"] = [&idents, &db, &assignStrings, &step](
+                       const peg::SemanticValues& sv) {
+        step(sv, ParseSection::Header);
+        assignStrings(db.ecus, idents);
         cdb_debug("Found ecus [bu] {}", sv.token());
         idents.clear();
     };
 
-    parser["bu_sl"] = [&idents, this](const peg::SemanticValues& sv) {
-        can_db.ecus = to_vector(idents);
+    parser["bu_sl"] = [&idents, &db, &assignStrings, &step](
+                          const peg::SemanticValues& sv) {
+        step(sv, ParseSection::Header);
+        assignStrings(db.ecus, idents);
         cdb_debug("Found ecus [bu] {}", sv.token());
         idents.clear();
     };
@@ -172,40 +381,165 @@ bool DBCParser::parse(const std::string& data) noexcept
             std::make_pair(take_back(numbers), take_back(phrases)));
     };
 
-    parser["val_entry"] = [this, &phrasesPairs](const peg::SemanticValues&) {
-        std::vector<CANdb_t::ValTable::ValTableEntry> tab;
-        std::transform(phrasesPairs.begin(), phrasesPairs.end(),
-            std::back_inserter(tab), [](const auto& p) {
-                return CANdb_t::ValTable::ValTableEntry{ p.first, p.second };
-            });
-        can_db.val_tables.push_back(CANdb_t::ValTable{ "", tab });
+    parser["val_entry"] = [&db, &phrasesPairs, &idents, &alloc, &toString,
+                              &step](const peg::SemanticValues& sv) {
+        step(sv, ParseSection::ValueTables);
+        ValTable table{ toString(take_back(idents)),
+            typename DB::template Vector<ValTableEntry>(alloc) };
+        table.entries.reserve(phrasesPairs.size());
+        for (const auto& p : phrasesPairs) {
+            table.entries.push_back(
+                ValTableEntry{ p.first, toString(p.second) });
+        }
+        db.val_tables.push_back(std::move(table));
         phrasesPairs.clear();
     };
 
-    std::vector<CANsignal> signals;
-    parser["message"]
-        = [this, &numbers, &signals, &idents](const peg::SemanticValues& sv) {
-              cdb_debug("Found a message {} signals = {}", idents.size(),
-                  signals.size());
-              if (numbers.size() < 2 || idents.size() < 2) {
-                  return;
-              }
-              auto dlc = take_back(numbers);
-              auto id = take_back(numbers);
-              auto ecu = take_back(idents);
-              auto name = take_back(idents);
-
-              const CANmessage msg{ static_cast<std::uint32_t>(id), name,
-                  static_cast<std::uint32_t>(dlc), ecu };
-              cdb_debug("Found a message with id = {}", msg.id);
-              can_db.messages[msg] = signals;
-              signals.clear();
-              numbers.clear();
-              idents.clear();
-          };
-
-    parser["signal"] = [&idents, &numbers, &phrases, &signals, &signs](
-                           const peg::SemanticValues& sv) {
+    parser["vals"] = [&db, &numbers, &phrases, &idents, &alloc, &step](
+                         const peg::SemanticValues& sv) {
+        step(sv, ParseSection::ValueDescriptions);
+        // Either a list of value/phrase pairs or the name of a VAL_TABLE_
+        const auto token = sv.token();
+        const auto pairs = std::count(token.begin(), token.end(), '"') / 2;
+
+        ValuePairs values;
+        if (pairs == 0) {
+            const auto tableName = take_back(idents);
+            const auto table = std::find_if(db.val_tables.begin(),
+                db.val_tables.end(), [&tableName](const auto& t) {
+                    return equals(t.identifier, tableName);
+                });
+            if (table == db.val_tables.end()) {
+                cdb_warn("Value table {} not found", tableName);
+            } else {
+                for (const auto& entry : table->entries) {
+                    values.emplace_back(entry.id,
+                        std::string(entry.ident.data(), entry.ident.size()));
+                }
+            }
+        }
+        for (auto i = 0; i < pairs; ++i) {
+            values.emplace_back(take_back(numbers), take_back(phrases));
+        }
+        const auto signalName = take_back(idents);
+        const auto id = static_cast<std::uint32_t>(take_back(numbers));
+
+        auto msg = db.messages.find(typename DB::Message{ id });
+        if (msg == db.messages.end()) {
+            cdb_warn("VAL_ for {} references unknown message {}", signalName,
+                id);
+            return;
+        }
+        auto signal = std::find_if(msg->second.begin(), msg->second.end(),
+            [&signalName](const Signal& s) {
+                return equals(s.signal_name, signalName);
+            });
+        if (signal == msg->second.end()) {
+            cdb_warn("VAL_ references unknown signal {} in message {}",
+                signalName, id);
+            return;
+        }
+        signal->values
+            = makeValueTable<A>(values, signal->signalSize, alloc);
+    };
+
+    // SIG_VALTYPE_ <id> <signal> : 1 for IEEE float, 2 for double
+    parser["sig_val"] = [&db, &numbers, &idents, &step](
+                            const peg::SemanticValues& sv) {
+        step(sv, ParseSection::SignalTypes);
+        const auto type = take_back(numbers);
+        const auto signalName = take_back(idents);
+        const auto id = static_cast<std::uint32_t>(take_back(numbers));
+
+        auto msg = db.messages.find(typename DB::Message{ id });
+        if (msg == db.messages.end()) {
+            cdb_warn("SIG_VALTYPE_ for {} references unknown message {}",
+                signalName, id);
+            return;
+        }
+        auto signal = std::find_if(msg->second.begin(), msg->second.end(),
+            [&signalName](const Signal& s) {
+                return equals(s.signal_name, signalName);
+            });
+        if (signal == msg->second.end()) {
+            cdb_warn("SIG_VALTYPE_ references unknown signal {} in message {}",
+                signalName, id);
+            return;
+        }
+        signal->type = type == 1 || type == 2 ? CANsignalType::Float
+                                              : CANsignalType::Int;
+    };
+
+    typename DB::Signals signals(alloc);
+    parser["message"] = [&db, &numbers, &signals, &idents, &toString, &step](
+                            const peg::SemanticValues& sv) {
+        step(sv, ParseSection::Messages);
+        cdb_debug(
+            "Found a message {} signals = {}", idents.size(), signals.size());
+        if (numbers.size() < 2 || idents.size() < 2) {
+            return;
+        }
+        auto dlc = take_back(numbers);
+        auto id = take_back(numbers);
+        auto ecu = take_back(idents);
+        auto name = take_back(idents);
+
+        typename DB::Message msg{ static_cast<std::uint32_t>(id),
+            toString(name), static_cast<std::uint32_t>(dlc), toString(ecu) };
+        cdb_debug("Found a message with id = {}", msg.id);
+        // A redefined message keeps its first name, the last signals win
+        auto existing = db.messages.find(msg);
+        if (existing != db.messages.end()) {
+            existing->second = std::move(signals);
+        } else {
+            db.messages.emplace(std::move(msg), std::move(signals));
+        }
+        signals.clear();
+        numbers.clear();
+        idents.clear();
+    };
+
+    // Attributes are read from the statement text, which keeps float values
+    // and enum lists the number and phrase actions would flatten
+    parser["ba_def"] = [this, &step](const peg::SemanticValues& sv) {
+        step(sv, ParseSection::AttributeDefinitions);
+        const auto statement = sv.token();
+        if (statement.compare(0, 2, "//") != 0
+            && !_attributes.define(statement)) {
+            cdb_warn("Invalid attribute definition {}", statement);
+        }
+    };
+
+    parser["ba_def_def"] = [this, &step](const peg::SemanticValues& sv) {
+        step(sv, ParseSection::AttributeDefaults);
+        if (!_attributes.setDefault(sv.token())) {
+            cdb_warn("Invalid attribute default {}", sv.token());
+        }
+    };
+
+    parser["ba"] = [this, &step](const peg::SemanticValues& sv) {
+        step(sv, ParseSection::Attributes);
+        if (!_attributes.set(sv.token())) {
+            cdb_warn("Invalid attribute value {}", sv.token());
+        }
+    };
+
+    // Statements the database does not keep only report progress
+    parser["bo_tx_bu"] = [&step](const peg::SemanticValues& sv) {
+        step(sv, ParseSection::Transmitters);
+    };
+    parser["cm"] = [&step](const peg::SemanticValues& sv) {
+        step(sv, ParseSection::Comments);
+    };
+
+    std::string multiplexer;
+    parser["multiplexer"] = [&multiplexer](const peg::SemanticValues& sv) {
+        multiplexer = sv.token();
+    };
+
+    parser["signal"] = [&idents, &numbers, &phrases, &signals, &signs,
+                           &multiplexer, &alloc,
+                           &toString](const peg::SemanticValues& sv) {
         cdb_debug("Found signal {}", sv.token());
 
         auto receiver = take_back(idents);
@@ -224,14 +558,96 @@ bool DBCParser::parse(const std::string& data) noexcept
 
         auto signal_name = take_back(idents);
 
-        signals.push_back(CANsignal{ signal_name,
+        signals.push_back(Signal{ toString(signal_name),
             static_cast<std::uint8_t>(startBit),
             static_cast<std::uint8_t>(signalSize),
-            static_cast<std::uint8_t>(byteOrder), value_type,
+            static_cast<std::uint8_t>(byteOrder), toString(value_type),
             static_cast<std::uint8_t>(factor),
             static_cast<std::uint8_t>(offset), static_cast<std::int8_t>(min),
-            static_cast<std::int8_t>(max), unit, receiver });
+            static_cast<std::int8_t>(max), toString(unit), toString(receiver),
+            CANsignalType{},
+            BasicCANvalueTable<A>{ typename DB::template Vector<Description>(
+                                       alloc),
+                0, typename DB::template Vector<std::uint32_t>(alloc) },
+            toString(multiplexer) });
+        multiplexer.clear();
     };
 
-    return parser.parse(noTabsData.c_str());
+    _diagnostics.clear();
+    _cancelled = false;
+    try {
+        auto success = parser.parse(noTabsData.c_str());
+        if (profiler) {
+            _profile = profiler->finish();
+        }
+        if (success) {
+            return true;
+        }
+
+        // Drop the failed statement and resume after the last statement that
+        // parsed, keeping the database. A header repeating the version makes
+        // the rest a complete file, a message whose signal failed is parsed
+        // again from its BO_ line and replaces the one parsed before.
+        RecoveryBuffer buffer{ noTabsData };
+        std::string pass;
+        std::size_t first = 1;
+        std::size_t headerLines = 0;
+        while (!success) {
+            const auto line = errorLine == 0
+                ? 0
+                : first + (errorLine > headerLines + 1
+                                  ? errorLine - headerLines - 1
+                                  : 0);
+            _diagnostics.push_back(Diagnostic{ buffer.originalLine(line),
+                errorColumn, buffer.ruleAt(line),
+                errorMessage.empty() ? "syntax error" : errorMessage });
+
+            const auto resume = std::min(
+                buffer.lineAt(committed), buffer.statementLine(line));
+            if (!_recovering || _diagnostics.size() >= _maxDiagnostics
+                || !buffer.skipStatement(line)) {
+                break;
+            }
+
+            if (profiler) {
+                for (auto& rule : parser.get_grammar()) {
+                    rule.second.enter = nullptr;
+                    rule.second.leave = nullptr;
+                }
+                profiler.reset();
+            }
+            phrases.clear();
+            idents.clear();
+            signs.clear();
+            numbers.clear();
+            phrasesPairs.clear();
+            signals.clear();
+            multiplexer.clear();
+            errorLine = 0;
+            errorColumn = 0;
+            errorMessage.clear();
+
+            first = buffer.resumeLine(resume);
+            base = buffer.lineOffset(first);
+            pass.clear();
+            headerLines = 0;
+            if (base > 0) {
+                pass = "VERSION \"";
+                pass.append(db.version.data(), db.version.size());
+                pass += "\"\n\n";
+                headerLines = 2;
+            }
+            headerSize = pass.size();
+            pass.append(buffer.text(), base, std::string::npos);
+            committed = base;
+
+            text = pass.c_str();
+            textSize = buffer.text().size();
+            success = parser.parse(text);
+        }
+    } catch (const ParseCancelled&) {
+        _cancelled = true;
+        _diagnostics.push_back(Diagnostic{ 0, 0, "", "parse cancelled" });
+    }
+    return false;
 }
@@ -1,12 +1,142 @@
 #ifndef __CANDBC_H
 #define __CANDBC_H
 
+#include "attributes.h"
+#include "input_stream.h"
+#include "parse_profile.h"
+#include "parse_recovery.h"
 #include "parser.hpp"
+#include "section_skipper.h"
+#include "text_normalizer.h"
+
+#include <memory>
+
+namespace peg {
+class parser;
+}
 
 namespace CANdb {
 
+class ParseObserver;
+
+/**
+ * The grammar is loaded by the first parse and kept for the following ones,
+ * so one parser converting many files pays for it once. A parser is not
+ * shared between threads.
+ */
 struct DBCParser : public Parser<DBCParser> {
+    // Starts from an empty database
     bool parse(const std::string& data) noexcept;
+
+    /**
+     * Reads input to its end, decompressing on the fly for streams from
+     * openInput(), and parses the text. A read error is reported as a
+     * diagnostic without a line.
+     */
+    bool parse(InputStream& input) noexcept;
+
+#if CANDB_HAS_PMR
+    /**
+     * Parses into db instead of the parser's own database. Every string,
+     * vector and map node of the result allocates from db's memory resource,
+     * so a database built on a monotonic arena is released in one step.
+     */
+    bool parse(const std::string& data, pmr::CANdb_t& db) noexcept;
+#endif
+
+    // Records per-rule counters and timings during the following parses
+    void enableProfiling(bool enable = true) noexcept { _profiling = enable; }
+
+    // Profile of the last parse, empty unless profiling is enabled
+    const ParseProfile& profile() const noexcept { return _profile; }
+
+    /**
+     * After a syntax error, skips the failed statement up to the next
+     * top-level keyword and resumes after the last statement that parsed,
+     * collecting up to maxDiagnostics diagnostics. parse() still returns
+     * false, the database holds everything that parsed.
+     */
+    void enableRecovery(
+        bool enable = true, std::size_t maxDiagnostics = 100) noexcept
+    {
+        _recovering = enable;
+        _maxDiagnostics = maxDiagnostics;
+    }
+
+    // Problems of the last parse, at most one unless recovery is enabled
+    const std::vector<Diagnostic>& diagnostics() const noexcept
+    {
+        return _diagnostics;
+    }
+
+    /**
+     * Mask of Section bits parsed by the following parses. Statements of the
+     * other sections are set aside by a line skipper instead of the grammar
+     * and kept as raw text until materialize() parses them into the
+     * database, e.g. kLayoutOnly for decoders that need just BO_/SG_.
+     * Deferring AttributeDefinitions defers Attributes too.
+     */
+    void setSections(unsigned sections) noexcept { _sections = sections; }
+
+    // Statements the last parse skipped and materialize() did not parse yet
+    const DeferredSections& deferred() const noexcept { return _deferred; }
+
+    /**
+     * Parses the deferred statements of sections into the database, those
+     * of Attributes along with the deferred definitions. If the parse fails
+     * without recovery they stay deferred, although statements before the
+     * error may already be in the database. With recovery the failed
+     * statements are reported and dropped.
+     */
+    bool materialize(unsigned sections = kAllSections) noexcept;
+#if CANDB_HAS_PMR
+    bool materialize(unsigned sections, pmr::CANdb_t& db) noexcept;
+#endif
+
+    /**
+     * Observer told about every top-level statement of the following parses,
+     * nullptr for none. The parser does not own it. parseAsync() uses it for
+     * progress and cancellation.
+     */
+    void setObserver(ParseObserver* observer) noexcept
+    {
+        _observer = observer;
+    }
+
+    // The observer stopped the last parse
+    bool cancelled() const noexcept { return _cancelled; }
+
+    /**
+     * Encoding of the following parses' input. Text is normalized to UTF-8
+     * with LF line endings before parsing, a UTF-8 BOM is always dropped.
+     */
+    void setEncoding(TextEncoding encoding) noexcept { _encoding = encoding; }
+
+    // Typed BA_DEF_/BA_DEF_DEF_/BA_ attributes of the last parse
+    const AttributeStore& attributes() const noexcept { return _attributes; }
+
+private:
+    template <typename A>
+    bool materializeInto(unsigned sections, BasicCANdb<A>& db) noexcept;
+    template <typename A>
+    bool parseInto(const std::string& data, BasicCANdb<A>& db) noexcept;
+
+    struct GrammarDeleter {
+        void operator()(peg::parser* grammar) const noexcept;
+    };
+    std::unique_ptr<peg::parser, GrammarDeleter> _grammar;
+
+    ParseObserver* _observer{ nullptr };
+    bool _cancelled{ false };
+    bool _profiling{ false };
+    ParseProfile _profile;
+    bool _recovering{ false };
+    std::size_t _maxDiagnostics{ 100 };
+    std::vector<Diagnostic> _diagnostics;
+    unsigned _sections{ kAllSections };
+    TextEncoding _encoding{ TextEncoding::Utf8 };
+    DeferredSections _deferred;
+    AttributeStore _attributes;
 };
 } // namespace CANdb
 
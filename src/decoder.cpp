@@ -0,0 +1,149 @@
+#include "decoder.h"
+#include "log.hpp"
+
+using namespace CANdb;
+
+namespace {
+constexpr unsigned kMaxPayloadBits = kMaxPayload * 8;
+
+// Next bit of a Motorola signal, walking from the MSB towards the LSB
+unsigned nextMotorolaBit(unsigned bit)
+{
+    return bit % 8 == 0 ? bit + 15 : bit - 1;
+}
+
+std::uint64_t bitAt(const std::uint8_t* data, std::size_t len, unsigned bit)
+{
+    if (bit / 8 >= len) {
+        return 0;
+    }
+    return (data[bit / 8] >> (bit % 8)) & 1u;
+}
+
+std::uint64_t lowBits(std::uint64_t v, unsigned size)
+{
+    return size >= 64 ? v : v & ((std::uint64_t{ 1 } << size) - 1);
+}
+} // namespace
+
+PayloadMask CANdb::signalMask(const CANsignal& signal) noexcept
+{
+    PayloadMask mask{};
+    unsigned bit = signal.startBit;
+    for (unsigned i = 0; i < signal.signalSize && bit < kMaxPayloadBits; ++i) {
+        mask[bit / 64] |= std::uint64_t{ 1 } << (bit % 64);
+        bit = signal.byteOrder == 1 ? bit + 1 : nextMotorolaBit(bit);
+    }
+    return mask;
+}
+
+std::int64_t CANdb::multiplexGroup(const CANsignal& signal) noexcept
+{
+    const auto& mux = signal.multiplexer;
+    if (mux.size() < 2 || mux[0] != 'm') {
+        return kNotMultiplexed;
+    }
+    std::int64_t group = 0;
+    std::size_t i = 1;
+    for (; i < mux.size() && mux[i] >= '0' && mux[i] <= '9'; ++i) {
+        group = group * 10 + (mux[i] - '0');
+    }
+    if (i == 1 || (i != mux.size() && mux.compare(i, 1, "M") != 0)) {
+        return kNotMultiplexed;
+    }
+    return group;
+}
+
+std::size_t CANdb::multiplexSwitch(const CANdb_t::Signals& signals) noexcept
+{
+    std::size_t i = 0;
+    while (i < signals.size() && signals[i].multiplexer != "M") {
+        ++i;
+    }
+    return i;
+}
+
+std::uint64_t CANdb::extractRaw(const CANsignal& signal,
+    const std::uint8_t* data, std::size_t len) noexcept
+{
+    const unsigned size = std::min<unsigned>(signal.signalSize, 64);
+    if (size == 0) {
+        return 0;
+    }
+
+    std::uint8_t word[8] = {};
+    std::copy(data, data + std::min<std::size_t>(len, 8), word);
+
+    if (signal.byteOrder == 1) {
+        const unsigned start = signal.startBit;
+        if (start + size <= 64) {
+            return lowBits(loadLE64(word) >> start, size);
+        }
+
+        std::uint64_t v = 0;
+        for (unsigned i = size; i-- > 0;) {
+            v = (v << 1) | bitAt(data, len, start + i);
+        }
+        return v;
+    }
+
+    // Position of the MSB when the payload is read as a big endian stream
+    const unsigned msb = (signal.startBit / 8) * 8 + (7 - signal.startBit % 8);
+    if (msb + size <= 64) {
+        return lowBits(loadBE64(word) >> (64 - msb - size), size);
+    }
+
+    std::uint64_t v = 0;
+    unsigned bit = signal.startBit;
+    for (unsigned i = 0; i < size; ++i) {
+        v = (v << 1) | bitAt(data, len, bit);
+        bit = nextMotorolaBit(bit);
+    }
+    return v;
+}
+
+double CANdb::toPhysical(const CANsignal& signal, std::uint64_t raw) noexcept
+{
+    double value = static_cast<double>(raw);
+    if (signal.value_type == "-" && signal.signalSize > 0) {
+        if (signal.signalSize < 64) {
+            const auto signBit = std::uint64_t{ 1 } << (signal.signalSize - 1);
+            raw = (raw ^ signBit) - signBit;
+        }
+        value = static_cast<double>(static_cast<std::int64_t>(raw));
+    }
+    return value * signal.factor + signal.offset;
+}
+
+Decoder::Decoder(const CANdb_t& db, Mode mode)
+    : _mode(mode)
+{
+    _ids.reserve(db.messages.size());
+    _layouts.reserve(db.messages.size());
+
+    // messages are ordered by id, so _ids is sorted as well
+    for (const auto& msg : db.messages) {
+        MessageLayout layout{ &msg.first, {}, {}, {},
+            multiplexSwitch(msg.second), 0, false };
+        for (const auto& signal : msg.second) {
+            layout.signals.push_back(&signal);
+            layout.masks.push_back(signalMask(signal));
+            layout.groups.push_back(multiplexGroup(signal));
+        }
+        _ids.push_back(msg.first.id);
+        _layouts.push_back(std::move(layout));
+    }
+
+    if (_mode == Mode::ChangeDetection) {
+        _lastPayloads.assign(_layouts.size(), PayloadSlot{});
+    }
+
+    cdb_debug("Decoder created for {} messages", _layouts.size());
+}
+
+void Decoder::reset() noexcept
+{
+    for (auto& layout : _layouts) {
+        layout.seen = false;
+    }
+}
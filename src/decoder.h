@@ -0,0 +1,267 @@
+#ifndef DECODER_H_QX7RZ2LM
+#define DECODER_H_QX7RZ2LM
+
+#include "cantypes.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace CANdb {
+
+// Largest payload of a CAN FD frame
+constexpr std::size_t kMaxPayload = 64;
+
+// One bit per payload bit, bit n of the payload lives in word n / 64
+using PayloadMask = std::array<std::uint64_t, kMaxPayload / 8>;
+
+// Loads 8 payload bytes as a little endian word (byte 0 in the low bits)
+inline std::uint64_t loadLE64(const std::uint8_t* data) noexcept
+{
+    std::uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) {
+        v = (v << 8) | data[i];
+    }
+    return v;
+}
+
+// Loads 8 payload bytes as a big endian word (byte 0 in the high bits)
+inline std::uint64_t loadBE64(const std::uint8_t* data) noexcept
+{
+    std::uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) {
+        v = (v << 8) | data[i];
+    }
+    return v;
+}
+
+// Builds the occupancy mask of a signal from its startBit, signalSize and
+// byteOrder (1 = Intel, 0 = Motorola with startBit pointing at the MSB)
+PayloadMask signalMask(const CANsignal& signal) noexcept;
+
+// Group of a signal sent only while the multiplexer switch has that value,
+// "m<n>" and "m<n>M" signals. Others, the "M" switch included, are always
+// present and get kNotMultiplexed.
+constexpr std::int64_t kNotMultiplexed = -1;
+std::int64_t multiplexGroup(const CANsignal& signal) noexcept;
+
+// Index of the "M" signal in signals, signals.size() if there is none
+std::size_t multiplexSwitch(const CANdb_t::Signals& signals) noexcept;
+
+// Extracts the raw (unscaled) value of a signal. Bits lying outside of the
+// first len bytes of the payload read as zero.
+std::uint64_t extractRaw(const CANsignal& signal, const std::uint8_t* data,
+    std::size_t len) noexcept;
+
+// Applies sign extension (for "-" signals), factor and offset
+double toPhysical(const CANsignal& signal, std::uint64_t raw) noexcept;
+
+struct DecodeStats {
+    std::uint64_t frames{ 0 };
+    std::uint64_t unchangedFrames{ 0 };
+    std::uint64_t unknownFrames{ 0 };
+    std::uint64_t signalsDecoded{ 0 };
+    std::uint64_t signalsSkipped{ 0 };
+};
+
+/**
+ * Decodes frames into raw signal values using the layout of a parsed
+ * database. The database has to outlive the decoder.
+ *
+ * In ChangeDetection mode the decoder keeps the last payload of every
+ * message and emits only the signals whose bits differ from the previous
+ * frame with the same id. The first frame of every id is decoded fully.
+ *
+ * Multiplexed signals are only emitted while the switch of their message
+ * holds their group, a new switch value emits the whole group. Extended
+ * multiplexing is not resolved, "m<n>M" signals follow the main switch.
+ */
+class Decoder {
+public:
+    enum class Mode { Full, ChangeDetection };
+
+    explicit Decoder(const CANdb_t& db, Mode mode = Mode::Full);
+
+    /**
+     * Decodes a single frame and calls f(message, signal, raw) for every
+     * emitted signal. Returns the number of emitted signals.
+     */
+    template <typename F>
+    std::size_t decode(std::uint32_t id, const std::uint8_t* data,
+        std::size_t len, F&& f);
+
+    Mode mode() const noexcept { return _mode; }
+    const DecodeStats& stats() const noexcept { return _stats; }
+    void resetStats() noexcept { _stats = DecodeStats{}; }
+
+    // Forgets all remembered payloads, next frames are decoded fully
+    void reset() noexcept;
+
+private:
+    struct MessageLayout {
+        const CANmessage* message;
+        std::vector<const CANsignal*> signals;
+        std::vector<PayloadMask> masks;
+        std::vector<std::int64_t> groups;
+        // Index of the multiplexer switch, signals.size() for none
+        std::size_t muxSwitch;
+        std::uint8_t lastLen;
+        bool seen;
+    };
+
+    // Last payload of a message in a cache line of its own
+    struct alignas(64) PayloadSlot {
+        std::uint8_t bytes[kMaxPayload];
+    };
+
+    MessageLayout* find(std::uint32_t id) noexcept;
+    std::uint8_t* lastPayload(std::size_t index) noexcept;
+
+    Mode _mode;
+    std::vector<std::uint32_t> _ids;
+    std::vector<MessageLayout> _layouts;
+    std::vector<PayloadSlot> _lastPayloads;
+    DecodeStats _stats;
+};
+
+inline Decoder::MessageLayout* Decoder::find(std::uint32_t id) noexcept
+{
+    const auto it = std::lower_bound(_ids.begin(), _ids.end(), id);
+    if (it == _ids.end() || *it != id) {
+        return nullptr;
+    }
+    return &_layouts[static_cast<std::size_t>(it - _ids.begin())];
+}
+
+inline std::uint8_t* Decoder::lastPayload(std::size_t index) noexcept
+{
+    return _lastPayloads[index].bytes;
+}
+
+template <typename F>
+std::size_t Decoder::decode(
+    std::uint32_t id, const std::uint8_t* data, std::size_t len, F&& f)
+{
+    ++_stats.frames;
+    auto layout = find(id);
+    if (layout == nullptr) {
+        ++_stats.unknownFrames;
+        return 0;
+    }
+    len = std::min(len, kMaxPayload);
+
+    const auto count = layout->signals.size();
+    const bool multiplexed = layout->muxSwitch != count;
+    const auto group = multiplexed
+        ? static_cast<std::int64_t>(
+              extractRaw(*layout->signals[layout->muxSwitch], data, len))
+        : kNotMultiplexed;
+    // Without a switch every signal counts as present
+    const auto active = [&](std::size_t i) {
+        return !multiplexed || layout->groups[i] == kNotMultiplexed
+            || layout->groups[i] == group;
+    };
+
+    // Emits the active signals for which changed(i) holds
+    const auto emitIf = [&](auto changed) {
+        std::size_t emitted = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (active(i) && changed(i)) {
+                const auto sig = layout->signals[i];
+                f(*layout->message, *sig, extractRaw(*sig, data, len));
+                ++emitted;
+            }
+        }
+        _stats.signalsDecoded += emitted;
+        _stats.signalsSkipped += count - emitted;
+        return emitted;
+    };
+    const auto emitAll
+        = [&]() { return emitIf([](std::size_t) { return true; }); };
+
+    if (_mode == Mode::Full) {
+        return emitAll();
+    }
+
+    const auto last
+        = lastPayload(static_cast<std::size_t>(layout - _layouts.data()));
+    std::uint8_t padded[kMaxPayload] = {};
+    std::copy(data, data + len, padded);
+
+    if (!layout->seen || layout->lastLen != len) {
+        layout->seen = true;
+        layout->lastLen = static_cast<std::uint8_t>(len);
+        std::copy(padded, padded + kMaxPayload, last);
+        return emitAll();
+    }
+
+    if (len <= 8) {
+        // Classic CAN: the whole payload fits in a single word
+        const auto diff = loadLE64(padded) ^ loadLE64(last);
+        if (diff == 0) {
+            ++_stats.unchangedFrames;
+            _stats.signalsSkipped += count;
+            return 0;
+        }
+        std::copy(padded, padded + 8, last);
+
+        if (multiplexed && (layout->masks[layout->muxSwitch][0] & diff) != 0) {
+            return emitAll();
+        }
+        return emitIf([&](std::size_t i) {
+            return (layout->masks[i][0] & diff) != 0;
+        });
+    }
+
+#if defined(__SSE2__)
+    bool equal = true;
+    for (std::size_t i = 0; i < kMaxPayload && equal; i += 16) {
+        const auto a = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(padded + i));
+        const auto b = _mm_load_si128(
+            reinterpret_cast<const __m128i*>(last + i));
+        equal = _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) == 0xFFFF;
+    }
+    if (equal) {
+        ++_stats.unchangedFrames;
+        _stats.signalsSkipped += count;
+        return 0;
+    }
+#endif
+
+    PayloadMask diff;
+    std::uint64_t any = 0;
+    for (std::size_t w = 0; w < diff.size(); ++w) {
+        diff[w] = loadLE64(padded + w * 8) ^ loadLE64(last + w * 8);
+        any |= diff[w];
+    }
+    if (any == 0) {
+        ++_stats.unchangedFrames;
+        _stats.signalsSkipped += count;
+        return 0;
+    }
+    std::copy(padded, padded + kMaxPayload, last);
+
+    const auto changed = [&](std::size_t i) {
+        const auto& mask = layout->masks[i];
+        std::uint64_t hit = 0;
+        for (std::size_t w = 0; w < diff.size(); ++w) {
+            hit |= mask[w] & diff[w];
+        }
+        return hit != 0;
+    };
+    if (multiplexed && changed(layout->muxSwitch)) {
+        return emitAll();
+    }
+    return emitIf(changed);
+}
+
+} // namespace CANdb
+
+#endif /* end of include guard: DECODER_H_QX7RZ2LM */
@@ -0,0 +1,187 @@
+#include "embedded_db.h"
+#include "value_table.h"
+
+#include <spdlog/fmt/fmt.h>
+#include <vector>
+
+using namespace CANdb;
+
+namespace {
+std::string toString(std::string_view s) { return std::string(s); }
+
+// C++ string literal of s, octal escapes keep following digits intact
+std::string literal(const std::string& s)
+{
+    std::string out = "\"";
+    for (const auto c : s) {
+        const auto u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (u < 0x20 || u >= 0x7F) {
+            out += fmt::format("\\{:03o}", u);
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+const char* typeName(CANsignalType type)
+{
+    switch (type) {
+    case CANsignalType::Float:
+        return "CANsignalType::Float";
+    case CANsignalType::String:
+        return "CANsignalType::String";
+    default:
+        return "CANsignalType::Int";
+    }
+}
+
+std::string span(const char* table, std::size_t first, std::size_t count)
+{
+    return count == 0 ? "{ nullptr, 0 }"
+                      : fmt::format("{{ {} + {}, {} }}", table, first, count);
+}
+
+std::string stringTable(
+    const char* name, const std::vector<std::string>& strings)
+{
+    std::string out = fmt::format("constexpr std::string_view {}[] = {{", name);
+    for (const auto& s : strings) {
+        out += "\n    " + literal(s) + ",";
+    }
+    return out + (strings.empty() ? " {} };\n" : "\n};\n");
+}
+} // namespace
+
+CANdb_t CANdb::toDatabase(const EmbeddedDb& db)
+{
+    CANdb_t out;
+    out.version = toString(db.version);
+    for (const auto& ecu : db.ecus) {
+        out.ecus.push_back(toString(ecu));
+    }
+    for (const auto& symbol : db.symbols) {
+        out.symbols.push_back(toString(symbol));
+    }
+
+    for (const auto& entry : db.messages) {
+        const auto& msg = entry.first;
+        std::vector<CANsignal> signals;
+        signals.reserve(entry.second.size());
+        for (const auto& sig : entry.second) {
+            ValuePairs values;
+            for (const auto& v : sig.values) {
+                values.emplace_back(static_cast<std::int64_t>(v.raw),
+                    toString(v.description));
+            }
+            signals.push_back(CANsignal{ toString(sig.signal_name),
+                sig.startBit, sig.signalSize, sig.byteOrder,
+                toString(sig.value_type), sig.factor, sig.offset, sig.min,
+                sig.max, toString(sig.unit), toString(sig.receiver), sig.type,
+                makeValueTable(values, sig.signalSize),
+                toString(sig.multiplexer) });
+        }
+        out.messages.emplace(CANmessage{ msg.id, toString(msg.name), msg.dlc,
+                                 toString(msg.ecu) },
+            std::move(signals));
+    }
+    return out;
+}
+
+std::string CANdb::generateEmbeddedSource(
+    const CANdb_t& db, const std::string& name, const std::string& origin)
+{
+    std::string values;
+    std::string signals;
+    std::string messages;
+    std::vector<std::uint16_t> direct(EmbeddedMessages::kDirectSize, 0);
+    bool hasDirect = false;
+
+    std::size_t valueCount = 0;
+    std::size_t signalCount = 0;
+    std::size_t messageCount = 0;
+    for (const auto& msg : db.messages) {
+        const auto firstSignal = signalCount;
+        for (const auto& sig : msg.second) {
+            const auto firstValue = valueCount;
+            for (const auto& v : sig.values.entries) {
+                values += fmt::format(
+                    "    {{ {}ull, {} }},\n", v.raw, literal(v.description));
+                ++valueCount;
+            }
+            signals += fmt::format(
+                "    {{ {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, "
+                "{} }},\n",
+                literal(sig.signal_name), int{ sig.startBit },
+                int{ sig.signalSize }, int{ sig.byteOrder },
+                literal(sig.value_type), int{ sig.factor }, int{ sig.offset },
+                int{ sig.min }, int{ sig.max }, literal(sig.unit),
+                literal(sig.receiver), typeName(sig.type),
+                span("kValues", firstValue, valueCount - firstValue),
+                literal(sig.multiplexer));
+            ++signalCount;
+        }
+
+        messages += fmt::format("    {{ {{ {}u, {}, {}u, {} }}, {} }},\n",
+            msg.first.id, literal(msg.first.name), msg.first.dlc,
+            literal(msg.first.ecu),
+            span("kSignals", firstSignal, signalCount - firstSignal));
+        if (msg.first.id < EmbeddedMessages::kDirectSize
+            && messageCount < 0xFFFF) {
+            direct[msg.first.id]
+                = static_cast<std::uint16_t>(messageCount + 1);
+            hasDirect = true;
+        }
+        ++messageCount;
+    }
+
+    std::string out = fmt::format(
+        "// Generated by dbcembed from {}, do not edit\n"
+        "#include \"embedded_db.h\"\n\n"
+        "namespace {{\n"
+        "using CANdb::EmbeddedMessageEntry;\n"
+        "using CANdb::EmbeddedSignal;\n"
+        "using CANdb::EmbeddedValue;\n\n",
+        origin);
+
+    // Arrays must not be empty, unused tables get a single blank entry
+    out += "constexpr EmbeddedValue kValues[] = {\n"
+        + (values.empty() ? std::string{ "    {},\n" } : values) + "};\n\n";
+    out += "constexpr EmbeddedSignal kSignals[] = {\n"
+        + (signals.empty() ? std::string{ "    {},\n" } : signals) + "};\n\n";
+    out += "constexpr EmbeddedMessageEntry kMessages[] = {\n"
+        + (messages.empty() ? std::string{ "    {},\n" } : messages)
+        + "};\n\n";
+
+    if (hasDirect) {
+        out += "constexpr std::uint16_t kDirect[] = {";
+        for (std::size_t i = 0; i < direct.size(); ++i) {
+            out += (i % 16 == 0 ? "\n    " : " ")
+                + std::to_string(direct[i]) + ",";
+        }
+        out += "\n};\n\n";
+    }
+
+    out += stringTable("kEcus", db.ecus) + "\n";
+    out += stringTable("kSymbols", db.symbols) + "\n";
+
+    out += fmt::format("constexpr CANdb::EmbeddedDb kDb{{ {},\n"
+                       "    {},\n"
+                       "    {},\n"
+                       "    {{ {}, {} }} }};\n"
+                       "}} // namespace\n\n",
+        literal(db.version), span("kEcus", 0, db.ecus.size()),
+        span("kSymbols", 0, db.symbols.size()),
+        span("kMessages", 0, messageCount), hasDirect ? "kDirect" : "nullptr");
+
+    out += fmt::format("namespace CANdb {{\n"
+                       "namespace embedded {{\n"
+                       "    const EmbeddedDb& {}() {{ return kDb; }}\n"
+                       "}} // namespace embedded\n"
+                       "}} // namespace CANdb\n",
+        name);
+    return out;
+}
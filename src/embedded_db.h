@@ -0,0 +1,163 @@
+#ifndef EMBEDDED_DB_H_W8FB3KXN
+#define EMBEDDED_DB_H_W8FB3KXN
+
+#include "cantypes.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace CANdb {
+
+// Read-only array view over a generated table
+template <typename T> struct EmbeddedSpan {
+    const T* items;
+    std::size_t count;
+
+    constexpr const T* begin() const noexcept { return items; }
+    constexpr const T* end() const noexcept { return items + count; }
+    constexpr std::size_t size() const noexcept { return count; }
+    constexpr bool empty() const noexcept { return count == 0; }
+    constexpr const T& operator[](std::size_t i) const noexcept
+    {
+        return items[i];
+    }
+};
+
+struct EmbeddedValue {
+    std::uint64_t raw;
+    std::string_view description;
+};
+
+// Field names follow CANsignal, so code reading signals works with both
+struct EmbeddedSignal {
+    std::string_view signal_name;
+    std::uint8_t startBit;
+    std::uint8_t signalSize;
+    std::uint8_t byteOrder;
+    std::string_view value_type;
+    std::uint8_t factor;
+    std::uint8_t offset;
+    std::int8_t min;
+    std::int8_t max;
+    std::string_view unit;
+    std::string_view receiver;
+    CANsignalType type;
+    EmbeddedSpan<EmbeddedValue> values; // sorted by raw value
+    std::string_view multiplexer;
+
+    // Description of a raw value, empty if there is none
+    std::string_view describe(std::uint64_t raw) const noexcept
+    {
+        const auto it = std::lower_bound(values.begin(), values.end(), raw,
+            [](const EmbeddedValue& v, std::uint64_t r) { return v.raw < r; });
+        return it != values.end() && it->raw == raw ? it->description
+                                                    : std::string_view{};
+    }
+};
+
+struct EmbeddedMessage {
+    std::uint32_t id;
+    std::string_view name;
+    std::uint32_t dlc;
+    std::string_view ecu;
+};
+
+// Mirrors the value_type of CANdb_t::messages: message as first, signals
+// as second
+struct EmbeddedMessageEntry {
+    EmbeddedMessage first;
+    EmbeddedSpan<EmbeddedSignal> second;
+};
+
+/**
+ * Messages sorted by id like the map of CANdb_t. Standard ids have a direct
+ * 2048 entry index (slot = position + 1), extended ids are found with a
+ * binary search.
+ */
+struct EmbeddedMessages {
+    EmbeddedSpan<EmbeddedMessageEntry> entries;
+    const std::uint16_t* direct; // nullptr without standard ids
+
+    static constexpr std::uint32_t kDirectSize = 2048;
+
+    constexpr const EmbeddedMessageEntry* begin() const noexcept
+    {
+        return entries.begin();
+    }
+    constexpr const EmbeddedMessageEntry* end() const noexcept
+    {
+        return entries.end();
+    }
+    constexpr std::size_t size() const noexcept { return entries.size(); }
+    constexpr bool empty() const noexcept { return entries.empty(); }
+
+    const EmbeddedMessageEntry* find(std::uint32_t id) const noexcept
+    {
+        if (id < kDirectSize) {
+            const auto slot = direct != nullptr ? direct[id] : 0;
+            return slot != 0 ? entries.begin() + slot - 1 : end();
+        }
+        const auto it = std::lower_bound(begin(), end(), id,
+            [](const EmbeddedMessageEntry& e, std::uint32_t i) {
+                return e.first.id < i;
+            });
+        return it != end() && it->first.id == id ? it : end();
+    }
+    const EmbeddedMessageEntry* find(const CANmessage& key) const noexcept
+    {
+        return find(key.id);
+    }
+
+    std::size_t count(std::uint32_t id) const noexcept
+    {
+        return find(id) != end() ? 1 : 0;
+    }
+
+    const EmbeddedSpan<EmbeddedSignal>& at(std::uint32_t id) const
+    {
+        const auto it = find(id);
+        if (it == end()) {
+            throw std::out_of_range("unknown message id");
+        }
+        return it->second;
+    }
+};
+
+/**
+ * Database compiled into the binary by candb_embed_dbc(). All tables are
+ * constant data, reading them needs no parsing and no allocation. Members
+ * are named like CANdb_t: messages, version, ecus and symbols. BusRegistry
+ * exposes the buses it loads through the same view.
+ */
+struct EmbeddedDb {
+    std::string_view version;
+    EmbeddedSpan<std::string_view> ecus;
+    EmbeddedSpan<std::string_view> symbols;
+    EmbeddedMessages messages;
+};
+
+// Copies an embedded database into a CANdb_t for APIs that need one
+CANdb_t toDatabase(const EmbeddedDb& db);
+
+/**
+ * C++ source defining `const CANdb::EmbeddedDb& CANdb::embedded::name()`
+ * with the tables of db. Used by the dbcembed host tool.
+ */
+std::string generateEmbeddedSource(
+    const CANdb_t& db, const std::string& name, const std::string& origin);
+
+} // namespace CANdb
+
+// Declares the accessor generated for a DBC file embedded as name
+#define CANDB_DECLARE_EMBEDDED_DBC(name)                                       \
+    namespace CANdb {                                                          \
+    namespace embedded {                                                       \
+        const EmbeddedDb& name();                                              \
+    }                                                                          \
+    }
+
+#endif /* end of include guard: EMBEDDED_DB_H_W8FB3KXN */
@@ -0,0 +1,73 @@
+#include "footprint.h"
+
+using namespace CANdb;
+
+namespace {
+constexpr std::size_t kTreeNodeOverhead = 4 * sizeof(void*);
+
+void addString(Footprint& fp, const std::string& s)
+{
+    ++fp.strings;
+    const auto object = reinterpret_cast<const char*>(&s);
+    const auto data = s.data();
+    if (data < object || data >= object + sizeof(s)) {
+        ++fp.heapStrings;
+        fp.stringHeap += s.capacity() + 1;
+    }
+}
+
+template <typename T> std::size_t bufferSize(const std::vector<T>& v)
+{
+    return v.capacity() * sizeof(T);
+}
+
+std::size_t addStrings(Footprint& fp, const std::vector<std::string>& v)
+{
+    for (const auto& s : v) {
+        addString(fp, s);
+    }
+    return bufferSize(v);
+}
+} // namespace
+
+Footprint CANdb::footprint(const CANdb_t& db)
+{
+    Footprint fp;
+    fp.database = sizeof(CANdb_t);
+    addString(fp, db.version);
+
+    using Node = decltype(db.messages)::value_type;
+    for (const auto& msg : db.messages) {
+        fp.messageNodes += sizeof(Node) + kTreeNodeOverhead;
+        addString(fp, msg.first.name);
+        addString(fp, msg.first.ecu);
+
+        fp.signalVectors += bufferSize(msg.second);
+        for (const auto& sig : msg.second) {
+            addString(fp, sig.signal_name);
+            addString(fp, sig.value_type);
+            addString(fp, sig.unit);
+            addString(fp, sig.receiver);
+            addString(fp, sig.multiplexer);
+
+            fp.valueTables += bufferSize(sig.values.entries)
+                + bufferSize(sig.values.dense);
+            for (const auto& entry : sig.values.entries) {
+                addString(fp, entry.description);
+            }
+        }
+    }
+
+    fp.symbols += addStrings(fp, db.nodes);
+    fp.symbols += addStrings(fp, db.symbols);
+    fp.symbols += addStrings(fp, db.ecus);
+    fp.symbols += bufferSize(db.val_tables);
+    for (const auto& table : db.val_tables) {
+        addString(fp, table.identifier);
+        fp.symbols += bufferSize(table.entries);
+        for (const auto& entry : table.entries) {
+            addString(fp, entry.ident);
+        }
+    }
+    return fp;
+}
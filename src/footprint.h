@@ -0,0 +1,38 @@
+#ifndef FOOTPRINT_H_C3HY9TQS
+#define FOOTPRINT_H_C3HY9TQS
+
+#include "cantypes.hpp"
+
+#include <cstddef>
+
+namespace CANdb {
+
+/**
+ * Bytes held by a database, by category. Container buffers are counted by
+ * capacity, string buffers only when they live on the heap (strings short
+ * enough for the small string optimization are part of their owner).
+ * Tree nodes are estimated as the stored value plus four pointers.
+ */
+struct Footprint {
+    std::size_t database{ 0 }; // sizeof(CANdb_t)
+    std::size_t messageNodes{ 0 }; // map nodes holding message and signal vector
+    std::size_t signalVectors{ 0 };
+    std::size_t valueTables{ 0 }; // entries and dense index, without strings
+    std::size_t symbols{ 0 }; // nodes, symbols, ecus and VAL_TABLE_ vectors
+    std::size_t stringHeap{ 0 };
+
+    std::size_t strings{ 0 };
+    std::size_t heapStrings{ 0 }; // the remaining strings use SSO
+
+    std::size_t total() const noexcept
+    {
+        return database + messageNodes + signalVectors + valueTables + symbols
+            + stringHeap;
+    }
+};
+
+Footprint footprint(const CANdb_t& db);
+
+} // namespace CANdb
+
+#endif /* end of include guard: FOOTPRINT_H_C3HY9TQS */
@@ -0,0 +1,51 @@
+#ifndef FRAME_HPP_HV2C8RTS
+#define FRAME_HPP_HV2C8RTS
+
+#include <cstdint>
+#include <type_traits>
+
+namespace CANdb {
+
+enum FrameFlags : std::uint8_t {
+    kFrameExtendedId = 1 << 0,
+    kFrameFd = 1 << 1,
+    kFrameRemote = 1 << 2,
+    kFrameError = 1 << 3,
+};
+
+/**
+ * Fixed-size frame record exchanged between capture, ingest and decoding.
+ * The same layout is used as the wire format of the pipe/shared-memory
+ * stand-in sources, so it must stay trivially copyable.
+ */
+struct FrameRecord {
+    std::uint64_t timestamp; // nanoseconds, source defined epoch
+    std::uint32_t id;
+    std::uint8_t flags;
+    std::uint8_t dlc;
+    std::uint8_t reserved[2];
+    std::uint8_t payload[64];
+};
+
+static_assert(std::is_trivially_copyable<FrameRecord>::value,
+    "FrameRecord is copied as raw bytes");
+
+// Payload length in bytes for a DLC code (codes 9-15 are CAN FD only)
+inline std::uint8_t dlcToLength(std::uint8_t dlc) noexcept
+{
+    static constexpr std::uint8_t lengths[]
+        = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64 };
+    return lengths[dlc & 0x0F];
+}
+
+inline std::uint8_t frameLength(const FrameRecord& frame) noexcept
+{
+    if ((frame.flags & kFrameFd) == 0 && frame.dlc > 8) {
+        return 8;
+    }
+    return dlcToLength(frame.dlc);
+}
+
+} // namespace CANdb
+
+#endif /* end of include guard: FRAME_HPP_HV2C8RTS */
@@ -0,0 +1,97 @@
+#include "id_filter.h"
+#include "log.hpp"
+
+#include <regex>
+
+using namespace CANdb;
+
+constexpr std::uint32_t IdFilter::kStandardIds;
+constexpr std::uint32_t IdFilter::kExtendedIdMask;
+constexpr std::uint32_t IdFilter::kDbcExtendedFlag;
+
+IdFilter::IdFilter(const FilterPredicates& predicates, const CANdb_t& db)
+{
+    for (const auto& range : predicates.ranges) {
+        if (range.extended) {
+            _extendedRanges.emplace_back(range.first, range.last);
+            continue;
+        }
+        const auto last = std::min(range.last, kStandardIds - 1);
+        for (auto id = range.first; id <= last; ++id) {
+            add(id, false);
+        }
+    }
+
+    for (const auto& mask : predicates.masks) {
+        if (mask.extended) {
+            _extendedMasks.push_back(mask);
+            continue;
+        }
+        for (std::uint32_t id = 0; id < kStandardIds; ++id) {
+            if ((id & mask.mask) == (mask.code & mask.mask)) {
+                add(id, false);
+            }
+        }
+    }
+
+    // Regular expressions are built and run once per database
+    std::vector<std::regex> patterns;
+    for (const auto& pattern : predicates.namePatterns) {
+        patterns.emplace_back(pattern);
+    }
+    for (const auto& msg : db.messages) {
+        const auto& m = msg.first;
+        const bool ecuMatch = std::find(predicates.ecus.begin(),
+                                  predicates.ecus.end(), m.ecu)
+            != predicates.ecus.end();
+        const bool nameMatch = std::any_of(patterns.begin(), patterns.end(),
+            [&m](const std::regex& r) { return std::regex_match(m.name, r); });
+        if (ecuMatch || nameMatch) {
+            const auto id = m.id & kExtendedIdMask;
+            add(id, (m.id & kDbcExtendedFlag) != 0 || id >= kStandardIds);
+        }
+    }
+
+    // Merge extended ranges into a sorted list of disjoint ranges
+    std::sort(_extendedRanges.begin(), _extendedRanges.end());
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> merged;
+    for (const auto& range : _extendedRanges) {
+        if (!merged.empty()
+            && range.first <= std::uint64_t{ merged.back().second } + 1) {
+            merged.back().second = std::max(merged.back().second, range.second);
+        } else {
+            merged.push_back(range);
+        }
+    }
+    _extendedRanges = std::move(merged);
+
+    cdb_debug("Filter compiled: {} extended ranges, {} extended ids, {} "
+              "extended masks",
+        _extendedRanges.size(), _extendedIds.size(), _extendedMasks.size());
+}
+
+void IdFilter::add(std::uint32_t id, bool extended)
+{
+    if (extended) {
+        _extendedIds.insert(id);
+    } else {
+        _standard[id / 64] |= std::uint64_t{ 1 } << (id % 64);
+    }
+}
+
+bool IdFilter::acceptsExtended(std::uint32_t id) const noexcept
+{
+    const auto it = std::upper_bound(_extendedRanges.begin(),
+        _extendedRanges.end(), id,
+        [](std::uint32_t v, const std::pair<std::uint32_t, std::uint32_t>& r) {
+            return v < r.first;
+        });
+    if (it != _extendedRanges.begin() && id <= std::prev(it)->second) {
+        return true;
+    }
+    if (!_extendedIds.empty() && _extendedIds.count(id) != 0) {
+        return true;
+    }
+    return std::any_of(_extendedMasks.begin(), _extendedMasks.end(),
+        [id](const IdMask& m) { return (id & m.mask) == (m.code & m.mask); });
+}
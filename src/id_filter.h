@@ -0,0 +1,90 @@
+#ifndef ID_FILTER_H_ZC4M0VKE
+#define ID_FILTER_H_ZC4M0VKE
+
+#include "cantypes.hpp"
+#include "frame.hpp"
+
+#include <array>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace CANdb {
+
+struct IdRange {
+    std::uint32_t first;
+    std::uint32_t last;
+    bool extended;
+};
+
+// Matches ids for which (id & mask) == code
+struct IdMask {
+    std::uint32_t code;
+    std::uint32_t mask;
+    bool extended;
+};
+
+/**
+ * Set of subscription predicates, a frame is accepted when any of them
+ * matches. ecus are matched against CANmessage::ecu and namePatterns are
+ * regular expressions fully matching CANmessage::name.
+ */
+struct FilterPredicates {
+    std::vector<IdRange> ranges;
+    std::vector<IdMask> masks;
+    std::vector<std::string> ecus;
+    std::vector<std::string> namePatterns;
+};
+
+/**
+ * Acceptance filter compiled from FilterPredicates against a database.
+ * Database dependent predicates (ecus, name patterns) are evaluated once
+ * during compilation. Standard ids are answered by a 2048-bit bitmap,
+ * extended ids by a sorted list of disjoint ranges, a hash set and the
+ * extended masks.
+ */
+class IdFilter {
+public:
+    IdFilter() = default;
+    IdFilter(const FilterPredicates& predicates, const CANdb_t& db);
+
+    bool accepts(std::uint32_t id, bool extended) const noexcept
+    {
+        if (!extended) {
+            return id < kStandardIds
+                && ((_standard[id / 64] >> (id % 64)) & 1u) != 0;
+        }
+        return acceptsExtended(id);
+    }
+
+    bool accepts(const FrameRecord& frame) const noexcept
+    {
+        return accepts(frame.id, (frame.flags & kFrameExtendedId) != 0);
+    }
+
+    // DBC ids carry the extended flag in bit 31
+    bool accepts(const CANmessage& msg) const noexcept
+    {
+        const auto id = msg.id & kExtendedIdMask;
+        return accepts(
+            id, (msg.id & kDbcExtendedFlag) != 0 || id >= kStandardIds);
+    }
+
+    static constexpr std::uint32_t kStandardIds = 2048;
+    static constexpr std::uint32_t kExtendedIdMask = 0x1FFFFFFF;
+    static constexpr std::uint32_t kDbcExtendedFlag = 0x80000000;
+
+private:
+    bool acceptsExtended(std::uint32_t id) const noexcept;
+    void add(std::uint32_t id, bool extended);
+
+    std::array<std::uint64_t, kStandardIds / 64> _standard{};
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> _extendedRanges;
+    std::unordered_set<std::uint32_t> _extendedIds;
+    std::vector<IdMask> _extendedMasks;
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: ID_FILTER_H_ZC4M0VKE */
@@ -0,0 +1,206 @@
+#include "ingest.h"
+#include "log.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using namespace CANdb;
+
+#ifndef _WIN32
+FdFrameSource::FdFrameSource(int fd)
+    : _fd(fd)
+{
+}
+
+std::size_t FdFrameSource::read(FrameRecord* frames, std::size_t max)
+{
+    constexpr auto recordSize = sizeof(FrameRecord);
+    if (max == 0) {
+        return 0;
+    }
+    _buffer.resize(max * recordSize);
+
+    while (_filled < recordSize) {
+        const auto n
+            = ::read(_fd, _buffer.data() + _filled, _buffer.size() - _filled);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            cdb_error("Frame source read failed: {}", std::strerror(errno));
+            return 0;
+        }
+        if (n == 0) {
+            if (_filled != 0) {
+                cdb_warn("Frame source ended with {} stray bytes", _filled);
+            }
+            return 0;
+        }
+        _filled += static_cast<std::size_t>(n);
+    }
+
+    const auto count = _filled / recordSize;
+    std::memcpy(frames, _buffer.data(), count * recordSize);
+
+    const auto rest = _filled - count * recordSize;
+    std::memmove(_buffer.data(), _buffer.data() + count * recordSize, rest);
+    _filled = rest;
+    return count;
+}
+
+bool CANdb::writeFrames(int fd, const FrameRecord* frames, std::size_t count)
+{
+    auto data = reinterpret_cast<const std::uint8_t*>(frames);
+    auto left = count * sizeof(FrameRecord);
+    while (left > 0) {
+        const auto n = ::write(fd, data, left);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            cdb_error("Frame write failed: {}", std::strerror(errno));
+            return false;
+        }
+        data += n;
+        left -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+#endif
+
+StreamFrameSource::StreamFrameSource(InputStream& input)
+    : _input(input)
+{
+}
+
+std::size_t StreamFrameSource::read(FrameRecord* frames, std::size_t max)
+{
+    constexpr auto recordSize = sizeof(FrameRecord);
+    if (max == 0) {
+        return 0;
+    }
+    _buffer.resize(std::max(max * recordSize, _filled));
+
+    try {
+        while (_filled < recordSize) {
+            const auto n = _input.read(
+                _buffer.data() + _filled, _buffer.size() - _filled);
+            if (n == 0) {
+                if (_filled != 0) {
+                    cdb_warn("Frame stream ended with {} stray bytes", _filled);
+                }
+                return 0;
+            }
+            _filled += n;
+        }
+    } catch (const std::exception& ex) {
+        cdb_error("Frame stream read failed: {}", ex.what());
+        return 0;
+    }
+
+    const auto count = std::min(max, _filled / recordSize);
+    std::memcpy(frames, _buffer.data(), count * recordSize);
+
+    const auto rest = _filled - count * recordSize;
+    std::memmove(_buffer.data(), _buffer.data() + count * recordSize, rest);
+    _filled = rest;
+    return count;
+}
+
+IngestPipeline::IngestPipeline(FrameSource& source, Consumer consumer,
+    std::size_t capacity, std::size_t batchSize)
+    : _source(source)
+    , _consumer(std::move(consumer))
+    , _batchSize(std::max<std::size_t>(batchSize, 1))
+    , _ring(capacity)
+{
+}
+
+IngestPipeline::~IngestPipeline()
+{
+    stop();
+}
+
+void IngestPipeline::start()
+{
+    _producer = std::thread{ [this]() { produce(); } };
+    _consumerThread = std::thread{ [this]() { consume(); } };
+}
+
+void IngestPipeline::join()
+{
+    if (_producer.joinable()) {
+        _producer.join();
+    }
+    if (_consumerThread.joinable()) {
+        _consumerThread.join();
+    }
+}
+
+void IngestPipeline::stop()
+{
+    _stop = true;
+    join();
+}
+
+IngestStats IngestPipeline::stats() const noexcept
+{
+    IngestStats s;
+    s.frames = _frames.load(std::memory_order_relaxed);
+    s.batches = _batches.load(std::memory_order_relaxed);
+    s.ringFull = _ringFull.load(std::memory_order_relaxed);
+    return s;
+}
+
+void IngestPipeline::produce()
+{
+    std::vector<FrameRecord> batch(_batchSize);
+
+    while (!_stop.load(std::memory_order_relaxed)) {
+        const auto count = _source.read(batch.data(), batch.size());
+        if (count == 0) {
+            break;
+        }
+
+        std::size_t pushed = 0;
+        while (pushed < count) {
+            pushed += _ring.push(batch.data() + pushed, count - pushed);
+            if (pushed < count) {
+                if (_stop.load(std::memory_order_relaxed)) {
+                    break;
+                }
+                _ringFull.fetch_add(1, std::memory_order_relaxed);
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    _producerDone.store(true, std::memory_order_release);
+}
+
+void IngestPipeline::consume()
+{
+    std::vector<FrameRecord> batch(_batchSize);
+
+    while (!_stop.load(std::memory_order_relaxed)) {
+        // Read the flag first so frames pushed right before it are drained
+        const auto done = _producerDone.load(std::memory_order_acquire);
+        const auto count = _ring.pop(batch.data(), batch.size());
+        if (count == 0) {
+            if (done) {
+                break;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+
+        _consumer(batch.data(), count);
+        _frames.fetch_add(count, std::memory_order_relaxed);
+        _batches.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,137 @@
+#ifndef INGEST_H_R4UV1MZC
+#define INGEST_H_R4UV1MZC
+
+#include "decoder.h"
+#include "frame.hpp"
+#include "input_stream.h"
+#include "spsc_ring.hpp"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace CANdb {
+
+struct FrameSource {
+    virtual ~FrameSource() = default;
+
+    /**
+     * Blocks until at least one frame is available and copies up to max
+     * frames into the buffer. Returns 0 at the end of the stream.
+     */
+    virtual std::size_t read(FrameRecord* frames, std::size_t max) = 0;
+};
+
+#ifndef _WIN32
+/**
+ * Stand-in for a capture process: reads raw FrameRecord bytes from a file
+ * descriptor (pipe, fifo or socket). The descriptor is not owned.
+ */
+class FdFrameSource : public FrameSource {
+public:
+    explicit FdFrameSource(int fd);
+
+    std::size_t read(FrameRecord* frames, std::size_t max) override;
+
+private:
+    int _fd;
+    std::vector<std::uint8_t> _buffer;
+    std::size_t _filled{ 0 };
+};
+
+// Writes frames in the FdFrameSource wire format, false on write errors
+bool writeFrames(int fd, const FrameRecord* frames, std::size_t count);
+#endif
+
+/**
+ * Reads the FdFrameSource wire format from an input stream in chunks, e.g.
+ * a recording opened with openInput() that is decompressed on the fly. The
+ * stream is not owned, read errors end the source.
+ */
+class StreamFrameSource : public FrameSource {
+public:
+    explicit StreamFrameSource(InputStream& input);
+
+    std::size_t read(FrameRecord* frames, std::size_t max) override;
+
+private:
+    InputStream& _input;
+    std::vector<char> _buffer;
+    std::size_t _filled{ 0 };
+};
+
+struct IngestStats {
+    std::uint64_t frames{ 0 };
+    std::uint64_t batches{ 0 };
+    std::uint64_t ringFull{ 0 };
+};
+
+/**
+ * Two-thread ingest stage: a producer thread pulls frames from a source
+ * into a lock-free SPSC ring and a consumer thread dequeues them in
+ * batches and hands every batch to the consumer callback.
+ */
+class IngestPipeline {
+public:
+    using Consumer = std::function<void(const FrameRecord*, std::size_t)>;
+
+    IngestPipeline(FrameSource& source, Consumer consumer,
+        std::size_t capacity = 4096, std::size_t batchSize = 64);
+    ~IngestPipeline();
+
+    IngestPipeline(const IngestPipeline&) = delete;
+    IngestPipeline& operator=(const IngestPipeline&) = delete;
+
+    void start();
+
+    // Waits until the source ended and every queued frame was consumed
+    void join();
+
+    /**
+     * Stops both threads without draining the ring. A producer blocked in
+     * FrameSource::read() exits once that read returns.
+     */
+    void stop();
+
+    IngestStats stats() const noexcept;
+
+private:
+    void produce();
+    void consume();
+
+    FrameSource& _source;
+    Consumer _consumer;
+    std::size_t _batchSize;
+    SpscRing<FrameRecord> _ring;
+
+    std::atomic<bool> _producerDone{ false };
+    std::atomic<bool> _stop{ false };
+    std::atomic<std::uint64_t> _frames{ 0 };
+    std::atomic<std::uint64_t> _batches{ 0 };
+    std::atomic<std::uint64_t> _ringFull{ 0 };
+
+    std::thread _producer;
+    std::thread _consumerThread;
+};
+
+/**
+ * Consumer that runs every dequeued frame through the decoder and calls
+ * f(message, signal, raw) for every emitted signal. The decoder is only
+ * used from the consumer thread.
+ */
+template <typename F>
+IngestPipeline::Consumer makeDecodingConsumer(Decoder& decoder, F f)
+{
+    return [&decoder, f](const FrameRecord* frames, std::size_t count) mutable {
+        for (std::size_t i = 0; i < count; ++i) {
+            decoder.decode(frames[i].id, frames[i].payload,
+                frameLength(frames[i]), f);
+        }
+    };
+}
+
+} // namespace CANdb
+
+#endif /* end of include guard: INGEST_H_R4UV1MZC */
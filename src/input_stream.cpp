@@ -0,0 +1,263 @@
+#include "input_stream.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <spdlog/fmt/fmt.h>
+#include <stdexcept>
+#include <vector>
+
+#include <sys/stat.h>
+
+#if CANDB_HAS_ZLIB
+#include <zlib.h>
+#endif
+#if CANDB_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace CANdb;
+
+FileInputStream::FileInputStream(const std::string& path)
+    : _path(path)
+    , _file(std::fopen(path.c_str(), "rb"))
+{
+    if (_file == nullptr) {
+        throw std::runtime_error(fmt::format(
+            "Unable to open {}: {}", path, std::strerror(errno)));
+    }
+    struct stat st;
+    if (::stat(path.c_str(), &st) == 0 && st.st_size > 0) {
+        _left = static_cast<std::uint64_t>(st.st_size);
+    }
+}
+
+FileInputStream::~FileInputStream() { std::fclose(_file); }
+
+std::size_t FileInputStream::read(char* data, std::size_t size)
+{
+    std::size_t count = std::min(size, _peeked.size());
+    std::memcpy(data, _peeked.data(), count);
+    _peeked.erase(0, count);
+
+    if (count < size) {
+        count += std::fread(data + count, 1, size - count, _file);
+        if (std::ferror(_file) != 0) {
+            throw std::runtime_error(fmt::format("Unable to read {}", _path));
+        }
+    }
+    _left -= std::min<std::uint64_t>(_left, count);
+    return count;
+}
+
+std::size_t FileInputStream::peek(char* data, std::size_t size)
+{
+    if (_peeked.size() < size) {
+        const auto have = _peeked.size();
+        _peeked.resize(size);
+        const auto n = std::fread(&_peeked[have], 1, size - have, _file);
+        _peeked.resize(have + n);
+    }
+    const auto count = std::min(size, _peeked.size());
+    std::memcpy(data, _peeked.data(), count);
+    return count;
+}
+
+std::size_t MemoryInputStream::read(char* data, std::size_t size)
+{
+    const auto count = std::min(size, _left);
+    std::memcpy(data, _data, count);
+    _data += count;
+    _left -= count;
+    return count;
+}
+
+#if CANDB_HAS_ZLIB
+struct GzipInputStream::State {
+    z_stream stream{};
+    std::vector<char> chunk;
+    // The last member is complete, the input may end here
+    bool ended{ false };
+    // The output filled up, zlib may hold more without new input
+    bool pending{ false };
+};
+
+GzipInputStream::GzipInputStream(
+    std::unique_ptr<InputStream> source, std::size_t chunkSize)
+    : _source(std::move(source))
+    , _state(std::make_unique<State>())
+{
+    _state->chunk.resize(chunkSize);
+    // 15 window bits plus 32 detects gzip and zlib headers
+    if (inflateInit2(&_state->stream, 15 + 32) != Z_OK) {
+        throw std::runtime_error("gzip: unable to initialize zlib");
+    }
+}
+
+GzipInputStream::~GzipInputStream() { inflateEnd(&_state->stream); }
+
+std::size_t GzipInputStream::read(char* data, std::size_t size)
+{
+    auto& z = _state->stream;
+    z.next_out = reinterpret_cast<Bytef*>(data);
+    z.avail_out = static_cast<uInt>(std::min<std::size_t>(size, UINT32_MAX));
+    const auto capacity = z.avail_out;
+
+    while (z.avail_out == capacity && capacity != 0) {
+        if (z.avail_in == 0 && !_state->pending) {
+            const auto n
+                = _source->read(_state->chunk.data(), _state->chunk.size());
+            if (n == 0) {
+                if (!_state->ended) {
+                    throw std::runtime_error("gzip: truncated input");
+                }
+                return 0;
+            }
+            z.next_in = reinterpret_cast<Bytef*>(_state->chunk.data());
+            z.avail_in = static_cast<uInt>(n);
+        }
+
+        const auto ret = inflate(&z, Z_NO_FLUSH);
+        _state->pending = z.avail_out == 0;
+        if (ret == Z_STREAM_END) {
+            // Another member may follow
+            _state->ended = true;
+            inflateReset(&z);
+        } else if (ret == Z_BUF_ERROR) {
+            _state->pending = false;
+        } else if (ret == Z_OK) {
+            _state->ended = false;
+        } else {
+            throw std::runtime_error(fmt::format(
+                "gzip: {}", z.msg != nullptr ? z.msg : "corrupt input"));
+        }
+    }
+    return capacity - z.avail_out;
+}
+#endif
+
+#if CANDB_HAS_ZSTD
+struct ZstdInputStream::State {
+    ZSTD_DStream* stream{ nullptr };
+    std::vector<char> chunk;
+    ZSTD_inBuffer in{ nullptr, 0, 0 };
+    // 0 once a frame is complete, the input may end there
+    std::size_t hint{ 1 };
+    bool pending{ false };
+};
+
+ZstdInputStream::ZstdInputStream(
+    std::unique_ptr<InputStream> source, std::size_t chunkSize)
+    : _source(std::move(source))
+    , _state(std::make_unique<State>())
+{
+    _state->chunk.resize(chunkSize);
+    _state->stream = ZSTD_createDStream();
+    if (_state->stream == nullptr
+        || ZSTD_isError(ZSTD_initDStream(_state->stream))) {
+        ZSTD_freeDStream(_state->stream);
+        throw std::runtime_error("zstd: unable to initialize decoder");
+    }
+}
+
+ZstdInputStream::~ZstdInputStream() { ZSTD_freeDStream(_state->stream); }
+
+std::size_t ZstdInputStream::read(char* data, std::size_t size)
+{
+    auto& in = _state->in;
+    ZSTD_outBuffer out{ data, size, 0 };
+
+    while (out.pos == 0 && size != 0) {
+        if (in.pos == in.size && !_state->pending) {
+            const auto n
+                = _source->read(_state->chunk.data(), _state->chunk.size());
+            if (n == 0) {
+                if (_state->hint != 0) {
+                    throw std::runtime_error("zstd: truncated input");
+                }
+                return 0;
+            }
+            in = ZSTD_inBuffer{ _state->chunk.data(), n, 0 };
+        }
+
+        const auto ret = ZSTD_decompressStream(_state->stream, &out, &in);
+        if (ZSTD_isError(ret)) {
+            throw std::runtime_error(
+                fmt::format("zstd: {}", ZSTD_getErrorName(ret)));
+        }
+        _state->hint = ret;
+        _state->pending = out.pos == out.size;
+    }
+    return out.pos;
+}
+#endif
+
+Compression CANdb::detectCompression(
+    const char* magic, std::size_t size) noexcept
+{
+    const auto bytes = reinterpret_cast<const unsigned char*>(magic);
+    if (size >= 2 && bytes[0] == 0x1F && bytes[1] == 0x8B) {
+        return Compression::Gzip;
+    }
+    if (size >= 4 && bytes[0] == 0x28 && bytes[1] == 0xB5 && bytes[2] == 0x2F
+        && bytes[3] == 0xFD) {
+        return Compression::Zstd;
+    }
+    return Compression::None;
+}
+
+std::unique_ptr<InputStream> CANdb::openInput(const std::string& path)
+{
+    auto file = std::make_unique<FileInputStream>(path);
+    char magic[4];
+    const auto size = file->peek(magic, sizeof(magic));
+
+    switch (detectCompression(magic, size)) {
+    case Compression::Gzip:
+#if CANDB_HAS_ZLIB
+        return std::make_unique<GzipInputStream>(std::move(file));
+#else
+        throw std::runtime_error(
+            fmt::format("{} is gzip compressed, built without zlib", path));
+#endif
+    case Compression::Zstd:
+#if CANDB_HAS_ZSTD
+        return std::make_unique<ZstdInputStream>(std::move(file));
+#else
+        throw std::runtime_error(
+            fmt::format("{} is zstd compressed, built without zstd", path));
+#endif
+    case Compression::None:
+        break;
+    }
+    return file;
+}
+
+void CANdb::readAll(InputStream& input, std::string& out)
+{
+    // One byte past the hint sees the end without growing
+    const auto hint = input.sizeHint();
+    out.resize(hint != 0 ? static_cast<std::size_t>(hint) + 1
+                         : InputStream::kChunkSize);
+
+    std::size_t filled = 0;
+    for (;;) {
+        if (filled == out.size()) {
+            out.resize(out.size() * 2);
+        }
+        const auto n = input.read(&out[filled], out.size() - filled);
+        if (n == 0) {
+            break;
+        }
+        filled += n;
+    }
+    out.resize(filled);
+}
+
+std::string CANdb::readAll(InputStream& input)
+{
+    std::string out;
+    readAll(input, out);
+    return out;
+}
@@ -0,0 +1,126 @@
+#ifndef INPUT_STREAM_H_K3NB8QZE
+#define INPUT_STREAM_H_K3NB8QZE
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+namespace CANdb {
+
+/**
+ * Sequential byte source. Decompressing streams pull compressed chunks from
+ * the stream they wrap and only hold one chunk and the decoder state, so
+ * reading a compressed file never needs it decompressed on disk or as a
+ * whole in memory unless readAll() asks for that.
+ */
+class InputStream {
+public:
+    static constexpr std::size_t kChunkSize = 64 * 1024;
+
+    virtual ~InputStream() = default;
+
+    /**
+     * Copies up to size bytes into data and returns how many, 0 only at the
+     * end of the stream. Throws std::runtime_error on read errors and
+     * corrupt or truncated compressed data.
+     */
+    virtual std::size_t read(char* data, std::size_t size) = 0;
+
+    // Bytes left if known up front, 0 otherwise
+    virtual std::uint64_t sizeHint() const noexcept { return 0; }
+};
+
+class FileInputStream : public InputStream {
+public:
+    // Throws std::runtime_error if path can not be opened
+    explicit FileInputStream(const std::string& path);
+    ~FileInputStream() override;
+
+    FileInputStream(const FileInputStream&) = delete;
+    FileInputStream& operator=(const FileInputStream&) = delete;
+
+    std::size_t read(char* data, std::size_t size) override;
+    std::uint64_t sizeHint() const noexcept override { return _left; }
+
+    // The next bytes read() returns, without consuming them
+    std::size_t peek(char* data, std::size_t size);
+
+private:
+    std::string _path;
+    std::FILE* _file;
+    std::string _peeked;
+    std::uint64_t _left{ 0 };
+};
+
+// Bytes owned by the caller, e.g. a compressed artifact already in memory
+class MemoryInputStream : public InputStream {
+public:
+    MemoryInputStream(const char* data, std::size_t size) noexcept
+        : _data(data)
+        , _left(size)
+    {
+    }
+
+    std::size_t read(char* data, std::size_t size) override;
+    std::uint64_t sizeHint() const noexcept override { return _left; }
+
+private:
+    const char* _data;
+    std::size_t _left;
+};
+
+#if CANDB_HAS_ZLIB
+// gzip (also concatenated members) or zlib data of source, through zlib
+class GzipInputStream : public InputStream {
+public:
+    explicit GzipInputStream(std::unique_ptr<InputStream> source,
+        std::size_t chunkSize = kChunkSize);
+    ~GzipInputStream() override;
+
+    std::size_t read(char* data, std::size_t size) override;
+
+private:
+    struct State;
+    std::unique_ptr<InputStream> _source;
+    std::unique_ptr<State> _state;
+};
+#endif
+
+#if CANDB_HAS_ZSTD
+// Zstandard frames of source, through libzstd
+class ZstdInputStream : public InputStream {
+public:
+    explicit ZstdInputStream(std::unique_ptr<InputStream> source,
+        std::size_t chunkSize = kChunkSize);
+    ~ZstdInputStream() override;
+
+    std::size_t read(char* data, std::size_t size) override;
+
+private:
+    struct State;
+    std::unique_ptr<InputStream> _source;
+    std::unique_ptr<State> _state;
+};
+#endif
+
+enum class Compression { None, Gzip, Zstd };
+
+// Compression of data starting with magic, None if it is not recognized
+Compression detectCompression(const char* magic, std::size_t size) noexcept;
+
+/**
+ * Opens path and decompresses it if it starts with a gzip or zstd header,
+ * whatever its name. Throws std::runtime_error if it can not be opened or
+ * the library for its compression was not found at configure time.
+ */
+std::unique_ptr<InputStream> openInput(const std::string& path);
+
+// Reads everything left into out, keeping out's memory if it is enough
+void readAll(InputStream& input, std::string& out);
+std::string readAll(InputStream& input);
+
+} // namespace CANdb
+
+#endif /* end of include guard: INPUT_STREAM_H_K3NB8QZE */
@@ -0,0 +1,181 @@
+#include "layout_check.h"
+#include "decoder.h"
+
+#include <map>
+
+using namespace CANdb;
+
+namespace {
+bool anyBit(const PayloadMask& mask) noexcept
+{
+    std::uint64_t any = 0;
+    for (const auto w : mask) {
+        any |= w;
+    }
+    return any != 0;
+}
+
+PayloadMask operator&(const PayloadMask& lhs, const PayloadMask& rhs) noexcept
+{
+    PayloadMask r;
+    for (std::size_t i = 0; i < r.size(); ++i) {
+        r[i] = lhs[i] & rhs[i];
+    }
+    return r;
+}
+
+unsigned bitCount(const PayloadMask& mask) noexcept
+{
+    unsigned count = 0;
+    for (auto w : mask) {
+        for (; w != 0; w &= w - 1) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+// Lowest and highest set bit, the mask must not be empty
+void bitRange(const PayloadMask& mask, unsigned& first, unsigned& last)
+{
+    first = kMaxPayload * 8;
+    last = 0;
+    for (unsigned bit = 0; bit < kMaxPayload * 8; ++bit) {
+        if ((mask[bit / 64] >> (bit % 64)) & 1u) {
+            first = std::min(first, bit);
+            last = bit;
+        }
+    }
+}
+
+// Bits that lie outside the first len payload bytes
+PayloadMask outside(const PayloadMask& mask, std::size_t len)
+{
+    PayloadMask r = mask;
+    const auto bits = std::min(len, kMaxPayload) * 8;
+    for (std::size_t w = 0; w < r.size(); ++w) {
+        const auto start = w * 64;
+        if (bits >= start + 64) {
+            r[w] = 0;
+        } else if (bits > start) {
+            r[w] &= ~((std::uint64_t{ 1 } << (bits - start)) - 1);
+        }
+    }
+    return r;
+}
+
+// The signal does not fit into a 64 byte payload at all
+bool truncated(const CANsignal& sig, const PayloadMask& mask)
+{
+    return bitCount(mask) < sig.signalSize;
+}
+
+LayoutIssue makeIssue(LayoutIssue::Kind kind, const CANmessage& msg,
+    const CANsignal& sig, const PayloadMask& bits)
+{
+    LayoutIssue issue{ kind, msg.id, msg.name, sig.signal_name, "", 0, 0 };
+    if (anyBit(bits)) {
+        bitRange(bits, issue.firstBit, issue.lastBit);
+    } else {
+        issue.firstBit = issue.lastBit = sig.startBit;
+    }
+    return issue;
+}
+} // namespace
+
+const char* CANdb::toString(LayoutIssue::Kind kind) noexcept
+{
+    switch (kind) {
+    case LayoutIssue::Kind::Overlap:
+        return "overlap";
+    case LayoutIssue::Kind::ExceedsDlc:
+        return "exceeds dlc";
+    case LayoutIssue::Kind::ByteOrder:
+        return "byte order";
+    case LayoutIssue::Kind::InvalidByteOrder:
+        return "invalid byte order";
+    case LayoutIssue::Kind::EmptySignal:
+        return "empty signal";
+    }
+    return "unknown";
+}
+
+std::vector<LayoutIssue> CANdb::checkLayout(const CANdb_t& db)
+{
+    std::vector<LayoutIssue> issues;
+    std::vector<PayloadMask> masks;
+    std::vector<std::int64_t> groups;
+    // Bits of every multiplexed group seen in the message so far
+    std::map<std::int64_t, PayloadMask> groupBits;
+
+    for (const auto& msg : db.messages) {
+        const auto& signals = msg.second;
+        // Bits of the signals present in every frame, the switch included
+        PayloadMask occupied{};
+        PayloadMask multiplexed{};
+        masks.clear();
+        groups.clear();
+        groupBits.clear();
+
+        for (const auto& sig : signals) {
+            const auto mask = signalMask(sig);
+            const auto group = multiplexGroup(sig);
+            masks.push_back(mask);
+            groups.push_back(group);
+
+            if (sig.signalSize == 0) {
+                issues.push_back(makeIssue(
+                    LayoutIssue::Kind::EmptySignal, msg.first, sig, mask));
+                continue;
+            }
+            if (sig.byteOrder > 1) {
+                issues.push_back(makeIssue(LayoutIssue::Kind::InvalidByteOrder,
+                    msg.first, sig, mask));
+            }
+
+            const auto past = outside(mask, msg.first.dlc);
+            if (anyBit(past) || truncated(sig, mask)) {
+                // Would the same start bit fit with the other byte order?
+                auto swapped = sig;
+                swapped.byteOrder = sig.byteOrder == 1 ? 0 : 1;
+                const auto swappedMask = signalMask(swapped);
+                const bool fitsSwapped = sig.byteOrder <= 1
+                    && !anyBit(outside(swappedMask, msg.first.dlc))
+                    && !truncated(swapped, swappedMask);
+
+                issues.push_back(makeIssue(fitsSwapped
+                        ? LayoutIssue::Kind::ByteOrder
+                        : LayoutIssue::Kind::ExceedsDlc,
+                    msg.first, sig, past));
+            }
+
+            // Groups of a multiplexed message never share a frame, only
+            // signals present at the same time can overlap
+            auto& own = group == kNotMultiplexed ? occupied : groupBits[group];
+            const auto& others
+                = group == kNotMultiplexed ? multiplexed : occupied;
+            if (anyBit(own & mask) || anyBit(others & mask)) {
+                // Rare path: find the signals owning the conflicting bits
+                for (std::size_t i = 0; i + 1 < masks.size(); ++i) {
+                    const auto shared = masks[i] & mask;
+                    const bool together = groups[i] == kNotMultiplexed
+                        || group == kNotMultiplexed || groups[i] == group;
+                    if (together && anyBit(shared)) {
+                        auto issue = makeIssue(LayoutIssue::Kind::Overlap,
+                            msg.first, sig, shared);
+                        issue.other = signals[i].signal_name;
+                        issues.push_back(std::move(issue));
+                    }
+                }
+            }
+            for (std::size_t w = 0; w < occupied.size(); ++w) {
+                own[w] |= mask[w];
+                if (group != kNotMultiplexed) {
+                    multiplexed[w] |= mask[w];
+                }
+            }
+        }
+    }
+
+    return issues;
+}
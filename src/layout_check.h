@@ -0,0 +1,43 @@
+#ifndef LAYOUT_CHECK_H_M1TG8WQS
+#define LAYOUT_CHECK_H_M1TG8WQS
+
+#include "cantypes.hpp"
+
+#include <string>
+#include <vector>
+
+namespace CANdb {
+
+struct LayoutIssue {
+    enum class Kind {
+        Overlap, // signal shares bits with another signal
+        ExceedsDlc, // signal has bits past the message dlc
+        ByteOrder, // exceeds the dlc, but would fit with the other byte order
+        InvalidByteOrder, // byteOrder is neither 0 (Motorola) nor 1 (Intel)
+        EmptySignal, // signalSize is 0
+    };
+
+    Kind kind;
+    std::uint32_t messageId;
+    std::string message;
+    std::string signal;
+    std::string other; // second signal of an Overlap
+    // Offending payload bits in DBC numbering (byte * 8 + bit)
+    unsigned firstBit;
+    unsigned lastBit;
+};
+
+const char* toString(LayoutIssue::Kind kind) noexcept;
+
+/**
+ * Checks every message for overlapping signals, signals past the dlc and
+ * byte order mistakes. A 512-bit occupancy mask is built per message from
+ * the signals' startBit, signalSize and byteOrder, conflicts are found with
+ * bitwise operations in a single pass over the signals. Signals of
+ * different multiplexed groups ("m<n>") may share bits.
+ */
+std::vector<LayoutIssue> checkLayout(const CANdb_t& db);
+
+} // namespace CANdb
+
+#endif /* end of include guard: LAYOUT_CHECK_H_M1TG8WQS */
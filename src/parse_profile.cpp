@@ -0,0 +1,120 @@
+#include "parse_profile.h"
+
+#include <algorithm>
+
+using namespace CANdb;
+
+namespace {
+double toMs(ParseProfiler::Clock::duration d)
+{
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+} // namespace
+
+ParseProfiler::ParseProfiler(const std::string& input)
+    : _input(input)
+    , _start(Clock::now())
+{
+    _lineStarts.push_back(0);
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        if (input[i] == '\n') {
+            _lineStarts.push_back(i + 1);
+        }
+    }
+    _lineFailures.assign(_lineStarts.size(), 0);
+}
+
+std::size_t ParseProfiler::rule(const std::string& name)
+{
+    _names.push_back(name);
+    _counters.emplace_back();
+    return _names.size() - 1;
+}
+
+void ParseProfiler::enter(std::size_t rule)
+{
+    ++_counters[rule].attempts;
+    _stack.push_back(Frame{ rule, Clock::now(), Clock::duration{ 0 } });
+}
+
+void ParseProfiler::leave(std::size_t rule, const char* position, bool success)
+{
+    const auto now = Clock::now();
+
+    // Unwind frames left open by exceptions thrown in semantic actions
+    while (!_stack.empty() && _stack.back().rule != rule) {
+        _stack.pop_back();
+    }
+    if (_stack.empty()) {
+        return;
+    }
+
+    const auto frame = _stack.back();
+    _stack.pop_back();
+    const auto elapsed = now - frame.start;
+
+    auto& counters = _counters[rule];
+    counters.total += elapsed;
+    counters.self += elapsed - frame.children;
+    if (!_stack.empty()) {
+        _stack.back().children += elapsed;
+    }
+
+    if (success) {
+        ++counters.successes;
+    } else if (position != nullptr) {
+        ++_lineFailures[lineOf(position)];
+    }
+}
+
+std::size_t ParseProfiler::lineOf(const char* position) const
+{
+    const auto begin = _input.data();
+    if (position < begin || position > begin + _input.size()) {
+        return 0;
+    }
+    const auto offset = static_cast<std::size_t>(position - begin);
+    const auto it
+        = std::upper_bound(_lineStarts.begin(), _lineStarts.end(), offset);
+    return static_cast<std::size_t>(it - _lineStarts.begin()) - 1;
+}
+
+ParseProfile ParseProfiler::finish(std::size_t maxLines) const
+{
+    ParseProfile profile;
+    profile.totalMs = toMs(Clock::now() - _start);
+
+    for (std::size_t i = 0; i < _names.size(); ++i) {
+        const auto& c = _counters[i];
+        if (c.attempts == 0) {
+            continue;
+        }
+        RuleProfile rule;
+        rule.rule = _names[i];
+        rule.attempts = c.attempts;
+        rule.successes = c.successes;
+        rule.failures = c.attempts - c.successes;
+        rule.totalMs = toMs(c.total);
+        rule.selfMs = toMs(c.self);
+        profile.rules.push_back(std::move(rule));
+    }
+    std::sort(profile.rules.begin(), profile.rules.end(),
+        [](const RuleProfile& lhs, const RuleProfile& rhs) {
+            return lhs.selfMs > rhs.selfMs;
+        });
+
+    for (std::size_t i = 0; i < _lineFailures.size(); ++i) {
+        if (_lineFailures[i] != 0) {
+            profile.lines.push_back(LineHotSpot{ i + 1, _lineFailures[i] });
+        }
+    }
+    std::sort(profile.lines.begin(), profile.lines.end(),
+        [](const LineHotSpot& lhs, const LineHotSpot& rhs) {
+            return lhs.failures != rhs.failures ? lhs.failures > rhs.failures
+                                                : lhs.line < rhs.line;
+        });
+    if (profile.lines.size() > maxLines) {
+        profile.lines.resize(maxLines);
+    }
+    return profile;
+}
@@ -0,0 +1,79 @@
+#ifndef PARSE_PROFILE_H_N4XW8ELD
+#define PARSE_PROFILE_H_N4XW8ELD
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace CANdb {
+
+struct RuleProfile {
+    std::string rule;
+    std::uint64_t attempts{ 0 };
+    std::uint64_t successes{ 0 };
+    std::uint64_t failures{ 0 };
+    double totalMs{ 0 }; // including nested rules
+    double selfMs{ 0 }; // excluding nested rules
+};
+
+// Line (1-based) where many rule attempts failed and the parser backtracked
+struct LineHotSpot {
+    std::size_t line;
+    std::uint64_t failures;
+};
+
+struct ParseProfile {
+    double totalMs{ 0 };
+    std::vector<RuleProfile> rules; // sorted by selfMs, descending
+    std::vector<LineHotSpot> lines; // sorted by failures, descending
+};
+
+/**
+ * Collects per-rule counters and timings from the grammar enter/leave
+ * hooks. Each rule invocation costs two clock reads, so profiling is opt-in.
+ */
+class ParseProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // input has to be the buffer handed to the grammar
+    explicit ParseProfiler(const std::string& input);
+
+    // Registers a rule, returns the id passed to enter()/leave()
+    std::size_t rule(const std::string& name);
+
+    void enter(std::size_t rule);
+    void leave(std::size_t rule, const char* position, bool success);
+
+    ParseProfile finish(std::size_t maxLines = 50) const;
+
+private:
+    struct Frame {
+        std::size_t rule;
+        Clock::time_point start;
+        Clock::duration children;
+    };
+
+    struct Counters {
+        std::uint64_t attempts{ 0 };
+        std::uint64_t successes{ 0 };
+        Clock::duration total{ 0 };
+        Clock::duration self{ 0 };
+    };
+
+    std::size_t lineOf(const char* position) const;
+
+    const std::string& _input;
+    Clock::time_point _start;
+    std::vector<std::string> _names;
+    std::vector<Counters> _counters;
+    std::vector<Frame> _stack;
+    std::vector<std::size_t> _lineStarts;
+    std::vector<std::uint64_t> _lineFailures;
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: PARSE_PROFILE_H_N4XW8ELD */
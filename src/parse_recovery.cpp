@@ -0,0 +1,226 @@
+#include "parse_recovery.h"
+
+#include <algorithm>
+#include <cctype>
+#include <utility>
+
+using namespace CANdb;
+
+namespace {
+// Top-level keywords and the grammar rule of their statement
+const std::pair<const char*, const char*> kKeywords[] = {
+    { "VERSION", "version" },
+    { "NS_", "ns" },
+    { "BS_", "bs" },
+    { "BU_", "bu" },
+    { "VAL_TABLE_", "val_entry" },
+    { "BO_", "message" },
+    { "SG_", "signal" },
+    { "BO_TX_BU_", "bo_tx_bu" },
+    { "CM_", "cm" },
+    { "BA_DEF_", "ba_def" },
+    { "BA_DEF_DEF_", "ba_def_def" },
+    { "BA_", "ba" },
+    { "VAL_", "vals" },
+    { "SIG_VALTYPE_", "sig_val" },
+    { "EV_", nullptr },
+    { "ENVVAR_DATA_", nullptr },
+    { "SGTYPE_", nullptr },
+    { "SIG_GROUP_", nullptr },
+    { "SIG_TYPE_REF_", nullptr },
+    { "BA_DEF_REL_", nullptr },
+    { "BA_REL_", nullptr },
+    { "BA_DEF_DEF_REL_", nullptr },
+    { "BU_SG_REL_", nullptr },
+    { "BU_EV_REL_", nullptr },
+    { "BU_BO_REL_", nullptr },
+    { "CAT_DEF_", nullptr },
+    { "CAT_", nullptr },
+    { "FILTER", nullptr },
+};
+
+bool isBlank(char c) noexcept { return c == ' ' || c == '\t' || c == '\r'; }
+
+bool isTokenChar(char c) noexcept
+{
+    return std::isalnum(static_cast<unsigned char>(c)) != 0 || c == '_';
+}
+
+bool isKeyword(const std::string& token) noexcept
+{
+    return std::any_of(std::begin(kKeywords), std::end(kKeywords),
+        [&token](const auto& k) { return token == k.first; });
+}
+} // namespace
+
+std::string CANdb::statementRule(const std::string& keyword)
+{
+    for (const auto& k : kKeywords) {
+        if (keyword == k.first) {
+            return k.second != nullptr ? k.second : k.first;
+        }
+    }
+    return keyword;
+}
+
+RecoveryBuffer::RecoveryBuffer(const std::string& input)
+    : _text(input)
+{
+    indexLines();
+    _originalLines.resize(_lineStarts.size());
+    for (std::size_t i = 0; i < _originalLines.size(); ++i) {
+        _originalLines[i] = i + 1;
+    }
+}
+
+void RecoveryBuffer::indexLines()
+{
+    _lineStarts.assign(1, 0);
+    for (std::size_t i = 0; i < _text.size(); ++i) {
+        if (_text[i] == '\n') {
+            _lineStarts.push_back(i + 1);
+        }
+    }
+}
+
+std::size_t RecoveryBuffer::originalLine(std::size_t line) const noexcept
+{
+    if (line == 0 || line > _originalLines.size()) {
+        return 0;
+    }
+    return _originalLines[line - 1];
+}
+
+std::size_t RecoveryBuffer::lineEnd(std::size_t index) const noexcept
+{
+    return index + 1 < _lineStarts.size() ? _lineStarts[index + 1] - 1
+                                          : _text.size();
+}
+
+bool RecoveryBuffer::blankLine(std::size_t index) const noexcept
+{
+    return std::all_of(_text.begin() + _lineStarts[index],
+        _text.begin() + lineEnd(index), isBlank);
+}
+
+// Keyword of a statement line, empty for other lines. Symbols listed under
+// NS_ look like keywords but stand alone on their line.
+std::string RecoveryBuffer::keyword(std::size_t index) const
+{
+    const auto end = lineEnd(index);
+    auto begin = _lineStarts[index];
+    while (begin < end && isBlank(_text[begin])) {
+        ++begin;
+    }
+    auto tokenEnd = begin;
+    while (tokenEnd < end && isTokenChar(_text[tokenEnd])) {
+        ++tokenEnd;
+    }
+    auto rest = tokenEnd;
+    while (rest < end && isBlank(_text[rest])) {
+        ++rest;
+    }
+    if (tokenEnd == begin || rest == end) {
+        return {};
+    }
+    auto token = _text.substr(begin, tokenEnd - begin);
+    return isKeyword(token) ? token : std::string{};
+}
+
+std::size_t RecoveryBuffer::statementStart(std::size_t index) const
+{
+    for (auto i = index; !blankLine(i); --i) {
+        if (!keyword(i).empty()) {
+            return i;
+        }
+        if (i == 0) {
+            break;
+        }
+    }
+    return index;
+}
+
+std::string RecoveryBuffer::ruleAt(std::size_t line) const
+{
+    if (line == 0 || line > _lineStarts.size()) {
+        return {};
+    }
+    const auto found = keyword(statementStart(line - 1));
+    return found.empty() ? std::string{} : statementRule(found);
+}
+
+bool RecoveryBuffer::skipStatement(std::size_t line)
+{
+    const auto lines = _lineStarts.size();
+    if (line == 0 || line > lines) {
+        return false;
+    }
+
+    const auto start = statementStart(line - 1);
+    const auto first = keyword(start);
+    auto end = start + 1;
+    if (!first.empty()) {
+        // A failed message takes its signals along
+        for (; end < lines && !blankLine(end); ++end) {
+            const auto next = keyword(end);
+            if (!next.empty() && !(first == "BO_" && next == "SG_")) {
+                break;
+            }
+        }
+    }
+
+    const auto from = _lineStarts[start];
+    const auto to = end < lines ? _lineStarts[end] : _text.size();
+    if (from == to) {
+        return false;
+    }
+    _text.erase(from, to - from);
+    _originalLines.erase(_originalLines.begin() + start,
+        _originalLines.begin() + end);
+
+    // Without a trailing newline the last line is emptied, not removed
+    indexLines();
+    _originalLines.resize(_lineStarts.size(),
+        _originalLines.empty() ? 1 : _originalLines.back() + 1);
+    return true;
+}
+
+std::size_t RecoveryBuffer::lineAt(std::size_t offset) const noexcept
+{
+    return static_cast<std::size_t>(std::upper_bound(_lineStarts.begin(),
+        _lineStarts.end(), offset)
+        - _lineStarts.begin());
+}
+
+std::size_t RecoveryBuffer::lineOffset(std::size_t line) const noexcept
+{
+    if (line == 0) {
+        return 0;
+    }
+    return line <= _lineStarts.size() ? _lineStarts[line - 1] : _text.size();
+}
+
+std::size_t RecoveryBuffer::statementLine(std::size_t line) const
+{
+    if (line == 0 || line > _lineStarts.size()) {
+        return line;
+    }
+    return statementStart(line - 1) + 1;
+}
+
+std::size_t RecoveryBuffer::resumeLine(std::size_t line) const
+{
+    if (line == 0 || line > _lineStarts.size() || keyword(line - 1) != "SG_") {
+        return line;
+    }
+    for (auto i = line - 1; i > 0 && !blankLine(i - 1); --i) {
+        const auto found = keyword(i - 1);
+        if (found == "BO_") {
+            return i;
+        }
+        if (found != "SG_") {
+            break;
+        }
+    }
+    return line;
+}
@@ -0,0 +1,73 @@
+#ifndef PARSE_RECOVERY_H_G7RM2XQA
+#define PARSE_RECOVERY_H_G7RM2XQA
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace CANdb {
+
+struct Diagnostic {
+    std::size_t line; // 1-based line of the original input
+    std::size_t column; // 1-based, as reported by the parser
+    std::string rule; // grammar rule of the failing statement
+    std::string message;
+};
+
+// Grammar rule of a statement starting with keyword, the keyword if unknown
+std::string statementRule(const std::string& keyword);
+
+/**
+ * Working copy of a DBC file for error recovery. A failed statement is
+ * removed from the top-level keyword (BO_, CM_, BA_, VAL_ ...) it starts
+ * with up to the next keyword line or blank line, so the following parse
+ * resynchronizes there. Removed lines are remembered to map line numbers of
+ * the working copy back to the original input.
+ */
+class RecoveryBuffer {
+public:
+    explicit RecoveryBuffer(const std::string& input);
+
+    const std::string& text() const noexcept { return _text; }
+
+    // Original line of a 1-based line of text(), 0 if out of range
+    std::size_t originalLine(std::size_t line) const noexcept;
+
+    // Rule of the statement containing line, empty if there is none
+    std::string ruleAt(std::size_t line) const;
+
+    // Removes the statement containing line, false if nothing was removed
+    bool skipStatement(std::size_t line);
+
+    // 1-based line of text() containing offset
+    std::size_t lineAt(std::size_t offset) const noexcept;
+
+    // Offset of a 1-based line of text(), text().size() past the last one
+    std::size_t lineOffset(std::size_t line) const noexcept;
+
+    // First line of the statement containing line
+    std::size_t statementLine(std::size_t line) const;
+
+    /**
+     * Line at or before line a parse can resume at: the BO_ line of the
+     * message owning an SG_ line, line itself otherwise.
+     */
+    std::size_t resumeLine(std::size_t line) const;
+
+private:
+    std::size_t lineEnd(std::size_t index) const noexcept;
+    bool blankLine(std::size_t index) const noexcept;
+    std::string keyword(std::size_t index) const;
+
+    // Index of the first line of the statement containing index
+    std::size_t statementStart(std::size_t index) const;
+    void indexLines();
+
+    std::string _text;
+    std::vector<std::size_t> _lineStarts;
+    std::vector<std::size_t> _originalLines;
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: PARSE_RECOVERY_H_G7RM2XQA */
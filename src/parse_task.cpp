@@ -0,0 +1,124 @@
+#include "parse_task.h"
+#include "dbcparser.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace CANdb;
+
+namespace {
+class ProgressObserver : public ParseObserver {
+public:
+    ProgressObserver(const AsyncParseOptions& options,
+        const std::atomic<bool>& cancelled)
+        : _options(options)
+        , _cancelled(cancelled)
+    {
+    }
+
+    bool statement(std::size_t consumed, std::size_t total,
+        ParseSection section) override
+    {
+        if (_cancelled.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        if (!_options.onProgress) {
+            return true;
+        }
+
+        // A recovery pass starts over in a shorter text, progress stays put
+        _progress.bytesTotal = total;
+        _progress.bytesConsumed = std::max(_progress.bytesConsumed, consumed);
+        _progress.sectionsCompleted = std::max(
+            _progress.sectionsCompleted, static_cast<unsigned>(section));
+
+        const auto now = Clock::now();
+        if (now >= _next) {
+            _next = now + _options.progressInterval;
+            _options.onProgress(_progress);
+        }
+        return true;
+    }
+
+    void finish()
+    {
+        if (_options.onProgress) {
+            _progress.bytesConsumed = _progress.bytesTotal;
+            _progress.sectionsCompleted = kParseSectionCount;
+            _options.onProgress(_progress);
+        }
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    const AsyncParseOptions& _options;
+    const std::atomic<bool>& _cancelled;
+    ParseProgress _progress;
+    Clock::time_point _next{};
+};
+} // namespace
+
+ParseTask::ParseTask(std::shared_ptr<std::atomic<bool>> cancelled,
+    std::future<ParseResult> result)
+    : _cancelled(std::move(cancelled))
+    , _result(std::move(result))
+{
+}
+
+ParseTask::~ParseTask()
+{
+    // The future of std::async waits for the thread in its destructor
+    cancel();
+}
+
+ParseTask& ParseTask::operator=(ParseTask&& other) noexcept
+{
+    if (this != &other) {
+        // Releasing the future waits for the thread, stop the parse first
+        cancel();
+        _result = std::move(other._result);
+        _cancelled = std::move(other._cancelled);
+    }
+    return *this;
+}
+
+void ParseTask::cancel() noexcept
+{
+    if (_cancelled) {
+        _cancelled->store(true, std::memory_order_relaxed);
+    }
+}
+
+bool ParseTask::ready() const
+{
+    return waitFor(std::chrono::seconds(0));
+}
+
+ParseResult ParseTask::get() { return _result.get(); }
+
+ParseTask CANdb::parseAsync(std::string data, AsyncParseOptions options)
+{
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    auto result = std::async(std::launch::async,
+        [cancelled, data = std::move(data), options = std::move(options)]() {
+            ProgressObserver observer{ options, *cancelled };
+            DBCParser parser;
+            parser.setSections(options.sections);
+            parser.enableRecovery(options.recovery);
+            parser.setEncoding(options.encoding);
+            parser.setObserver(&observer);
+
+            ParseResult result;
+            result.success = parser.parse(data);
+            result.cancelled = parser.cancelled();
+            if (!result.cancelled) {
+                observer.finish();
+            }
+            result.db = parser.getDb();
+            result.attributes = parser.attributes();
+            result.diagnostics = parser.diagnostics();
+            return result;
+        });
+    return ParseTask{ std::move(cancelled), std::move(result) };
+}
@@ -0,0 +1,115 @@
+#ifndef PARSE_TASK_H_W2HX9LCT
+#define PARSE_TASK_H_W2HX9LCT
+
+#include "attributes.h"
+#include "cantypes.hpp"
+#include "parse_recovery.h"
+#include "section_skipper.h"
+#include "text_normalizer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace CANdb {
+
+// Top-level parts of a DBC file in the order the grammar expects them
+enum class ParseSection : unsigned {
+    Header, // VERSION, NS_, BS_, BU_
+    ValueTables, // VAL_TABLE_
+    Messages, // BO_ with its SG_
+    Transmitters, // BO_TX_BU_
+    Comments, // CM_
+    AttributeDefinitions, // BA_DEF_
+    AttributeDefaults, // BA_DEF_DEF_
+    Attributes, // BA_
+    ValueDescriptions, // VAL_
+    SignalTypes // SIG_VALTYPE_
+};
+constexpr unsigned kParseSectionCount = 10;
+
+/**
+ * Called by DBCParser after every top-level statement with the end of the
+ * statement in the parsed text, which is the input after text
+ * normalization and section skipping. Returning false cancels the parse.
+ */
+class ParseObserver {
+public:
+    virtual ~ParseObserver() = default;
+    virtual bool statement(
+        std::size_t consumed, std::size_t total, ParseSection section)
+        = 0;
+};
+
+struct ParseProgress {
+    std::size_t bytesConsumed{ 0 };
+    std::size_t bytesTotal{ 0 };
+    // Sections before the current one, kParseSectionCount once done
+    unsigned sectionsCompleted{ 0 };
+};
+
+struct AsyncParseOptions {
+    // Called on the parsing thread
+    std::function<void(const ParseProgress&)> onProgress;
+    // Least time between two onProgress calls, the final one always comes
+    std::chrono::milliseconds progressInterval{ 100 };
+    unsigned sections{ kAllSections };
+    bool recovery{ false };
+    TextEncoding encoding{ TextEncoding::Utf8 };
+};
+
+struct ParseResult {
+    bool success{ false };
+    bool cancelled{ false };
+    CANdb_t db;
+    AttributeStore attributes;
+    std::vector<Diagnostic> diagnostics;
+};
+
+/**
+ * Handle of a parse running on its own thread. cancel() is checked after
+ * every top-level statement, so a parse stops at the latest at the end of
+ * the statement it is in. Destroying a pending task cancels it and waits.
+ */
+class ParseTask {
+public:
+    ParseTask(ParseTask&&) noexcept = default;
+    // Cancels the pending parse of this task and waits for it
+    ParseTask& operator=(ParseTask&& other) noexcept;
+    ~ParseTask();
+
+    void cancel() noexcept;
+
+    // Both are false without a result to get, after get() or on a task
+    // that was moved from
+    bool ready() const;
+    template <typename Rep, typename Period>
+    bool waitFor(const std::chrono::duration<Rep, Period>& timeout) const
+    {
+        return _result.valid()
+            && _result.wait_for(timeout) == std::future_status::ready;
+    }
+
+    // Waits for the result, may be called once
+    ParseResult get();
+
+private:
+    friend ParseTask parseAsync(std::string data, AsyncParseOptions options);
+    ParseTask(std::shared_ptr<std::atomic<bool>> cancelled,
+        std::future<ParseResult> result);
+
+    std::shared_ptr<std::atomic<bool>> _cancelled;
+    std::future<ParseResult> _result;
+};
+
+// Parses data with DBCParser on a new thread
+ParseTask parseAsync(std::string data, AsyncParseOptions options = {});
+
+} // namespace CANdb
+
+#endif /* end of include guard: PARSE_TASK_H_W2HX9LCT */
@@ -14,7 +14,8 @@ template <typename Derived> struct Parser {
         return d->parse(data);
     }
 
-    CANdb_t getDb() const noexcept { return can_db; }
+    // Valid until the next parse, callers that keep it copy it
+    const CANdb_t& getDb() const noexcept { return can_db; }
 
     template <typename T> void fetchData(T&& dataStream) {
     }
@@ -0,0 +1,205 @@
+#include "scheduler.h"
+#include "log.hpp"
+
+#include <algorithm>
+
+using namespace CANdb;
+
+namespace {
+// Empty scans a worker yields on before it goes to sleep
+constexpr int kSpinRounds = 64;
+} // namespace
+
+DecodeScheduler::DecodeScheduler(std::size_t workers, Handler handler,
+    std::size_t lanesPerWorker, std::size_t laneCapacity,
+    std::size_t batchSize)
+    : _handler(std::move(handler))
+    , _batchSize(std::max<std::size_t>(batchSize, 1))
+{
+    workers = std::max<std::size_t>(workers, 1);
+    lanesPerWorker = std::max<std::size_t>(lanesPerWorker, 1);
+
+    for (std::size_t i = 0; i < workers * lanesPerWorker; ++i) {
+        _lanes.emplace_back(new Lane{ laneCapacity });
+    }
+    _stats.reset(new WorkerStats[workers]);
+    _workerCount = workers;
+
+    for (std::size_t w = 0; w < workers; ++w) {
+        _workers.emplace_back([this, w]() { run(w); });
+    }
+    cdb_debug("Scheduler started {} workers with {} lanes", workers,
+        _lanes.size());
+}
+
+DecodeScheduler::~DecodeScheduler()
+{
+    finish();
+}
+
+std::size_t DecodeScheduler::laneOf(std::uint32_t id) const noexcept
+{
+    // Fibonacci hashing spreads consecutive ids over the lanes
+    const auto h = static_cast<std::uint32_t>(id * 2654435769u);
+    return static_cast<std::size_t>(h >> 8) % _lanes.size();
+}
+
+bool DecodeScheduler::push(const FrameRecord& frame)
+{
+    auto& lane = *_lanes[laneOf(frame.id)];
+    while (!lane.queue.push(frame)) {
+        _laneFull.fetch_add(1, std::memory_order_relaxed);
+        // The worker that would make room may be asleep
+        wakeIdle(true);
+        std::this_thread::yield();
+    }
+    return !lane.busy.load(std::memory_order_relaxed);
+}
+
+void DecodeScheduler::submit(const FrameRecord& frame)
+{
+    if (push(frame)) {
+        wakeIdle(true);
+    }
+}
+
+void DecodeScheduler::submit(const FrameRecord* frames, std::size_t count)
+{
+    bool idle = false;
+    for (std::size_t i = 0; i < count; ++i) {
+        idle = push(frames[i]) || idle;
+    }
+    if (idle) {
+        wakeIdle(true);
+    }
+}
+
+bool DecodeScheduler::claimable() const noexcept
+{
+    return std::any_of(_lanes.begin(), _lanes.end(),
+        [](const std::unique_ptr<Lane>& lane) {
+            return lane->queue.size() != 0
+                && !lane->busy.load(std::memory_order_relaxed);
+        });
+}
+
+void DecodeScheduler::wakeIdle(bool all)
+{
+    // Pairs with the fence in sleep(): either the worker sees the frames
+    // pushed or the lane released before, or this sees it sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_sleeping.load(std::memory_order_relaxed) != 0) {
+        std::lock_guard<std::mutex> lock{ _idleMutex };
+        if (all) {
+            _idle.notify_all();
+        } else {
+            _idle.notify_one();
+        }
+    }
+}
+
+void DecodeScheduler::sleep()
+{
+    std::unique_lock<std::mutex> lock{ _idleMutex };
+    _sleeping.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    _idle.wait(lock, [this]() {
+        return _finishing.load(std::memory_order_acquire) || claimable();
+    });
+    _sleeping.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void DecodeScheduler::finish()
+{
+    _finishing.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock{ _idleMutex };
+        _idle.notify_all();
+    }
+    for (auto& worker : _workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+SchedulerStats DecodeScheduler::stats() const
+{
+    SchedulerStats s;
+    for (std::size_t w = 0; w < _workerCount; ++w) {
+        s.framesPerWorker.push_back(
+            _stats[w].frames.load(std::memory_order_relaxed));
+        s.stolenBatches += _stats[w].stolen.load(std::memory_order_relaxed);
+    }
+    s.laneFull = _laneFull.load(std::memory_order_relaxed);
+    return s;
+}
+
+std::size_t DecodeScheduler::drain(
+    std::size_t index, std::vector<FrameRecord>& batch)
+{
+    auto& lane = *_lanes[index];
+    if (lane.queue.size() == 0
+        || lane.busy.exchange(true, std::memory_order_acquire)) {
+        return 0;
+    }
+
+    const auto count = lane.queue.pop(batch.data(), batch.size());
+    if (count != 0) {
+        _handler(index, batch.data(), count);
+    }
+    lane.busy.store(false, std::memory_order_release);
+
+    // This worker scans the lane again, a sleeping one may share the work
+    if (lane.queue.size() != 0) {
+        wakeIdle(false);
+    }
+    return count;
+}
+
+void DecodeScheduler::run(std::size_t worker)
+{
+    std::vector<FrameRecord> batch(_batchSize);
+    auto& stats = _stats[worker];
+    const auto lanes = _lanes.size();
+    auto victim = worker;
+    int idle = 0;
+
+    while (true) {
+        // Read before scanning, frames submitted ahead of finish() are
+        // therefore seen by the scan below
+        const auto finishing = _finishing.load(std::memory_order_acquire);
+
+        std::size_t handled = 0;
+        for (auto lane = worker; lane < lanes; lane += _workerCount) {
+            handled += drain(lane, batch);
+        }
+
+        if (handled == 0) {
+            // Home lanes are idle, take one batch from somebody else's lane
+            for (std::size_t i = 0; i < lanes && handled == 0; ++i) {
+                victim = (victim + 1) % lanes;
+                if (victim % _workerCount != worker) {
+                    handled = drain(victim, batch);
+                }
+            }
+            if (handled != 0) {
+                stats.stolen.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        if (handled != 0) {
+            stats.frames.fetch_add(handled, std::memory_order_relaxed);
+            idle = 0;
+        } else if (finishing) {
+            break;
+        } else if (++idle < kSpinRounds) {
+            std::this_thread::yield();
+        } else {
+            // A worker woken for a lane somebody else claimed first goes
+            // back to sleep after one scan
+            sleep();
+            idle = kSpinRounds - 1;
+        }
+    }
+}
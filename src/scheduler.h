@@ -0,0 +1,126 @@
+#ifndef SCHEDULER_H_P8DJW3LC
+#define SCHEDULER_H_P8DJW3LC
+
+#include "decoder.h"
+#include "frame.hpp"
+#include "spsc_ring.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CANdb {
+
+struct SchedulerStats {
+    std::vector<std::uint64_t> framesPerWorker;
+    std::uint64_t stolenBatches{ 0 };
+    std::uint64_t laneFull{ 0 };
+};
+
+/**
+ * Multi-core decode scheduler. Frames are sharded by message id into lanes,
+ * every lane is a FIFO that is drained by at most one worker at a time, so
+ * frames of one id are handled in order and per-lane state (decoders,
+ * counters) needs no locks: claiming a lane synchronizes with the previous
+ * holder.
+ *
+ * Each worker owns lanesPerWorker home lanes. A worker with empty home
+ * lanes takes one batch from another worker's lane per attempt, which
+ * rebalances the load when a few ids dominate the traffic. A worker that
+ * finds nothing for a while sleeps until a lane no worker holds has frames
+ * or finish() is called, so lanes held by busy workers keep it asleep.
+ *
+ * submit() must be called from a single producer thread.
+ */
+class DecodeScheduler {
+public:
+    using Handler = std::function<void(
+        std::size_t lane, const FrameRecord* frames, std::size_t count)>;
+
+    DecodeScheduler(std::size_t workers, Handler handler,
+        std::size_t lanesPerWorker = 8, std::size_t laneCapacity = 1024,
+        std::size_t batchSize = 32);
+    ~DecodeScheduler();
+
+    DecodeScheduler(const DecodeScheduler&) = delete;
+    DecodeScheduler& operator=(const DecodeScheduler&) = delete;
+
+    std::size_t workers() const noexcept { return _workerCount; }
+    std::size_t lanes() const noexcept { return _lanes.size(); }
+    std::size_t laneOf(std::uint32_t id) const noexcept;
+
+    // Blocks while the lane of the frame is full
+    void submit(const FrameRecord& frame);
+    void submit(const FrameRecord* frames, std::size_t count);
+
+    // Handles every submitted frame and stops the workers
+    void finish();
+
+    SchedulerStats stats() const;
+
+private:
+    struct Lane {
+        explicit Lane(std::size_t capacity)
+            : queue(capacity)
+        {
+        }
+
+        SpscRing<FrameRecord> queue;
+        std::atomic<bool> busy{ false };
+        char padding[64];
+    };
+
+    struct WorkerStats {
+        std::atomic<std::uint64_t> frames{ 0 };
+        std::atomic<std::uint64_t> stolen{ 0 };
+        char padding[64];
+    };
+
+    void run(std::size_t worker);
+    std::size_t drain(std::size_t lane, std::vector<FrameRecord>& batch);
+    // False if a worker holds the lane, it takes the frame when done
+    bool push(const FrameRecord& frame);
+    // Some lane has frames and no worker holding it
+    bool claimable() const noexcept;
+    void wakeIdle(bool all);
+    void sleep();
+
+    Handler _handler;
+    std::size_t _batchSize;
+    std::size_t _workerCount;
+    std::vector<std::unique_ptr<Lane>> _lanes;
+    std::unique_ptr<WorkerStats[]> _stats;
+    std::atomic<std::uint64_t> _laneFull{ 0 };
+    std::atomic<bool> _finishing{ false };
+    std::atomic<std::size_t> _sleeping{ 0 };
+    std::mutex _idleMutex;
+    std::condition_variable _idle;
+    std::vector<std::thread> _workers;
+};
+
+/**
+ * Handler that decodes every lane with its own decoder, decoders.size()
+ * has to match DecodeScheduler::lanes(). f(message, signal, raw) is called
+ * concurrently from several workers.
+ */
+template <typename F>
+DecodeScheduler::Handler makeDecodingHandler(
+    std::vector<Decoder>& decoders, F f)
+{
+    return [&decoders, f](std::size_t lane, const FrameRecord* frames,
+               std::size_t count) {
+        auto& decoder = decoders[lane];
+        for (std::size_t i = 0; i < count; ++i) {
+            decoder.decode(frames[i].id, frames[i].payload,
+                frameLength(frames[i]), f);
+        }
+    };
+}
+
+} // namespace CANdb
+
+#endif /* end of include guard: SCHEDULER_H_P8DJW3LC */
@@ -0,0 +1,129 @@
+#include "section_skipper.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+using namespace CANdb;
+
+namespace {
+bool isBlank(char c) noexcept { return c == ' ' || c == '\t'; }
+
+// Section of a statement starting with keyword at data, false for others
+bool classify(const char* data, std::size_t size, Section& section) noexcept
+{
+    std::size_t n = 0;
+    while (n < size && (std::isupper(static_cast<unsigned char>(data[n]))
+                           || data[n] == '_')) {
+        ++n;
+    }
+    if (n == size || !isBlank(data[n])) {
+        return false;
+    }
+
+    const auto is = [data, n](const char* keyword) {
+        return std::strlen(keyword) == n && std::memcmp(data, keyword, n) == 0;
+    };
+    if (is("CM_")) {
+        section = Section::Comments;
+    } else if (is("BA_DEF_") || is("BA_DEF_DEF_")) {
+        section = Section::AttributeDefinitions;
+    } else if (is("BA_")) {
+        section = Section::Attributes;
+    } else if (is("VAL_")) {
+        section = Section::ValueDescriptions;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Position after the line ending of the statement starting at begin
+std::size_t statementEnd(
+    const std::string& input, std::size_t begin, std::size_t lineEnd)
+{
+    bool quoted = false;
+    for (auto i = begin; i < input.size(); ++i) {
+        if (input[i] == '"') {
+            quoted = !quoted;
+        } else if (input[i] == ';' && !quoted) {
+            const auto eol = input.find('\n', i);
+            return eol == std::string::npos ? input.size() : eol + 1;
+        }
+    }
+    // Unterminated, leave the rest to the parser after this line
+    return lineEnd;
+}
+} // namespace
+
+const char* CANdb::toString(Section section) noexcept
+{
+    switch (section) {
+    case Section::Comments:
+        return "comments";
+    case Section::AttributeDefinitions:
+        return "attribute definitions";
+    case Section::Attributes:
+        return "attributes";
+    case Section::ValueDescriptions:
+        return "value descriptions";
+    }
+    return "unknown";
+}
+
+unsigned DeferredSections::sections() const noexcept
+{
+    unsigned mask = 0;
+    for (const auto& statement : statements) {
+        mask |= sectionBit(statement.section);
+    }
+    return mask;
+}
+
+std::string CANdb::skipSections(const std::string& input, unsigned sections,
+    DeferredSections& deferred)
+{
+    // BA_ needs the definition of its attribute
+    if ((sections & sectionBit(Section::AttributeDefinitions)) == 0) {
+        sections &= ~sectionBit(Section::Attributes);
+    }
+
+    std::string out;
+    out.reserve(input.size());
+
+    std::size_t line = 1;
+    std::size_t pos = 0;
+    while (pos < input.size()) {
+        const auto eol = input.find('\n', pos);
+        const auto lineEnd = eol == std::string::npos ? input.size() : eol + 1;
+
+        auto first = pos;
+        while (first < lineEnd && isBlank(input[first])) {
+            ++first;
+        }
+        Section section;
+        if (!classify(input.data() + first, lineEnd - first, section)
+            || (sections & sectionBit(section)) != 0) {
+            out.append(input, pos, lineEnd - pos);
+            line += eol == std::string::npos ? 0 : 1;
+            pos = lineEnd;
+            continue;
+        }
+
+        const auto end = statementEnd(input, first, lineEnd);
+        deferred.statements.push_back(DeferredStatement{
+            section, deferred.text.size(), end - pos, line });
+        deferred.text.append(input, pos, end - pos);
+        if (deferred.text.back() != '\n') {
+            deferred.text += '\n';
+            ++deferred.statements.back().length;
+        }
+
+        const auto newlines = static_cast<std::size_t>(
+            std::count(input.begin() + pos, input.begin() + end, '\n'));
+        out.append(newlines, '\n');
+        line += newlines;
+        pos = end;
+    }
+    return out;
+}
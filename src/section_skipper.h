@@ -0,0 +1,59 @@
+#ifndef SECTION_SKIPPER_H_J5VC1NWD
+#define SECTION_SKIPPER_H_J5VC1NWD
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace CANdb {
+
+// Optional sections of a DBC file, everything else is always parsed
+enum class Section : std::uint32_t {
+    Comments, // CM_
+    AttributeDefinitions, // BA_DEF_, BA_DEF_DEF_
+    Attributes, // BA_
+    ValueDescriptions // VAL_
+};
+
+const char* toString(Section section) noexcept;
+
+constexpr unsigned sectionBit(Section section) noexcept
+{
+    return 1u << static_cast<std::uint32_t>(section);
+}
+constexpr unsigned kAllSections = 0xF;
+constexpr unsigned kLayoutOnly = 0; // BO_/SG_ and the header only
+
+// Raw bytes of a statement that was not parsed
+struct DeferredStatement {
+    Section section;
+    std::size_t offset; // into DeferredSections::text
+    std::size_t length; // including the trailing newline
+    std::size_t line; // 1-based line in the parsed input
+};
+
+struct DeferredSections {
+    std::string text;
+    std::vector<DeferredStatement> statements;
+
+    bool empty() const noexcept { return statements.empty(); }
+
+    // Mask of the sections with deferred statements
+    unsigned sections() const noexcept;
+};
+
+/**
+ * Line skipper for sections the caller did not ask for. Statements of
+ * sections missing in the mask are moved to deferred and replaced by their
+ * newlines, so the grammar sees empty sections and line numbers of the
+ * remaining text stay valid. Statements end at the first ';' outside a
+ * string, so multi-line comments are skipped as a whole. Attributes are
+ * deferred along with their definitions, whatever the mask says.
+ */
+std::string skipSections(const std::string& input, unsigned sections,
+    DeferredSections& deferred);
+
+} // namespace CANdb
+
+#endif /* end of include guard: SECTION_SKIPPER_H_J5VC1NWD */
@@ -0,0 +1,396 @@
+#include "signal_index.h"
+#include "log.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+
+using namespace CANdb;
+
+namespace {
+constexpr std::uint32_t kIndexMagic = 0x49424443; // "CDBI"
+constexpr std::uint32_t kIndexVersion = 1;
+constexpr std::uint32_t kNoContext = 0xFFFFFFFF;
+
+constexpr std::size_t kHeaderWords = 8;
+constexpr std::size_t kFileWords = 2;
+constexpr std::size_t kNameWords = 4;
+constexpr std::size_t kOccurrenceWords = 4;
+constexpr std::size_t kTrigramWords = 3;
+
+char upper(char c)
+{
+    return static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+}
+
+std::string fold(const std::string& s)
+{
+    std::string r = s;
+    std::transform(r.begin(), r.end(), r.begin(), upper);
+    return r;
+}
+
+std::uint32_t trigramKey(const char* p)
+{
+    return static_cast<std::uint32_t>(static_cast<unsigned char>(p[0])) << 16
+        | static_cast<std::uint32_t>(static_cast<unsigned char>(p[1])) << 8
+        | static_cast<std::uint32_t>(static_cast<unsigned char>(p[2]));
+}
+
+// Trigrams of the literal runs of a folded glob pattern
+std::vector<std::uint32_t> patternTrigrams(const std::string& pattern)
+{
+    std::vector<std::uint32_t> keys;
+    std::size_t start = 0;
+    while (start < pattern.size()) {
+        auto end = pattern.find_first_of("*?", start);
+        if (end == std::string::npos) {
+            end = pattern.size();
+        }
+        for (auto i = start; i + 3 <= end; ++i) {
+            keys.push_back(trigramKey(pattern.data() + i));
+        }
+        start = end + 1;
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+} // namespace
+
+const char* CANdb::toString(IndexKind kind) noexcept
+{
+    switch (kind) {
+    case IndexKind::Message:
+        return "message";
+    case IndexKind::Signal:
+        return "signal";
+    case IndexKind::Ecu:
+        return "ecu";
+    case IndexKind::Unit:
+        return "unit";
+    }
+    return "unknown";
+}
+
+bool CANdb::globMatch(
+    const std::string& pattern, const std::string& text) noexcept
+{
+    std::size_t p = 0, t = 0, star = std::string::npos, mark = 0;
+    while (t < text.size()) {
+        if (p < pattern.size()
+            && (pattern[p] == '?' || upper(pattern[p]) == upper(text[t]))) {
+            ++p;
+            ++t;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            mark = t;
+        } else if (star != std::string::npos) {
+            p = star + 1;
+            t = ++mark;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+void SignalIndexBuilder::add(const std::string& file, const CANdb_t& db)
+{
+    const auto f = static_cast<std::uint32_t>(_files.size());
+    _files.push_back(file);
+
+    for (const auto& msg : db.messages) {
+        _names[msg.first.name].push_back(
+            Occurrence{ f, IndexKind::Message, msg.first.id, "" });
+        for (const auto& sig : msg.second) {
+            _names[sig.signal_name].push_back(Occurrence{
+                f, IndexKind::Signal, msg.first.id, msg.first.name });
+            if (!sig.unit.empty()) {
+                _names[sig.unit].push_back(Occurrence{
+                    f, IndexKind::Unit, msg.first.id, sig.signal_name });
+            }
+        }
+    }
+    for (const auto& ecu : db.ecus) {
+        _names[ecu].push_back(Occurrence{ f, IndexKind::Ecu, 0, "" });
+    }
+}
+
+std::string SignalIndexBuilder::serialize() const
+{
+    // Dictionary sorted case-insensitively, ties broken by the original
+    std::vector<std::pair<std::string, const std::string*>> sorted;
+    for (const auto& n : _names) {
+        sorted.emplace_back(fold(n.first), &n.first);
+    }
+    std::sort(sorted.begin(), sorted.end(),
+        [](const auto& lhs, const auto& rhs) {
+            return lhs.first != rhs.first ? lhs.first < rhs.first
+                                          : *lhs.second < *rhs.second;
+        });
+    std::unordered_map<std::string, std::uint32_t> ids;
+    for (std::size_t i = 0; i < sorted.size(); ++i) {
+        ids[*sorted[i].second] = static_cast<std::uint32_t>(i);
+    }
+
+    std::string blob;
+    const auto addString = [&blob](const std::string& s) {
+        const auto offset = static_cast<std::uint32_t>(blob.size());
+        blob += s;
+        return offset;
+    };
+
+    std::vector<std::uint32_t> files, names, occurrences, trigrams, postings;
+    for (const auto& file : _files) {
+        files.push_back(addString(file));
+        files.push_back(static_cast<std::uint32_t>(file.size()));
+    }
+
+    std::map<std::uint32_t, std::vector<std::uint32_t>> trigramPostings;
+    for (std::size_t i = 0; i < sorted.size(); ++i) {
+        const auto& name = *sorted[i].second;
+        const auto& occs = _names.at(name);
+        names.push_back(addString(name));
+        names.push_back(static_cast<std::uint32_t>(name.size()));
+        names.push_back(static_cast<std::uint32_t>(
+            occurrences.size() / kOccurrenceWords));
+        names.push_back(static_cast<std::uint32_t>(occs.size()));
+
+        for (const auto& occ : occs) {
+            occurrences.push_back(occ.file);
+            occurrences.push_back(static_cast<std::uint32_t>(occ.kind));
+            occurrences.push_back(occ.messageId);
+            occurrences.push_back(
+                occ.context.empty() ? kNoContext : ids.at(occ.context));
+        }
+
+        const auto& folded = sorted[i].first;
+        for (std::size_t c = 0; c + 3 <= folded.size(); ++c) {
+            auto& list = trigramPostings[trigramKey(folded.data() + c)];
+            if (list.empty() || list.back() != i) {
+                list.push_back(static_cast<std::uint32_t>(i));
+            }
+        }
+    }
+
+    for (const auto& t : trigramPostings) {
+        trigrams.push_back(t.first);
+        trigrams.push_back(static_cast<std::uint32_t>(postings.size()));
+        trigrams.push_back(static_cast<std::uint32_t>(t.second.size()));
+        postings.insert(postings.end(), t.second.begin(), t.second.end());
+    }
+
+    std::vector<std::uint32_t> words{ kIndexMagic, kIndexVersion,
+        static_cast<std::uint32_t>(_files.size()),
+        static_cast<std::uint32_t>(sorted.size()),
+        static_cast<std::uint32_t>(occurrences.size() / kOccurrenceWords),
+        static_cast<std::uint32_t>(trigramPostings.size()),
+        static_cast<std::uint32_t>(postings.size()),
+        static_cast<std::uint32_t>(blob.size()) };
+    for (const auto* section : { &files, &names, &occurrences, &trigrams,
+             &postings }) {
+        words.insert(words.end(), section->begin(), section->end());
+    }
+
+    std::string data(reinterpret_cast<const char*>(words.data()),
+        words.size() * sizeof(std::uint32_t));
+    data += blob;
+    data.resize((data.size() + 3) / 4 * 4, '\0');
+    return data;
+}
+
+void SignalIndexBuilder::write(const std::string& path) const
+{
+    const auto data = serialize();
+    std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!file.good()) {
+        throw std::runtime_error("Unable to write index " + path);
+    }
+}
+
+SignalIndex::SignalIndex(const std::string& data)
+{
+    if (data.size() % 4 != 0 || data.size() < kHeaderWords * 4) {
+        throw std::runtime_error("Invalid index size");
+    }
+    _words.resize(data.size() / 4);
+    std::copy(data.begin(), data.end(), reinterpret_cast<char*>(_words.data()));
+
+    std::copy(_words.begin(), _words.begin() + kHeaderWords,
+        reinterpret_cast<std::uint32_t*>(&_header));
+    if (_header.magic != kIndexMagic || _header.version != kIndexVersion) {
+        throw std::runtime_error("Not a CANdb index or unsupported version");
+    }
+
+    _fileTable = kHeaderWords;
+    _nameTable = _fileTable + std::size_t{ _header.files } * kFileWords;
+    _occurrenceTable = _nameTable + std::size_t{ _header.names } * kNameWords;
+    _trigramTable = _occurrenceTable
+        + std::size_t{ _header.occurrences } * kOccurrenceWords;
+    _postings
+        = _trigramTable + std::size_t{ _header.trigrams } * kTrigramWords;
+    _blob = _postings + _header.postings;
+
+    if (_blob * 4 + _header.blobSize > data.size()) {
+        throw std::runtime_error("Truncated index");
+    }
+    validate();
+    cdb_debug("Index loaded: {} files, {} names, {} trigrams", _header.files,
+        _header.names, _header.trigrams);
+}
+
+void SignalIndex::validate() const
+{
+    for (std::size_t i = 0; i < _header.names; ++i) {
+        const auto row = at(_nameTable + i * kNameWords);
+        if (std::size_t{ row[2] } + row[3] > _header.occurrences) {
+            throw std::runtime_error("Corrupted index name table");
+        }
+    }
+    for (std::size_t i = 0; i < _header.occurrences; ++i) {
+        const auto occ = at(_occurrenceTable + i * kOccurrenceWords);
+        if (occ[0] >= _header.files
+            || (occ[3] != kNoContext && occ[3] >= _header.names)) {
+            throw std::runtime_error("Corrupted index occurrence table");
+        }
+    }
+    for (std::size_t i = 0; i < _header.trigrams; ++i) {
+        const auto row = at(_trigramTable + i * kTrigramWords);
+        if (std::size_t{ row[1] } + row[2] > _header.postings) {
+            throw std::runtime_error("Corrupted index trigram table");
+        }
+    }
+    const auto postings = at(_postings);
+    if (std::any_of(postings, postings + _header.postings,
+            [this](std::uint32_t id) { return id >= _header.names; })) {
+        throw std::runtime_error("Corrupted index posting lists");
+    }
+}
+
+SignalIndex SignalIndex::load(const std::string& path)
+{
+    std::ifstream file{ path, std::ios::binary };
+    if (!file.good()) {
+        throw std::runtime_error("Unable to open index " + path);
+    }
+    std::string data{ std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>() };
+    return SignalIndex{ data };
+}
+
+std::string SignalIndex::string(std::uint32_t offset, std::uint32_t size) const
+{
+    if (std::size_t{ offset } + size > _header.blobSize) {
+        throw std::runtime_error("Corrupted index string table");
+    }
+    return std::string(
+        reinterpret_cast<const char*>(at(_blob)) + offset, size);
+}
+
+std::string SignalIndex::name(std::uint32_t id) const
+{
+    const auto row = at(_nameTable + std::size_t{ id } * kNameWords);
+    return string(row[0], row[1]);
+}
+
+std::vector<std::uint32_t> SignalIndex::candidates(
+    const std::string& folded) const
+{
+    std::vector<std::uint32_t> result;
+
+    const auto keys = patternTrigrams(folded);
+    if (!keys.empty()) {
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> lists;
+        for (const auto key : keys) {
+            std::size_t lo = 0, hi = _header.trigrams;
+            while (lo < hi) {
+                const auto mid = (lo + hi) / 2;
+                if (at(_trigramTable + mid * kTrigramWords)[0] < key) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+            const auto row = at(_trigramTable + lo * kTrigramWords);
+            if (lo == _header.trigrams || row[0] != key) {
+                return {};
+            }
+            lists.emplace_back(row[1], row[2]);
+        }
+
+        // Intersect starting with the shortest posting list
+        std::sort(lists.begin(), lists.end(),
+            [](const auto& lhs, const auto& rhs) {
+                return lhs.second < rhs.second;
+            });
+        result.assign(at(_postings + lists[0].first),
+            at(_postings + lists[0].first + lists[0].second));
+        for (std::size_t i = 1; i < lists.size() && !result.empty(); ++i) {
+            const auto begin = at(_postings + lists[i].first);
+            std::vector<std::uint32_t> next;
+            std::set_intersection(result.begin(), result.end(), begin,
+                begin + lists[i].second, std::back_inserter(next));
+            result = std::move(next);
+        }
+        return result;
+    }
+
+    // No trigrams, take the dictionary range sharing the literal prefix
+    const auto prefix = folded.substr(0, folded.find_first_of("*?"));
+    const auto boundary = [this, &prefix](bool after) {
+        std::size_t lo = 0, hi = _header.names;
+        while (lo < hi) {
+            const auto mid = (lo + hi) / 2;
+            const auto cmp = fold(name(static_cast<std::uint32_t>(mid)))
+                                 .compare(0, prefix.size(), prefix);
+            if (cmp < 0 || (after && cmp == 0)) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    };
+    const auto last = boundary(true);
+    for (auto i = boundary(false); i < last; ++i) {
+        result.push_back(static_cast<std::uint32_t>(i));
+    }
+    return result;
+}
+
+std::vector<IndexHit> SignalIndex::query(
+    const std::string& pattern, unsigned kinds) const
+{
+    std::vector<IndexHit> hits;
+    const auto folded = fold(pattern);
+
+    for (const auto id : candidates(folded)) {
+        const auto nm = name(id);
+        if (!globMatch(folded, nm)) {
+            continue;
+        }
+
+        const auto row = at(_nameTable + std::size_t{ id } * kNameWords);
+        for (std::uint32_t i = 0; i < row[3]; ++i) {
+            const auto occ = at(_occurrenceTable
+                + (std::size_t{ row[2] } + i) * kOccurrenceWords);
+            const auto kind = static_cast<IndexKind>(occ[1]);
+            if ((kindBit(kind) & kinds) == 0) {
+                continue;
+            }
+            const auto file
+                = at(_fileTable + std::size_t{ occ[0] } * kFileWords);
+            hits.push_back(IndexHit{ string(file[0], file[1]), kind, nm,
+                occ[2], occ[3] == kNoContext ? "" : name(occ[3]) });
+        }
+    }
+    return hits;
+}
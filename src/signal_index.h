@@ -0,0 +1,113 @@
+#ifndef SIGNAL_INDEX_H_K2WN7BUE
+#define SIGNAL_INDEX_H_K2WN7BUE
+
+#include "cantypes.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CANdb {
+
+enum class IndexKind : std::uint32_t { Message, Signal, Ecu, Unit };
+
+const char* toString(IndexKind kind) noexcept;
+
+// Bit mask of IndexKind values accepted by SignalIndex::query()
+constexpr unsigned kindBit(IndexKind kind) noexcept
+{
+    return 1u << static_cast<std::uint32_t>(kind);
+}
+constexpr unsigned kAllKinds = 0xF;
+
+struct IndexHit {
+    std::string file;
+    IndexKind kind;
+    std::string name;
+    std::uint32_t messageId; // not set for ECUs
+    std::string context; // message of a signal, signal of a unit
+};
+
+// Case insensitive glob match supporting '*' and '?'
+bool globMatch(const std::string& pattern, const std::string& text) noexcept;
+
+/**
+ * Collects messages, signals, ECUs and units of many databases and
+ * serializes them into the compact SignalIndex format.
+ */
+class SignalIndexBuilder {
+public:
+    void add(const std::string& file, const CANdb_t& db);
+    std::string serialize() const;
+    void write(const std::string& path) const;
+
+private:
+    struct Occurrence {
+        std::uint32_t file;
+        IndexKind kind;
+        std::uint32_t messageId;
+        std::string context;
+    };
+
+    std::vector<std::string> _files;
+    std::unordered_map<std::string, std::vector<Occurrence>> _names;
+};
+
+/**
+ * Read-only view of a serialized index. The format is an array of 32-bit
+ * words in host byte order: a header, the file table, the name dictionary
+ * sorted case-insensitively, the occurrences of every name, a sorted
+ * trigram table with posting lists of name ids and the string blob.
+ *
+ * Queries extract the trigrams of the literal parts of a glob pattern and
+ * intersect their posting lists, patterns without trigrams use a prefix
+ * range of the sorted dictionary. Candidates are verified with globMatch.
+ */
+class SignalIndex {
+public:
+    explicit SignalIndex(const std::string& data);
+    static SignalIndex load(const std::string& path);
+
+    std::size_t files() const noexcept { return _header.files; }
+    std::size_t names() const noexcept { return _header.names; }
+
+    std::vector<IndexHit> query(
+        const std::string& pattern, unsigned kinds = kAllKinds) const;
+
+private:
+    struct Header {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t files;
+        std::uint32_t names;
+        std::uint32_t occurrences;
+        std::uint32_t trigrams;
+        std::uint32_t postings;
+        std::uint32_t blobSize;
+    };
+
+    // Throws if a table refers past the end of the table it points into
+    void validate() const;
+    std::string name(std::uint32_t id) const;
+    std::string string(std::uint32_t offset, std::uint32_t size) const;
+    std::vector<std::uint32_t> candidates(const std::string& folded) const;
+
+    const std::uint32_t* at(std::size_t offset) const noexcept
+    {
+        return _words.data() + offset;
+    }
+
+    // Sections are kept as word offsets, so copies of the index stay valid
+    std::vector<std::uint32_t> _words;
+    Header _header;
+    std::size_t _fileTable;
+    std::size_t _nameTable;
+    std::size_t _occurrenceTable;
+    std::size_t _trigramTable;
+    std::size_t _postings;
+    std::size_t _blob;
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: SIGNAL_INDEX_H_K2WN7BUE */
@@ -0,0 +1,307 @@
+#include "signal_stats.h"
+#include "decoder.h"
+#include "log.hpp"
+
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace CANdb;
+
+namespace {
+void minMaxSum(const double* values, std::size_t count, double& min,
+    double& max, double& sum)
+{
+    std::size_t i = 0;
+    min = values[0];
+    max = values[0];
+    sum = 0;
+
+#if defined(__SSE2__)
+    if (count >= 2) {
+        auto vmin = _mm_loadu_pd(values);
+        auto vmax = vmin;
+        auto vsum = _mm_setzero_pd();
+        for (; i + 2 <= count; i += 2) {
+            const auto x = _mm_loadu_pd(values + i);
+            vmin = _mm_min_pd(vmin, x);
+            vmax = _mm_max_pd(vmax, x);
+            vsum = _mm_add_pd(vsum, x);
+        }
+        double mins[2], maxs[2], sums[2];
+        _mm_storeu_pd(mins, vmin);
+        _mm_storeu_pd(maxs, vmax);
+        _mm_storeu_pd(sums, vsum);
+        min = std::min(mins[0], mins[1]);
+        max = std::max(maxs[0], maxs[1]);
+        sum = sums[0] + sums[1];
+    }
+#endif
+
+    for (; i < count; ++i) {
+        min = std::min(min, values[i]);
+        max = std::max(max, values[i]);
+        sum += values[i];
+    }
+}
+
+// Sum of squared deviations from the batch mean
+double deviation(const double* values, std::size_t count, double mean)
+{
+    std::size_t i = 0;
+    double m2 = 0;
+
+#if defined(__SSE2__)
+    const auto vmean = _mm_set1_pd(mean);
+    auto vm2 = _mm_setzero_pd();
+    for (; i + 2 <= count; i += 2) {
+        const auto d = _mm_sub_pd(_mm_loadu_pd(values + i), vmean);
+        vm2 = _mm_add_pd(vm2, _mm_mul_pd(d, d));
+    }
+    double m2s[2];
+    _mm_storeu_pd(m2s, vm2);
+    m2 = m2s[0] + m2s[1];
+#endif
+
+    for (; i < count; ++i) {
+        const auto d = values[i] - mean;
+        m2 += d * d;
+    }
+    return m2;
+}
+
+void histogram(SignalSummary& s, const double* values, std::size_t count)
+{
+    if (s.bins.empty()) {
+        return;
+    }
+    const auto bins = static_cast<double>(s.bins.size());
+    const auto scale = bins / (s.histogramHigh - s.histogramLow);
+
+    // Positions are computed in blocks, then counted
+    constexpr std::size_t kBlock = 64;
+    double pos[kBlock];
+    for (std::size_t start = 0; start < count; start += kBlock) {
+        const auto n = std::min(kBlock, count - start);
+        const auto block = values + start;
+        std::size_t i = 0;
+
+#if defined(__SSE2__)
+        const auto vlow = _mm_set1_pd(s.histogramLow);
+        const auto vscale = _mm_set1_pd(scale);
+        for (; i + 2 <= n; i += 2) {
+            const auto x = _mm_sub_pd(_mm_loadu_pd(block + i), vlow);
+            _mm_storeu_pd(pos + i, _mm_mul_pd(x, vscale));
+        }
+#endif
+        for (; i < n; ++i) {
+            pos[i] = (block[i] - s.histogramLow) * scale;
+        }
+
+        for (i = 0; i < n; ++i) {
+            if (pos[i] < 0) {
+                ++s.underflow;
+            } else if (pos[i] < bins) {
+                ++s.bins[static_cast<std::size_t>(pos[i])];
+            } else if (block[i] <= s.histogramHigh) {
+                // the upper edge belongs to the last bin
+                ++s.bins.back();
+            } else {
+                ++s.overflow;
+            }
+        }
+    }
+}
+
+void mergeMoments(SignalSummary& s, std::uint64_t count, double min,
+    double max, double mean, double m2)
+{
+    if (count == 0) {
+        return;
+    }
+    if (s.count == 0) {
+        s.count = count;
+        s.min = min;
+        s.max = max;
+        s.mean = mean;
+        s.m2 = m2;
+        return;
+    }
+
+    const auto total = s.count + count;
+    const auto delta = mean - s.mean;
+    s.mean += delta * count / total;
+    s.m2 += m2
+        + delta * delta * (static_cast<double>(s.count) * count / total);
+    s.min = std::min(s.min, min);
+    s.max = std::max(s.max, max);
+    s.count = total;
+}
+
+// Physical range of a signal, used when the DBC leaves [min|max] empty
+void rawRange(const CANsignal& sig, double& low, double& high)
+{
+    const auto size = std::min<unsigned>(std::max<unsigned>(sig.signalSize, 1), 63);
+    double rawLow = 0;
+    double rawHigh = std::ldexp(1.0, size) - 1;
+    if (sig.value_type == "-") {
+        rawLow = -std::ldexp(1.0, size - 1);
+        rawHigh = std::ldexp(1.0, size - 1) - 1;
+    }
+    low = rawLow * sig.factor + sig.offset;
+    high = rawHigh * sig.factor + sig.offset;
+    if (low > high) {
+        std::swap(low, high);
+    }
+}
+} // namespace
+
+void SignalSummary::merge(const SignalSummary& other)
+{
+    mergeMoments(*this, other.count, other.min, other.max, other.mean,
+        other.m2);
+
+    if (bins.empty()) {
+        histogramLow = other.histogramLow;
+        histogramHigh = other.histogramHigh;
+        bins = other.bins;
+    } else if (bins.size() == other.bins.size()) {
+        for (std::size_t i = 0; i < bins.size(); ++i) {
+            bins[i] += other.bins[i];
+        }
+    } else {
+        cdb_warn("Merging histograms with {} and {} bins", bins.size(),
+            other.bins.size());
+    }
+    underflow += other.underflow;
+    overflow += other.overflow;
+}
+
+void CANdb::accumulate(
+    SignalSummary& summary, const double* values, std::size_t count)
+{
+    if (count == 0) {
+        return;
+    }
+
+    double min, max, sum;
+    minMaxSum(values, count, min, max, sum);
+    const auto mean = sum / count;
+    mergeMoments(summary, count, min, max, mean, deviation(values, count, mean));
+    histogram(summary, values, count);
+}
+
+SignalStatistics::SignalStatistics(
+    const CANdb_t& db, std::size_t bins, std::size_t batchSize)
+    : _batchSize(std::max<std::size_t>(batchSize, 1))
+{
+    std::size_t signalCount = 0;
+    for (const auto& msg : db.messages) {
+        signalCount += msg.second.size();
+    }
+
+    for (const auto& msg : db.messages) {
+        _ids.push_back(msg.first.id);
+        _firstSignal.push_back(_signals.size());
+        const auto mux = multiplexSwitch(msg.second);
+        _switches.push_back(
+            mux != msg.second.size() ? _signals.size() + mux : signalCount);
+
+        for (const auto& sig : msg.second) {
+            SignalSummary summary;
+            if (sig.min < sig.max) {
+                summary.histogramLow = sig.min;
+                summary.histogramHigh = sig.max;
+            } else {
+                rawRange(sig, summary.histogramLow, summary.histogramHigh);
+            }
+            if (summary.histogramHigh <= summary.histogramLow) {
+                summary.histogramHigh = summary.histogramLow + 1;
+            }
+            summary.bins.assign(bins, 0);
+
+            _messages.push_back(&msg.first);
+            _signals.push_back(&sig);
+            _groups.push_back(multiplexGroup(sig));
+            _summaries.push_back(std::move(summary));
+            _staged.emplace_back();
+            _staged.back().reserve(_batchSize);
+        }
+    }
+    _firstSignal.push_back(_signals.size());
+}
+
+void SignalStatistics::add(
+    std::uint32_t id, const std::uint8_t* data, std::size_t len)
+{
+    const auto it = std::lower_bound(_ids.begin(), _ids.end(), id);
+    if (it == _ids.end() || *it != id) {
+        return;
+    }
+    const auto msg = static_cast<std::size_t>(it - _ids.begin());
+    const auto mux = _switches[msg];
+    const auto group = mux != _signals.size()
+        ? static_cast<std::int64_t>(extractRaw(*_signals[mux], data, len))
+        : kNotMultiplexed;
+
+    for (auto i = _firstSignal[msg]; i < _firstSignal[msg + 1]; ++i) {
+        if (mux != _signals.size() && _groups[i] != kNotMultiplexed
+            && _groups[i] != group) {
+            continue;
+        }
+        const auto& sig = *_signals[i];
+        auto& staged = _staged[i];
+        staged.push_back(toPhysical(sig, extractRaw(sig, data, len)));
+        if (staged.size() >= _batchSize) {
+            accumulate(_summaries[i], staged.data(), staged.size());
+            staged.clear();
+        }
+    }
+}
+
+void SignalStatistics::add(const FrameRecord* frames, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        add(frames[i].id, frames[i].payload, frameLength(frames[i]));
+    }
+}
+
+void SignalStatistics::flush()
+{
+    for (std::size_t i = 0; i < _staged.size(); ++i) {
+        accumulate(_summaries[i], _staged[i].data(), _staged[i].size());
+        _staged[i].clear();
+    }
+}
+
+void SignalStatistics::merge(const SignalStatistics& other)
+{
+    if (other._signals.size() != _signals.size()) {
+        throw std::runtime_error(
+            "Merging statistics of different databases");
+    }
+    for (std::size_t i = 0; i < _summaries.size(); ++i) {
+        _summaries[i].merge(other._summaries[i]);
+        accumulate(
+            _summaries[i], other._staged[i].data(), other._staged[i].size());
+    }
+}
+
+const SignalSummary* SignalStatistics::find(
+    std::uint32_t id, const std::string& signalName) const
+{
+    const auto it = std::lower_bound(_ids.begin(), _ids.end(), id);
+    if (it == _ids.end() || *it != id) {
+        return nullptr;
+    }
+    const auto msg = static_cast<std::size_t>(it - _ids.begin());
+
+    for (auto i = _firstSignal[msg]; i < _firstSignal[msg + 1]; ++i) {
+        if (_signals[i]->signal_name == signalName) {
+            return &_summaries[i];
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,98 @@
+#ifndef SIGNAL_STATS_H_F6YA2XQN
+#define SIGNAL_STATS_H_F6YA2XQN
+
+#include "cantypes.hpp"
+#include "frame.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace CANdb {
+
+/**
+ * Mergeable summary of one signal: count, min, max, mean and the sum of
+ * squared deviations (m2) combined with Chan's parallel update, plus a
+ * fixed-range histogram with underflow and overflow counters.
+ */
+struct SignalSummary {
+    std::uint64_t count{ 0 };
+    double min{ 0 };
+    double max{ 0 };
+    double mean{ 0 };
+    double m2{ 0 };
+
+    double histogramLow{ 0 };
+    double histogramHigh{ 0 };
+    std::vector<std::uint64_t> bins;
+    std::uint64_t underflow{ 0 };
+    std::uint64_t overflow{ 0 };
+
+    double variance() const noexcept { return count > 0 ? m2 / count : 0; }
+
+    // Lower edge of a histogram bin
+    double binEdge(std::size_t bin) const noexcept
+    {
+        return histogramLow
+            + (histogramHigh - histogramLow) * bin / bins.size();
+    }
+
+    // Histograms have to share the same edges
+    void merge(const SignalSummary& other);
+};
+
+/**
+ * Adds a batch of values to a summary. min/max/sum/deviation and the
+ * histogram bin computation run on SSE2 when available.
+ */
+void accumulate(SignalSummary& summary, const double* values, std::size_t count);
+
+/**
+ * Streaming aggregation of every signal of a database. Decoded physical
+ * values are staged per signal and folded into the summaries in batches.
+ * Histogram edges come from the signal's min/max, or from the range of its
+ * raw value when the database leaves min/max empty. Multiplexed signals
+ * only take values from frames whose switch selects their group.
+ *
+ * Instances used by different threads can be combined with merge().
+ */
+class SignalStatistics {
+public:
+    explicit SignalStatistics(
+        const CANdb_t& db, std::size_t bins = 32, std::size_t batchSize = 256);
+
+    void add(std::uint32_t id, const std::uint8_t* data, std::size_t len);
+    void add(const FrameRecord* frames, std::size_t count);
+
+    // Folds all staged values into the summaries
+    void flush();
+
+    // Both instances have to be built from the same database
+    void merge(const SignalStatistics& other);
+
+    std::size_t size() const noexcept { return _signals.size(); }
+    const CANmessage& message(std::size_t i) const { return *_messages[i]; }
+    const CANsignal& signal(std::size_t i) const { return *_signals[i]; }
+
+    // Summary without the values that are still staged, call flush() first
+    const SignalSummary& summary(std::size_t i) const { return _summaries[i]; }
+    const SignalSummary* find(
+        std::uint32_t id, const std::string& signalName) const;
+
+private:
+    std::size_t _batchSize;
+    std::vector<std::uint32_t> _ids;
+    // signals of _ids[i] are [_firstSignal[i], _firstSignal[i + 1])
+    std::vector<std::size_t> _firstSignal;
+    // Multiplexer switch of _ids[i], _signals.size() for none
+    std::vector<std::size_t> _switches;
+    std::vector<std::int64_t> _groups;
+    std::vector<const CANmessage*> _messages;
+    std::vector<const CANsignal*> _signals;
+    std::vector<SignalSummary> _summaries;
+    std::vector<std::vector<double>> _staged;
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: SIGNAL_STATS_H_F6YA2XQN */
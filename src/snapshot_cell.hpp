@@ -0,0 +1,182 @@
+#ifndef SNAPSHOT_CELL_HPP_H6TC4WNE
+#define SNAPSHOT_CELL_HPP_H6TC4WNE
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace CANdb {
+
+/**
+ * Immutable snapshot published by one writer and read lock-free by many
+ * readers, RCU style. publish() swaps an atomic pointer, the previous
+ * snapshot is retired with the current epoch and freed once no reader
+ * entered before the swap is still inside.
+ *
+ * Every reader thread claims a Reader, which owns one epoch slot. A reader
+ * inside lock() announces the epoch it entered, so the writer only has to
+ * scan the slots. Slots are padded to separate cache lines.
+ *
+ * publish() and reclaim() may only be called from one thread at a time.
+ * A Reader holds at most one ReadLock at a time.
+ */
+template <typename T> class SnapshotCell {
+    struct Slot {
+        std::atomic<std::uint64_t> epoch{ 0 }; // 0 outside of a lock
+        std::atomic<bool> claimed{ false };
+        char padding[64 - sizeof(std::atomic<std::uint64_t>)
+            - sizeof(std::atomic<bool>)];
+    };
+
+public:
+    class ReadLock {
+    public:
+        ReadLock(ReadLock&& other) noexcept
+            : _slot(std::exchange(other._slot, nullptr))
+            , _value(other._value)
+        {
+        }
+        ReadLock(const ReadLock&) = delete;
+        ReadLock& operator=(const ReadLock&) = delete;
+        ~ReadLock()
+        {
+            if (_slot != nullptr) {
+                _slot->epoch.store(0, std::memory_order_release);
+            }
+        }
+
+        // nullptr before the first publish()
+        const T* get() const noexcept { return _value; }
+        const T& operator*() const noexcept { return *_value; }
+        const T* operator->() const noexcept { return _value; }
+        explicit operator bool() const noexcept { return _value != nullptr; }
+
+    private:
+        friend class SnapshotCell;
+        ReadLock(Slot* slot, const T* value)
+            : _slot(slot)
+            , _value(value)
+        {
+        }
+
+        Slot* _slot;
+        const T* _value;
+    };
+
+    class Reader {
+    public:
+        Reader(Reader&& other) noexcept
+            : _cell(other._cell)
+            , _slot(std::exchange(other._slot, nullptr))
+        {
+        }
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+        ~Reader()
+        {
+            if (_slot != nullptr) {
+                _slot->claimed.store(false, std::memory_order_release);
+            }
+        }
+
+        // Current snapshot, kept alive until the lock is destroyed
+        ReadLock lock() const noexcept
+        {
+            // seq_cst orders the announcement before the pointer load, so a
+            // writer that misses it has already swapped the pointer
+            _slot->epoch.store(_cell->_epoch.load());
+            return ReadLock{ _slot, _cell->_current.load() };
+        }
+
+    private:
+        friend class SnapshotCell;
+        Reader(const SnapshotCell* cell, Slot* slot)
+            : _cell(cell)
+            , _slot(slot)
+        {
+        }
+
+        const SnapshotCell* _cell;
+        Slot* _slot;
+    };
+
+    explicit SnapshotCell(std::size_t maxReaders = 64)
+        : _slots(new Slot[maxReaders])
+        , _slotCount(maxReaders)
+    {
+    }
+    SnapshotCell(const SnapshotCell&) = delete;
+    SnapshotCell& operator=(const SnapshotCell&) = delete;
+
+    // All readers must be gone
+    ~SnapshotCell()
+    {
+        delete _current.load();
+        for (const auto& retired : _retired) {
+            delete retired.second;
+        }
+    }
+
+    // Claims a reader slot, throws std::runtime_error if all are taken
+    Reader reader()
+    {
+        for (std::size_t i = 0; i < _slotCount; ++i) {
+            bool expected = false;
+            if (_slots[i].claimed.compare_exchange_strong(expected, true)) {
+                return Reader{ this, &_slots[i] };
+            }
+        }
+        throw std::runtime_error("No free snapshot reader slot");
+    }
+
+    void publish(std::unique_ptr<const T> value)
+    {
+        const auto previous = _current.exchange(value.release());
+        if (previous != nullptr) {
+            _retired.emplace_back(_epoch.fetch_add(1), previous);
+        }
+        reclaim();
+    }
+
+    // Frees retired snapshots no reader can see, returns how many remain
+    std::size_t reclaim()
+    {
+        auto oldest = ~std::uint64_t{ 0 };
+        for (std::size_t i = 0; i < _slotCount; ++i) {
+            const auto epoch = _slots[i].epoch.load();
+            if (epoch != 0 && epoch < oldest) {
+                oldest = epoch;
+            }
+        }
+
+        // A snapshot retired in epoch e is visible to readers entered in e
+        // or before
+        std::size_t kept = 0;
+        for (auto& retired : _retired) {
+            if (retired.first < oldest) {
+                delete retired.second;
+            } else {
+                _retired[kept++] = retired;
+            }
+        }
+        _retired.resize(kept);
+        return kept;
+    }
+
+    std::size_t pending() const noexcept { return _retired.size(); }
+
+private:
+    std::unique_ptr<Slot[]> _slots;
+    std::size_t _slotCount;
+    std::atomic<std::uint64_t> _epoch{ 1 };
+    std::atomic<const T*> _current{ nullptr };
+    std::vector<std::pair<std::uint64_t, const T*>> _retired;
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: SNAPSHOT_CELL_HPP_H6TC4WNE */
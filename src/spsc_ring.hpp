@@ -0,0 +1,109 @@
+#ifndef SPSC_RING_HPP_B5NW0QJE
+#define SPSC_RING_HPP_B5NW0QJE
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace CANdb {
+
+/**
+ * Lock-free single-producer/single-consumer ring of trivially copyable
+ * records. push() may only be called from one thread and pop() from one
+ * (other) thread. Capacity is rounded up to a power of two.
+ *
+ * Head and tail live on separate cache lines and each side keeps a cached
+ * copy of the other side's index, so the shared atomics are only touched
+ * when the cached view says the ring is full (or empty).
+ */
+template <typename T> class SpscRing {
+    static_assert(std::is_trivially_copyable<T>::value,
+        "SpscRing stores trivially copyable records only");
+
+public:
+    explicit SpscRing(std::size_t capacity)
+    {
+        std::size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        _buffer.resize(size);
+        _mask = size - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    std::size_t capacity() const noexcept { return _buffer.size(); }
+
+    // Approximate number of queued records
+    std::size_t size() const noexcept
+    {
+        return _tail.load(std::memory_order_acquire)
+            - _head.load(std::memory_order_acquire);
+    }
+
+    bool push(const T& record) noexcept { return push(&record, 1) == 1; }
+
+    // Enqueues up to count records, returns the number actually enqueued
+    std::size_t push(const T* records, std::size_t count) noexcept
+    {
+        const auto tail = _tail.load(std::memory_order_relaxed);
+        auto free = capacity() - (tail - _cachedHead);
+        if (free < count) {
+            _cachedHead = _head.load(std::memory_order_acquire);
+            free = capacity() - (tail - _cachedHead);
+        }
+        count = std::min(count, free);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            _buffer[(tail + i) & _mask] = records[i];
+        }
+        _tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    bool pop(T& record) noexcept { return pop(&record, 1) == 1; }
+
+    // Dequeues up to max records, returns the number actually dequeued
+    std::size_t pop(T* records, std::size_t max) noexcept
+    {
+        const auto head = _head.load(std::memory_order_relaxed);
+        auto available = _cachedTail - head;
+        if (available < max) {
+            _cachedTail = _tail.load(std::memory_order_acquire);
+            available = _cachedTail - head;
+        }
+        const auto count = std::min(max, available);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            records[i] = _buffer[(head + i) & _mask];
+        }
+        _head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+private:
+    std::vector<T> _buffer;
+    std::size_t _mask;
+
+    // Padding instead of alignas, so rings can live in heap allocated
+    // objects without relying on over-aligned new
+    char _padding0[64];
+
+    // consumer side
+    std::atomic<std::size_t> _head{ 0 };
+    std::size_t _cachedTail{ 0 };
+    char _padding1[64];
+
+    // producer side
+    std::atomic<std::size_t> _tail{ 0 };
+    std::size_t _cachedHead{ 0 };
+    char _padding2[64];
+};
+
+} // namespace CANdb
+
+#endif /* end of include guard: SPSC_RING_HPP_B5NW0QJE */
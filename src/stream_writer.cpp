@@ -0,0 +1,615 @@
+#include "stream_writer.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using namespace CANdb;
+
+namespace {
+const char kDigitPairs[] = "00010203040506070809101112131415161718192021222324"
+                           "25262728293031323334353637383940414243444546474849"
+                           "50515253545556575859606162636465666768697071727374"
+                           "75767778798081828384858687888990919293949596979899";
+const char kHex[] = "0123456789ABCDEF";
+const char kHexLower[] = "0123456789abcdef";
+
+// rapidjson::PrettyWriter layout: one value per line, commas at line ends
+class JsonPrinter {
+public:
+    explicit JsonPrinter(OutputBuffer& out)
+        : _out(out)
+    {
+        _levels.reserve(8);
+    }
+
+    void beginObject()
+    {
+        prefix();
+        _out.put('{');
+        _levels.push_back(Level{ false, 0 });
+    }
+    void endObject() { end('}'); }
+
+    void beginArray()
+    {
+        prefix();
+        _out.put('[');
+        _levels.push_back(Level{ true, 0 });
+    }
+    void endArray() { end(']'); }
+
+    void key(const char* name) { string(name, std::strlen(name)); }
+
+    template <typename S> void field(const char* name, const S& s)
+    {
+        key(name);
+        string(s.data(), s.size());
+    }
+    void field(const char* name, std::uint64_t value)
+    {
+        key(name);
+        number(value);
+    }
+    void field(const char* name, std::int64_t value)
+    {
+        key(name);
+        prefix();
+        _out.appendSigned(value);
+    }
+
+    void number(std::uint64_t value)
+    {
+        prefix();
+        _out.appendUnsigned(value);
+    }
+
+    void string(const char* s, std::size_t size)
+    {
+        prefix();
+        _out.put('"');
+        std::size_t run = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            const auto c = static_cast<unsigned char>(s[i]);
+            if (c >= 0x20 && c != '"' && c != '\\') {
+                continue;
+            }
+            _out.append(s + run, i - run);
+            run = i + 1;
+            _out.put('\\');
+            switch (c) {
+            case '"':
+            case '\\':
+                _out.put(static_cast<char>(c));
+                break;
+            case '\b':
+                _out.put('b');
+                break;
+            case '\f':
+                _out.put('f');
+                break;
+            case '\n':
+                _out.put('n');
+                break;
+            case '\r':
+                _out.put('r');
+                break;
+            case '\t':
+                _out.put('t');
+                break;
+            default:
+                _out.append("u00", 3);
+                _out.put(kHex[c >> 4]);
+                _out.put(kHex[c & 0xF]);
+            }
+        }
+        _out.append(s + run, size - run);
+        _out.put('"');
+    }
+
+private:
+    struct Level {
+        bool inArray;
+        std::size_t values; // keys count as values in objects
+    };
+
+    void indent() { _out.append(_levels.size() * 4, ' '); }
+
+    void prefix()
+    {
+        if (_levels.empty()) {
+            return;
+        }
+        auto& level = _levels.back();
+        if (level.inArray) {
+            if (level.values > 0) {
+                _out.put(',');
+            }
+            _out.put('\n');
+            indent();
+        } else if (level.values % 2 == 1) {
+            _out.append(": ", 2);
+        } else {
+            if (level.values > 0) {
+                _out.put(',');
+            }
+            _out.put('\n');
+            indent();
+        }
+        ++level.values;
+    }
+
+    void end(char bracket)
+    {
+        const auto empty = _levels.back().values == 0;
+        _levels.pop_back();
+        if (!empty) {
+            _out.put('\n');
+            indent();
+        }
+        _out.put(bracket);
+    }
+
+    OutputBuffer& _out;
+    std::vector<Level> _levels;
+};
+
+template <typename V> void jsonStrings(JsonPrinter& json, const V& strings)
+{
+    json.beginArray();
+    for (const auto& s : strings) {
+        json.string(s.data(), s.size());
+    }
+    json.endArray();
+}
+
+void jsonSignal(JsonPrinter& json, const CANsignal& signal)
+{
+    json.beginObject();
+    json.field("signal_name", signal.signal_name);
+    json.field("startBit", std::uint64_t{ signal.startBit });
+    json.field("signalSize", std::uint64_t{ signal.signalSize });
+    json.field("byteOrder", std::uint64_t{ signal.byteOrder });
+    json.field("value_type", signal.value_type);
+    json.field("factor", std::uint64_t{ signal.factor });
+    json.field("offset", std::uint64_t{ signal.offset });
+    json.field("min", std::int64_t{ signal.min });
+    json.field("max", std::int64_t{ signal.max });
+    json.field("unit", signal.unit);
+    json.field("receiver", signal.receiver);
+    json.field("type", static_cast<std::int64_t>(signal.type));
+
+    json.key("values");
+    json.beginObject();
+    json.key("entries");
+    json.beginArray();
+    for (const auto& entry : signal.values.entries) {
+        json.beginObject();
+        json.field("raw", entry.raw);
+        json.field("description", entry.description);
+        json.endObject();
+    }
+    json.endArray();
+    json.field("denseBase", signal.values.denseBase);
+    json.key("dense");
+    json.beginArray();
+    for (const auto slot : signal.values.dense) {
+        json.number(slot);
+    }
+    json.endArray();
+    json.endObject();
+
+    json.field("multiplexer", signal.multiplexer);
+    json.endObject();
+}
+
+// rapidxml print layout of cereal's XML archive: tab indent, unnamed
+// values numbered per parent, empty containers as <name size="dynamic"/>
+class XmlPrinter {
+public:
+    // Prints the document up to the opening tag of the root element
+    explicit XmlPrinter(OutputBuffer& out)
+        : _out(out)
+    {
+        _open.reserve(8);
+        _out.append("<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<cereal>\n");
+        _open.push_back(Open{ "cereal", 0, 0 });
+    }
+
+    // Opens an element holding other elements
+    void element(const char* name = nullptr)
+    {
+        startTag(name);
+        _out.append(">\n", 2);
+        push(name);
+    }
+
+    // Opens a container, empty ones are closed right away
+    bool container(std::size_t size, const char* name = nullptr)
+    {
+        startTag(name);
+        if (size == 0) {
+            _out.append(" size=\"dynamic\"/>\n", 18);
+            return false;
+        }
+        _out.append(" size=\"dynamic\">\n", 17);
+        push(name);
+        return true;
+    }
+
+    void end()
+    {
+        const auto open = _open.back();
+        _open.pop_back();
+        _out.append(_open.size(), '\t');
+        _out.append("</", 2);
+        writeName(open.name, open.index);
+        _out.append(">\n", 2);
+    }
+
+    template <typename S> void text(const S& s, const char* name = nullptr)
+    {
+        // cereal streams the value, so it ends at an embedded NUL
+        const auto nul = std::memchr(s.data(), '\0', s.size());
+        const auto size = nul != nullptr
+            ? static_cast<std::size_t>(static_cast<const char*>(nul) - s.data())
+            : s.size();
+        const auto index = startTag(name);
+        if (size > 0 && (space(s[0]) || space(s[size - 1]))) {
+            _out.append(" xml:space=\"preserve\"", 21);
+        }
+        _out.put('>');
+        escape(s.data(), size);
+        endTag(name, index);
+    }
+
+    void number(std::uint64_t value, const char* name = nullptr)
+    {
+        const auto index = startTag(name);
+        _out.put('>');
+        _out.appendUnsigned(value);
+        endTag(name, index);
+    }
+
+    void number(std::int64_t value, const char* name = nullptr)
+    {
+        const auto index = startTag(name);
+        _out.put('>');
+        _out.appendSigned(value);
+        endTag(name, index);
+    }
+
+private:
+    struct Open {
+        const char* name;
+        std::size_t index; // of unnamed elements
+        std::size_t children; // unnamed ones so far
+    };
+
+    static bool space(char c) noexcept
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    std::size_t startTag(const char* name)
+    {
+        const auto index = name == nullptr ? _open.back().children++ : 0;
+        _out.append(_open.size(), '\t');
+        _out.put('<');
+        writeName(name, index);
+        return index;
+    }
+
+    void endTag(const char* name, std::size_t index)
+    {
+        _out.append("</", 2);
+        writeName(name, index);
+        _out.append(">\n", 2);
+    }
+
+    void push(const char* name)
+    {
+        const auto index = name == nullptr ? _open.back().children - 1 : 0;
+        _open.push_back(Open{ name, index, 0 });
+    }
+
+    void writeName(const char* name, std::size_t index)
+    {
+        if (name != nullptr) {
+            _out.append(name, std::strlen(name));
+        } else {
+            _out.append("value", 5);
+            _out.appendUnsigned(index);
+        }
+    }
+
+    void escape(const char* s, std::size_t size)
+    {
+        std::size_t run = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            const char* entity;
+            switch (s[i]) {
+            case '<':
+                entity = "&lt;";
+                break;
+            case '>':
+                entity = "&gt;";
+                break;
+            case '\'':
+                entity = "&apos;";
+                break;
+            case '"':
+                entity = "&quot;";
+                break;
+            case '&':
+                entity = "&amp;";
+                break;
+            default:
+                continue;
+            }
+            _out.append(s + run, i - run);
+            _out.append(entity, std::strlen(entity));
+            run = i + 1;
+        }
+        _out.append(s + run, size - run);
+    }
+
+    OutputBuffer& _out;
+    std::vector<Open> _open;
+};
+
+template <typename V>
+void xmlStrings(XmlPrinter& xml, const V& strings, const char* name)
+{
+    if (xml.container(strings.size(), name)) {
+        for (const auto& s : strings) {
+            xml.text(s);
+        }
+        xml.end();
+    }
+}
+
+void xmlSignal(XmlPrinter& xml, const CANsignal& signal)
+{
+    xml.element();
+    xml.text(signal.signal_name, "signal_name");
+    xml.number(std::uint64_t{ signal.startBit }, "startBit");
+    xml.number(std::uint64_t{ signal.signalSize }, "signalSize");
+    xml.number(std::uint64_t{ signal.byteOrder }, "byteOrder");
+    xml.text(signal.value_type, "value_type");
+    xml.number(std::uint64_t{ signal.factor }, "factor");
+    xml.number(std::uint64_t{ signal.offset }, "offset");
+    xml.number(std::int64_t{ signal.min }, "min");
+    xml.number(std::int64_t{ signal.max }, "max");
+    xml.text(signal.unit, "unit");
+    xml.text(signal.receiver, "receiver");
+    xml.number(static_cast<std::int64_t>(signal.type), "type");
+
+    xml.element("values");
+    if (xml.container(signal.values.entries.size(), "entries")) {
+        for (const auto& entry : signal.values.entries) {
+            xml.element();
+            xml.number(entry.raw, "raw");
+            xml.text(entry.description, "description");
+            xml.end();
+        }
+        xml.end();
+    }
+    xml.number(signal.values.denseBase, "denseBase");
+    if (xml.container(signal.values.dense.size(), "dense")) {
+        for (const auto slot : signal.values.dense) {
+            xml.number(std::uint64_t{ slot });
+        }
+        xml.end();
+    }
+    xml.end();
+
+    xml.text(signal.multiplexer, "multiplexer");
+    xml.end();
+}
+} // namespace
+
+OutputBuffer::OutputBuffer(std::size_t capacity)
+    : _capacity(capacity)
+{
+    _data.reserve(capacity);
+}
+
+#ifndef _WIN32
+OutputBuffer::OutputBuffer(int fd, std::size_t capacity)
+    : _capacity(capacity)
+    , _fd(fd)
+{
+    // Room for the largest single append past the threshold
+    _data.reserve(capacity + 256);
+}
+#endif
+
+OutputBuffer::~OutputBuffer()
+{
+    try {
+        drain();
+    } catch (const std::exception&) {
+        // Callers that care about write errors flush() explicitly
+    }
+}
+
+void OutputBuffer::appendUnsigned(std::uint64_t value)
+{
+    char digits[20];
+    auto begin = digits + sizeof(digits);
+    while (value >= 100) {
+        const auto pair = static_cast<std::size_t>(value % 100) * 2;
+        value /= 100;
+        *--begin = kDigitPairs[pair + 1];
+        *--begin = kDigitPairs[pair];
+    }
+    if (value >= 10) {
+        const auto pair = static_cast<std::size_t>(value) * 2;
+        *--begin = kDigitPairs[pair + 1];
+        *--begin = kDigitPairs[pair];
+    } else {
+        *--begin = static_cast<char>('0' + value);
+    }
+    append(begin, static_cast<std::size_t>(digits + sizeof(digits) - begin));
+}
+
+void OutputBuffer::appendSigned(std::int64_t value)
+{
+    if (value < 0) {
+        put('-');
+        appendUnsigned(0 - static_cast<std::uint64_t>(value));
+    } else {
+        appendUnsigned(static_cast<std::uint64_t>(value));
+    }
+}
+
+void OutputBuffer::appendHex(std::uint64_t value)
+{
+    char digits[16];
+    auto begin = digits + sizeof(digits);
+    do {
+        *--begin = kHexLower[value & 0xF];
+        value >>= 4;
+    } while (value != 0);
+    append(begin, static_cast<std::size_t>(digits + sizeof(digits) - begin));
+}
+
+void OutputBuffer::flush()
+{
+#ifndef _WIN32
+    if (_fd < 0) {
+        return;
+    }
+    std::size_t written = 0;
+    while (written < _data.size()) {
+        const auto n
+            = ::write(_fd, _data.data() + written, _data.size() - written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            _data.clear();
+            throw std::runtime_error(
+                std::string{ "Write failed: " } + std::strerror(errno));
+        }
+        written += static_cast<std::size_t>(n);
+    }
+    _data.clear();
+#endif
+}
+
+void CANdb::writeJson(const CANdb_t& db, OutputBuffer& out)
+{
+    JsonPrinter json{ out };
+    json.beginObject();
+    json.key("value0");
+    json.beginObject();
+
+    json.field("version", db.version);
+    json.key("nodes");
+    jsonStrings(json, db.nodes);
+    json.key("symbols");
+    jsonStrings(json, db.symbols);
+    json.key("ecus");
+    jsonStrings(json, db.ecus);
+
+    json.key("val_tables");
+    json.beginArray();
+    for (const auto& table : db.val_tables) {
+        json.beginObject();
+        json.field("identifier", table.identifier);
+        json.key("entries");
+        json.beginArray();
+        for (const auto& entry : table.entries) {
+            json.beginObject();
+            json.field("id", entry.id);
+            json.field("ident", entry.ident);
+            json.endObject();
+        }
+        json.endArray();
+        json.endObject();
+    }
+    json.endArray();
+
+    json.key("messages");
+    json.beginArray();
+    for (const auto& msg : db.messages) {
+        json.beginObject();
+        json.key("key");
+        json.beginObject();
+        json.field("id", std::uint64_t{ msg.first.id });
+        json.field("name", msg.first.name);
+        json.field("dlc", std::uint64_t{ msg.first.dlc });
+        json.field("ecu", msg.first.ecu);
+        json.endObject();
+        json.key("value");
+        json.beginArray();
+        for (const auto& signal : msg.second) {
+            jsonSignal(json, signal);
+        }
+        json.endArray();
+        json.endObject();
+    }
+    json.endArray();
+
+    json.endObject();
+    json.endObject();
+}
+
+void CANdb::writeXml(const CANdb_t& db, OutputBuffer& out)
+{
+    XmlPrinter xml{ out };
+    xml.element();
+
+    xml.text(db.version, "version");
+    xmlStrings(xml, db.nodes, "nodes");
+    xmlStrings(xml, db.symbols, "symbols");
+    xmlStrings(xml, db.ecus, "ecus");
+
+    if (xml.container(db.val_tables.size(), "val_tables")) {
+        for (const auto& table : db.val_tables) {
+            xml.element();
+            xml.text(table.identifier, "identifier");
+            if (xml.container(table.entries.size(), "entries")) {
+                for (const auto& entry : table.entries) {
+                    xml.element();
+                    xml.number(entry.id, "id");
+                    xml.text(entry.ident, "ident");
+                    xml.end();
+                }
+                xml.end();
+            }
+            xml.end();
+        }
+        xml.end();
+    }
+
+    if (xml.container(db.messages.size(), "messages")) {
+        for (const auto& msg : db.messages) {
+            xml.element();
+            xml.element("key");
+            xml.number(std::uint64_t{ msg.first.id }, "id");
+            xml.text(msg.first.name, "name");
+            xml.number(std::uint64_t{ msg.first.dlc }, "dlc");
+            xml.text(msg.first.ecu, "ecu");
+            xml.end();
+            if (xml.container(msg.second.size(), "value")) {
+                for (const auto& signal : msg.second) {
+                    xmlSignal(xml, signal);
+                }
+                xml.end();
+            }
+            xml.end();
+        }
+        xml.end();
+    }
+
+    xml.end();
+    xml.end();
+}
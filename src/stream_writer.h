@@ -0,0 +1,95 @@
+#ifndef STREAM_WRITER_H_D2YK6FWB
+#define STREAM_WRITER_H_D2YK6FWB
+
+#include "cantypes.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace CANdb {
+
+/**
+ * Append-only output buffer. Bound to a file descriptor it is written with
+ * write(2) whenever it holds capacity bytes and once more on flush() or
+ * destruction, so the memory use does not depend on the output size.
+ * Without a descriptor everything stays in memory and is read with str().
+ */
+class OutputBuffer {
+public:
+    static constexpr std::size_t kDefaultCapacity = 1 << 20;
+
+    explicit OutputBuffer(std::size_t capacity = kDefaultCapacity);
+#ifndef _WIN32
+    OutputBuffer(int fd, std::size_t capacity = kDefaultCapacity);
+#endif
+    ~OutputBuffer();
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    void put(char c)
+    {
+        _data.push_back(c);
+        if (_data.size() >= _capacity) {
+            drain();
+        }
+    }
+    void append(const char* data, std::size_t size)
+    {
+        _data.append(data, size);
+        if (_data.size() >= _capacity) {
+            drain();
+        }
+    }
+    void append(const std::string& s) { append(s.data(), s.size()); }
+    void append(std::size_t count, char c)
+    {
+        _data.append(count, c);
+        if (_data.size() >= _capacity) {
+            drain();
+        }
+    }
+
+    // Decimal representation without going through a stream or locale
+    void appendUnsigned(std::uint64_t value);
+    void appendSigned(std::int64_t value);
+    // Lower case hex digits without prefix
+    void appendHex(std::uint64_t value);
+
+    // Writes buffered bytes to the descriptor, throws std::runtime_error if
+    // that fails
+    void flush();
+
+    // Everything appended so far, only without a descriptor
+    const std::string& str() const noexcept { return _data; }
+
+    // Clears the buffer and keeps its memory for the next document
+    void clear() noexcept { _data.clear(); }
+
+private:
+    void drain()
+    {
+        if (_fd >= 0) {
+            flush();
+        }
+    }
+
+    std::string _data;
+    std::size_t _capacity;
+    int _fd{ -1 };
+};
+
+/**
+ * Writes db the way cereal::JSONOutputArchive does (4 space indent, the
+ * database named "value0", maps as arrays of key/value objects) in a
+ * single pass over the database.
+ */
+void writeJson(const CANdb_t& db, OutputBuffer& out);
+
+// Same for cereal::XMLOutputArchive with its default options
+void writeXml(const CANdb_t& db, OutputBuffer& out);
+
+} // namespace CANdb
+
+#endif /* end of include guard: STREAM_WRITER_H_D2YK6FWB */
@@ -0,0 +1,178 @@
+#include "text_normalizer.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace CANdb;
+
+namespace {
+constexpr unsigned char kBom[] = { 0xEF, 0xBB, 0xBF };
+
+// Code points of Windows-1252 0x80 to 0x9F. The five unassigned bytes keep
+// their C1 control code point, as Windows itself converts them.
+constexpr std::uint16_t kCp1252[32] = { 0x20AC, 0x0081, 0x201A, 0x0192,
+    0x201E, 0x2026, 0x2020, 0x2021, 0x02C6, 0x2030, 0x0160, 0x2039, 0x0152,
+    0x008D, 0x017D, 0x008F, 0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022,
+    0x2013, 0x2014, 0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E,
+    0x0178 };
+
+// Writes the UTF-8 form of a Windows-1252 byte from 0x80 up, 2 or 3 bytes
+std::size_t appendCp1252(char* out, unsigned char byte) noexcept
+{
+    const std::uint32_t cp = byte < 0xA0 ? kCp1252[byte - 0x80] : byte;
+    if (cp < 0x800) {
+        out[0] = static_cast<char>(0xC0 | (cp >> 6));
+        out[1] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    out[0] = static_cast<char>(0xE0 | (cp >> 12));
+    out[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out[2] = static_cast<char>(0x80 | (cp & 0x3F));
+    return 3;
+}
+} // namespace
+
+std::string CANdb::normalizeText(
+    const std::string& data, TextEncoding encoding)
+{
+    std::string out;
+    normalizeText(data, out, encoding);
+    return out;
+}
+
+void CANdb::normalizeText(
+    const std::string& data, std::string& out, TextEncoding encoding)
+{
+    const auto* in = reinterpret_cast<const unsigned char*>(data.data());
+    const auto size = data.size();
+
+    std::size_t i = 0;
+    if (size >= sizeof(kBom) && std::memcmp(in, kBom, sizeof(kBom)) == 0) {
+        i = sizeof(kBom);
+        if (encoding == TextEncoding::Detect) {
+            encoding = TextEncoding::Utf8;
+        }
+    }
+    bool transcode = encoding == TextEncoding::Windows1252;
+    bool detect = encoding == TextEncoding::Detect;
+
+    // Enough while every byte maps to at most one, transcoding grows it
+    // once to three bytes for each byte left
+    out.resize(size - i);
+    std::size_t w = 0;
+
+    // Handles the byte at i, a CR or one from 0x80 up
+    const auto special = [&]() {
+        const auto c = in[i++];
+        if (c == '\r') {
+            if (i == size || in[i] != '\n') {
+                out[w++] = '\r';
+            }
+            return;
+        }
+        if (detect) {
+            // Everything before is ASCII, valid in both encodings
+            detect = false;
+            transcode = !isValidUtf8(data.data() + i - 1, size - i + 1);
+        }
+        if (!transcode) {
+            out[w++] = static_cast<char>(c);
+            return;
+        }
+        if (out.size() - w < 3 * (size - i + 1)) {
+            out.resize(w + 3 * (size - i + 1));
+        }
+        w += appendCp1252(&out[w], c);
+    };
+
+#if defined(__SSE2__)
+    // out has room for 16 bytes at w whenever 16 are left to read at i
+    const auto cr = _mm_set1_epi8('\r');
+    while (i + 16 <= size) {
+        const auto x
+            = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        auto mask = _mm_movemask_epi8(_mm_cmpeq_epi8(x, cr));
+        if (transcode || detect) {
+            mask |= _mm_movemask_epi8(x);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[w]), x);
+        if (mask == 0) {
+            i += 16;
+            w += 16;
+            continue;
+        }
+        // The bytes before the first special one are already in place
+        const auto clean = static_cast<std::size_t>(__builtin_ctz(mask));
+        i += clean;
+        w += clean;
+        special();
+    }
+#endif
+
+    while (i < size) {
+        if (in[i] == '\r' || (in[i] >= 0x80 && (transcode || detect))) {
+            special();
+        } else {
+            out[w++] = static_cast<char>(in[i++]);
+        }
+    }
+    out.resize(w);
+}
+
+bool CANdb::isValidUtf8(const char* data, std::size_t size) noexcept
+{
+    // Least code point of a sequence with n continuation bytes
+    constexpr std::uint32_t kMin[] = { 0, 0x80, 0x800, 0x10000 };
+
+    const auto* s = reinterpret_cast<const unsigned char*>(data);
+    std::size_t i = 0;
+    while (i < size) {
+#if defined(__SSE2__)
+        if (i + 16 <= size
+            && _mm_movemask_epi8(_mm_loadu_si128(
+                   reinterpret_cast<const __m128i*>(s + i)))
+                == 0) {
+            i += 16;
+            continue;
+        }
+#endif
+        const auto c = s[i];
+        if (c < 0x80) {
+            ++i;
+            continue;
+        }
+
+        std::size_t n;
+        std::uint32_t cp;
+        if ((c & 0xE0) == 0xC0) {
+            n = 1;
+            cp = c & 0x1F;
+        } else if ((c & 0xF0) == 0xE0) {
+            n = 2;
+            cp = c & 0x0F;
+        } else if ((c & 0xF8) == 0xF0) {
+            n = 3;
+            cp = c & 0x07;
+        } else {
+            return false;
+        }
+        if (size - i <= n) {
+            return false;
+        }
+        for (std::size_t k = 1; k <= n; ++k) {
+            if ((s[i + k] & 0xC0) != 0x80) {
+                return false;
+            }
+            cp = (cp << 6) | (s[i + k] & 0x3F);
+        }
+        if (cp < kMin[n] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+            return false;
+        }
+        i += n + 1;
+    }
+    return true;
+}
@@ -0,0 +1,37 @@
+#ifndef TEXT_NORMALIZER_H_P6MD2RXA
+#define TEXT_NORMALIZER_H_P6MD2RXA
+
+#include <cstddef>
+#include <string>
+
+namespace CANdb {
+
+enum class TextEncoding {
+    // Bytes are kept as they are
+    Utf8,
+    // Every byte from 0x80 up is transcoded to UTF-8, Latin-1 text included
+    Windows1252,
+    // UTF-8 if the text has a BOM or is valid UTF-8, Windows-1252 otherwise
+    Detect
+};
+
+/**
+ * Brings DBC text into the form the grammar expects in one pass: drops a
+ * leading UTF-8 BOM, turns CRLF into LF and transcodes Windows-1252 to UTF-8
+ * if encoding asks for it. A lone CR is kept. With SSE2, blocks of 16 bytes
+ * without CR and, when transcoding, without non-ASCII bytes are copied as a
+ * whole. Detect validates the text once, from its first non-ASCII byte on.
+ */
+std::string normalizeText(
+    const std::string& data, TextEncoding encoding = TextEncoding::Utf8);
+
+// Same into out, keeping out's memory if it is enough
+void normalizeText(
+    const std::string& data, std::string& out, TextEncoding encoding);
+
+// Well-formed UTF-8: no overlong forms, surrogates or code points past 10FFFF
+bool isValidUtf8(const char* data, std::size_t size) noexcept;
+
+} // namespace CANdb
+
+#endif /* end of include guard: TEXT_NORMALIZER_H_P6MD2RXA */
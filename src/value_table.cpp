@@ -0,0 +1,67 @@
+#include "value_table.h"
+
+#include <algorithm>
+
+namespace {
+// Value sets spanning at most this many slots per entry get a dense table
+constexpr std::uint64_t kDenseSlotsPerEntry = 4;
+constexpr std::uint64_t kMinDenseSpan = 64;
+} // namespace
+
+template <typename A>
+BasicCANvalueTable<A> CANdb::makeValueTable(const ValuePairs& values,
+    std::uint8_t signalSize, const typename A::template allocator<char>& alloc)
+{
+    using Description = typename BasicCANvalueTable<A>::Description;
+
+    BasicCANvalueTable<A> table{ CANdb::BasicVector<A, Description>(alloc), 0,
+        CANdb::BasicVector<A, std::uint32_t>(alloc) };
+    if (values.empty()) {
+        return table;
+    }
+
+    const auto width = signalSize == 0 ? 64u : signalSize;
+    const auto mask = width >= 64 ? ~std::uint64_t{ 0 }
+                                  : (std::uint64_t{ 1 } << width) - 1;
+
+    table.entries.reserve(values.size());
+    for (const auto& v : values) {
+        table.entries.push_back(
+            Description{ static_cast<std::uint64_t>(v.first) & mask,
+                BasicString<A>(v.second.data(), v.second.size(), alloc) });
+    }
+
+    // Keep the first description of a duplicated value
+    std::stable_sort(table.entries.begin(), table.entries.end(),
+        [](const Description& lhs, const Description& rhs) {
+            return lhs.raw < rhs.raw;
+        });
+    table.entries.erase(std::unique(table.entries.begin(), table.entries.end(),
+                            [](const Description& lhs, const Description& rhs) {
+                                return lhs.raw == rhs.raw;
+                            }),
+        table.entries.end());
+
+    const auto first = table.entries.front().raw;
+    const auto span = table.entries.back().raw - first;
+    const auto limit = std::max(
+        kMinDenseSpan, kDenseSlotsPerEntry * table.entries.size());
+    if (span < limit) {
+        table.denseBase = first;
+        table.dense.assign(span + 1, 0);
+        for (std::size_t i = 0; i < table.entries.size(); ++i) {
+            table.dense[table.entries[i].raw - first]
+                = static_cast<std::uint32_t>(i + 1);
+        }
+    }
+
+    return table;
+}
+
+template CANvalueTable CANdb::makeValueTable<CANdb::StdAllocator>(
+    const CANdb::ValuePairs&, std::uint8_t, const std::allocator<char>&);
+#if CANDB_HAS_PMR
+template CANdb::pmr::CANvalueTable CANdb::makeValueTable<CANdb::PmrAllocator>(
+    const CANdb::ValuePairs&, std::uint8_t,
+    const std::pmr::polymorphic_allocator<char>&);
+#endif
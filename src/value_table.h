@@ -0,0 +1,27 @@
+#ifndef VALUE_TABLE_H_TW3K9DPA
+#define VALUE_TABLE_H_TW3K9DPA
+
+#include "cantypes.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace CANdb {
+
+using ValuePairs = std::vector<std::pair<std::int64_t, std::string>>;
+
+/**
+ * Builds the value lookup of a signal from VAL_/VAL_TABLE_ pairs. Values are
+ * masked to the signal width, so negative descriptions of signed signals
+ * match the raw bit patterns produced by the decoder. The table allocates
+ * from alloc, instantiated for StdAllocator and PmrAllocator.
+ */
+template <typename A = StdAllocator>
+BasicCANvalueTable<A> makeValueTable(const ValuePairs& values,
+    std::uint8_t signalSize,
+    const typename A::template allocator<char>& alloc = {});
+
+} // namespace CANdb
+
+#endif /* end of include guard: VALUE_TABLE_H_TW3K9DPA */
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include "arena_db.hpp"
+#include "dbc_generator.h"
+#include "dbcparser.h"
+#include "log.hpp"
+#include "value_table.h"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+// Makes every allocation that misses the arena throw std::bad_alloc
+class NoDefaultResource {
+public:
+    NoDefaultResource()
+        : _previous(
+              std::pmr::set_default_resource(std::pmr::null_memory_resource()))
+    {
+    }
+    ~NoDefaultResource() { std::pmr::set_default_resource(_previous); }
+
+private:
+    std::pmr::memory_resource* _previous;
+};
+
+template <typename S> std::string str(const S& s)
+{
+    return std::string(s.data(), s.size());
+}
+} // namespace
+
+TEST(ArenaDbTests, value_table_uses_arena)
+{
+    CANdb::ArenaDatabase arena;
+    const std::string longName(64, 'x');
+
+    NoDefaultResource guard;
+    const auto table = CANdb::makeValueTable<CANdb::PmrAllocator>(
+        { { 2, "two" }, { 1, longName }, { -1, "minus one" } }, 8,
+        arena.resource());
+
+    EXPECT_EQ(table.entries.get_allocator().resource(), arena.resource());
+    ASSERT_NE(table.find(1), nullptr);
+    EXPECT_EQ(str(*table.find(1)), longName);
+    ASSERT_NE(table.find(0xFF), nullptr);
+    EXPECT_EQ(str(*table.find(0xFF)), "minus one");
+    EXPECT_EQ(table.find(3), nullptr);
+}
+
+TEST(ArenaDbTests, parse_matches_heap_parse)
+{
+    CANdb::GeneratorOptions options;
+    options.messages = 300;
+    options.multiplexedRatio = 0.25;
+    options.commentRatio = 0.5;
+    options.attributeRatio = 0.5;
+    options.valueTableRatio = 1;
+    const auto dbc = CANdb::generateDbc(options);
+
+    CANdb::DBCParser heapParser;
+    ASSERT_TRUE(heapParser.parse(dbc));
+    const auto expected = heapParser.getDb();
+
+    CANdb::ArenaDatabase arena;
+    CANdb::DBCParser arenaParser;
+    {
+        NoDefaultResource guard;
+        ASSERT_TRUE(arenaParser.parse(dbc, arena.db()));
+    }
+    const auto& db = arena.db();
+
+    EXPECT_EQ(str(db.version), expected.version);
+    ASSERT_EQ(db.ecus.size(), expected.ecus.size());
+    for (std::size_t i = 0; i < db.ecus.size(); ++i) {
+        EXPECT_EQ(str(db.ecus[i]), expected.ecus[i]);
+    }
+    ASSERT_EQ(db.val_tables.size(), expected.val_tables.size());
+
+    ASSERT_EQ(db.messages.size(), expected.messages.size());
+    auto heapMsg = expected.messages.begin();
+    for (const auto& msg : db.messages) {
+        EXPECT_EQ(msg.first.id, heapMsg->first.id);
+        EXPECT_EQ(str(msg.first.name), heapMsg->first.name);
+        EXPECT_EQ(str(msg.first.ecu), heapMsg->first.ecu);
+        ASSERT_EQ(msg.second.size(), heapMsg->second.size());
+        for (std::size_t i = 0; i < msg.second.size(); ++i) {
+            const auto& sig = msg.second[i];
+            const auto& heapSig = heapMsg->second[i];
+            EXPECT_EQ(str(sig.signal_name), heapSig.signal_name);
+            EXPECT_EQ(sig.startBit, heapSig.startBit);
+            EXPECT_EQ(sig.signalSize, heapSig.signalSize);
+            EXPECT_EQ(str(sig.unit), heapSig.unit);
+            EXPECT_EQ(str(sig.multiplexer), heapSig.multiplexer);
+            EXPECT_EQ(sig.values.entries.size(), heapSig.values.entries.size());
+        }
+        ++heapMsg;
+    }
+}
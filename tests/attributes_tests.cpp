@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include "attributes.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+CANdb::AttributeStore makeStore()
+{
+    CANdb::AttributeStore store;
+    EXPECT_TRUE(store.define("BA_DEF_ BO_ \"GenMsgCycleTime\" INT 0 10000;"));
+    EXPECT_TRUE(store.define("BA_DEF_ SG_ \"GenSigStartValue\" FLOAT 0 1e3;"));
+    EXPECT_TRUE(store.define("BA_DEF_ \"BusType\" STRING ;"));
+    EXPECT_TRUE(store.define("BA_DEF_ BO_ \"VFrameFormat\" ENUM "
+                             "\"StandardCAN\",\"ExtendedCAN\",\"J1939PG\";"));
+    EXPECT_TRUE(store.define("BA_DEF_ BU_ \"NodeAddress\" HEX 0 255;"));
+
+    EXPECT_TRUE(store.setDefault("BA_DEF_DEF_ \"GenMsgCycleTime\" 100;"));
+    EXPECT_TRUE(store.setDefault("BA_DEF_DEF_ \"BusType\" \"CAN\";"));
+    EXPECT_TRUE(
+        store.setDefault("BA_DEF_DEF_ \"VFrameFormat\" \"StandardCAN\";"));
+
+    EXPECT_TRUE(store.set("BA_ \"BusType\" \"CAN FD\";"));
+    EXPECT_TRUE(store.set("BA_ \"GenMsgCycleTime\" BO_ 257 10;"));
+    EXPECT_TRUE(store.set("BA_ \"GenMsgCycleTime\" BO_ 2147484160 1000;"));
+    EXPECT_TRUE(store.set("BA_ \"VFrameFormat\" BO_ 2147484160 1;"));
+    EXPECT_TRUE(store.set("BA_ \"GenSigStartValue\" SG_ 257 Speed 2.5;"));
+    EXPECT_TRUE(store.set("BA_ \"NodeAddress\" BU_ EPAS 42;"));
+    return store;
+}
+} // namespace
+
+TEST(AttributeStoreTests, typed_values)
+{
+    const auto store = makeStore();
+    ASSERT_EQ(store.definitions().size(), 5u);
+    EXPECT_EQ(store.size(), 6u);
+
+    const auto* bus = store.find("BusType", CANdb::ObjectRef::network());
+    ASSERT_NE(bus, nullptr);
+    EXPECT_EQ(bus->type, CANdb::AttributeType::String);
+    EXPECT_EQ(bus->text, "CAN FD");
+
+    const auto* start = store.find(
+        "GenSigStartValue", CANdb::ObjectRef::signal(257, "Speed"));
+    ASSERT_NE(start, nullptr);
+    EXPECT_DOUBLE_EQ(start->real, 2.5);
+
+    const auto* address
+        = store.find("NodeAddress", CANdb::ObjectRef::node("EPAS"));
+    ASSERT_NE(address, nullptr);
+    EXPECT_EQ(address->integer, 42);
+    EXPECT_EQ(address->type, CANdb::AttributeType::Hex);
+
+    const auto* format = store.find(
+        "VFrameFormat", CANdb::ObjectRef::message(2147484160u));
+    ASSERT_NE(format, nullptr);
+    EXPECT_EQ(format->integer, 1);
+    EXPECT_EQ(format->text, "ExtendedCAN");
+
+    const auto* definition = store.definition("GenSigStartValue");
+    ASSERT_NE(definition, nullptr);
+    EXPECT_EQ(definition->kind, CANdb::ObjectKind::Signal);
+    EXPECT_DOUBLE_EQ(definition->max, 1000);
+}
+
+TEST(AttributeStoreTests, defaults_applied)
+{
+    const auto store = makeStore();
+
+    const auto cycle = store.id("GenMsgCycleTime");
+    ASSERT_NE(cycle, CANdb::AttributeStore::kNoAttribute);
+    EXPECT_EQ(store.find(cycle, CANdb::ObjectRef::message(257))->integer, 10);
+    EXPECT_EQ(store.find(cycle, CANdb::ObjectRef::message(300))->integer, 100);
+
+    const auto* format
+        = store.find("VFrameFormat", CANdb::ObjectRef::message(257));
+    ASSERT_NE(format, nullptr);
+    EXPECT_EQ(format->text, "StandardCAN");
+
+    // No value and no default
+    EXPECT_EQ(store.find("GenSigStartValue",
+                  CANdb::ObjectRef::signal(257, "Other")),
+        nullptr);
+    EXPECT_EQ(store.find("Unknown", CANdb::ObjectRef::network()), nullptr);
+}
+
+TEST(AttributeStoreTests, message_column)
+{
+    const auto store = makeStore();
+    const auto column = store.messageColumn(
+        "GenMsgCycleTime", std::vector<std::uint32_t>{ 100, 257, 2147484160u });
+    ASSERT_EQ(column.values.size(), 3u);
+    EXPECT_EQ(column.ids[1], 257u);
+    EXPECT_DOUBLE_EQ(column.values[0], 100);
+    EXPECT_DOUBLE_EQ(column.values[1], 10);
+    EXPECT_DOUBLE_EQ(column.values[2], 1000);
+}
+
+TEST(AttributeStoreTests, rejects_bad_statements)
+{
+    auto store = makeStore();
+    EXPECT_FALSE(store.define("BA_DEF_ BO_ \"Broken\" DOUBLE 0 1;"));
+    EXPECT_FALSE(store.setDefault("BA_DEF_DEF_ \"Undefined\" 1;"));
+    EXPECT_FALSE(store.set("BA_ \"Undefined\" BO_ 1 1;"));
+    EXPECT_FALSE(store.set("BA_ \"GenMsgCycleTime\" BO_ 1 fast;"));
+    EXPECT_FALSE(store.set("BA_ \"VFrameFormat\" BO_ 1 7;"));
+    EXPECT_EQ(store.size(), 6u);
+}
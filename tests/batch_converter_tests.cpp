@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "batch_converter.hpp"
+#include "dbc_generator.h"
+#include "dbcparser.h"
+#include "log.hpp"
+#include "stream_writer.h"
+
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+// Removes everything created through it, deepest paths first
+class TempDir {
+public:
+    TempDir()
+    {
+        char path[] = "/tmp/candb_batchXXXXXX";
+        _path = ::mkdtemp(path);
+    }
+    ~TempDir()
+    {
+        for (auto it = _created.rbegin(); it != _created.rend(); ++it) {
+            std::remove(it->c_str());
+        }
+        ::rmdir(_path.c_str());
+    }
+
+    std::string path(const std::string& name) const
+    {
+        return _path + "/" + name;
+    }
+
+    std::string mkdir(const std::string& name)
+    {
+        _created.push_back(path(name));
+        ::mkdir(_created.back().c_str(), 0700);
+        return _created.back();
+    }
+
+    std::string write(const std::string& name, const std::string& data)
+    {
+        _created.push_back(path(name));
+        std::ofstream{ _created.back(), std::ios::binary } << data;
+        return _created.back();
+    }
+
+    std::string link(const std::string& name, const std::string& target)
+    {
+        _created.push_back(path(name));
+        EXPECT_EQ(::symlink(target.c_str(), _created.back().c_str()), 0);
+        return _created.back();
+    }
+
+    // Files the converter creates are removed with the directory
+    void track(const std::string& name) { _created.push_back(path(name)); }
+
+private:
+    std::string _path;
+    std::vector<std::string> _created;
+};
+
+std::string read(const std::string& path)
+{
+    std::ifstream file{ path, std::ios::binary };
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+std::string dbc(std::uint32_t seed)
+{
+    CANdb::GeneratorOptions options;
+    options.messages = 20;
+    options.valueTableRatio = 0.5;
+    options.seed = seed;
+    return CANdb::generateDbc(options);
+}
+
+std::string json(const std::string& dbc)
+{
+    CANdb::DBCParser parser;
+    EXPECT_TRUE(parser.parse(dbc));
+    CANdb::OutputBuffer out;
+    CANdb::writeJson(parser.getDb(), out);
+    return out.str();
+}
+} // namespace
+
+TEST(BatchConverterTests, collect)
+{
+    TempDir dir;
+    dir.mkdir("in");
+    dir.mkdir("in/sub");
+    dir.write("in/b.dbc", "");
+    dir.write("in/a.DBC", "");
+    dir.write("in/notes.txt", "");
+    dir.write("in/d.dbc.gz", "");
+    dir.write("in/e.txt.gz", "");
+    dir.write("in/sub/c.dbc", "");
+
+    const auto files = BatchConverter::collect(
+        { dir.path("in"), dir.path("in/notes.txt") });
+    EXPECT_EQ(files,
+        (std::vector<std::string>{ dir.path("in/a.DBC"), dir.path("in/b.dbc"),
+            dir.path("in/d.dbc.gz"), dir.path("in/sub/c.dbc"),
+            dir.path("in/notes.txt") }));
+
+    const BatchConverter converter{ "out", OutputFormat::Xml, 1 };
+    EXPECT_EQ(converter.outputPath("in/d.dbc.gz"), "out/d.xml");
+    EXPECT_EQ(converter.outputPath("in/bus.v2.dbc"), "out/bus.v2.xml");
+}
+
+TEST(BatchConverterTests, collect_skips_symlinked_directories)
+{
+    TempDir dir;
+    dir.mkdir("in");
+    dir.mkdir("in/sub");
+    dir.write("in/sub/a.dbc", "");
+    dir.link("in/sub/loop", "..");
+    dir.link("in/b.dbc", "sub/a.dbc");
+
+    EXPECT_EQ(BatchConverter::collect({ dir.path("in") }),
+        (std::vector<std::string>{
+            dir.path("in/b.dbc"), dir.path("in/sub/a.dbc") }));
+}
+
+TEST(BatchConverterTests, converts_on_workers)
+{
+    TempDir dir;
+    const auto in = dir.mkdir("in");
+    const auto out = dir.mkdir("out");
+    std::vector<std::string> files;
+    for (std::uint32_t i = 0; i < 8; ++i) {
+        files.push_back(dir.write(fmt::format("in/bus{}.dbc", i), dbc(i + 1)));
+        dir.track(fmt::format("out/bus{}.json", i));
+    }
+
+    const BatchConverter converter{ out, OutputFormat::Json, 3 };
+    const auto results = converter.run(files);
+    ASSERT_EQ(results.size(), files.size());
+    for (std::uint32_t i = 0; i < files.size(); ++i) {
+        const auto& result = results[i];
+        EXPECT_EQ(result.input, files[i]);
+        ASSERT_EQ(result.output, out + fmt::format("/bus{}.json", i))
+            << result.error;
+        EXPECT_EQ(read(result.output), json(dbc(i + 1)));
+        EXPECT_EQ(result.bytesOut, read(result.output).size());
+        EXPECT_EQ(result.bytesIn, dbc(i + 1).size());
+    }
+    EXPECT_NE(summary(results, 1).find("Converted 8 files (0 failed)"),
+        std::string::npos);
+}
+
+TEST(BatchConverterTests, failures_keep_previous_output)
+{
+    TempDir dir;
+    dir.mkdir("in");
+    const auto out = dir.mkdir("out");
+    const auto good = dir.write("in/good.dbc", dbc(1));
+    const auto bad = dir.write("in/bad.dbc", "VERSION \"\"\n\nBO_ x\n");
+    const auto previous = dir.write("out/bad.json", "previous");
+    dir.mkdir("other");
+    const auto twin = dir.write("other/good.dbc", dbc(2));
+    dir.track("out/good.json");
+
+    const BatchConverter converter{ out, OutputFormat::Json, 2 };
+    const auto results = converter.run({ good, bad, twin });
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_EQ(results[0].output, out + "/good.json");
+    EXPECT_TRUE(results[1].output.empty());
+    EXPECT_NE(results[1].error.find("parse failed"), std::string::npos);
+    EXPECT_TRUE(results[2].output.empty());
+    EXPECT_NE(results[2].error.find(good), std::string::npos);
+
+    EXPECT_EQ(read(previous), "previous");
+    EXPECT_EQ(read(out + "/good.json"), json(dbc(1)));
+    EXPECT_NE(summary(results, 1).find("FAILED: parse failed"),
+        std::string::npos);
+}
+
+TEST(BatchConverterTests, encoding)
+{
+    TempDir dir;
+    dir.mkdir("in");
+    const auto out = dir.mkdir("out");
+    const auto latin = dir.write("in/latin.dbc", "VERSION \"caf\xE9\"\n");
+    dir.track("out/latin.json");
+
+    const BatchConverter converter{ out, OutputFormat::Json, 1,
+        CANdb::TextEncoding::Windows1252 };
+    const auto results = converter.run({ latin });
+    ASSERT_EQ(results.size(), 1u);
+    ASSERT_EQ(results[0].output, out + "/latin.json") << results[0].error;
+    EXPECT_EQ(read(results[0].output), json("VERSION \"caf\xC3\xA9\"\n"));
+}
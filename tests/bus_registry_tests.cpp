@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include "bus_registry.h"
+#include "dbc_generator.h"
+#include "log.hpp"
+#include "value_table.h"
+
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+CANsignal makeSignal(const std::string& name, std::uint8_t startBit,
+    std::uint8_t size, const std::string& unit = "")
+{
+    return CANsignal{ name, startBit, size, 1, "+", 1, 0, 0, 0, unit, "NEO" };
+}
+
+CANdb_t makeDb(const std::string& brakeName, std::uint8_t speedSize)
+{
+    CANdb_t db;
+    db.version = "1.0";
+    db.ecus = { "NEO", "EPAS" };
+    db.messages[CANmessage{ 100, "Speed", 8, "NEO" }]
+        = { makeSignal("speed", 0, speedSize, "km/h") };
+    db.messages[CANmessage{ 200, brakeName, 2, "EPAS" }]
+        = { makeSignal("pressure", 0, 12, "bar") };
+    db.messages[CANmessage{ 0x80001234, "Diag", 8, "NEO" }]
+        = { makeSignal("mode", 0, 4) };
+    db.messages.at(CANmessage{ 0x80001234 }).front().values
+        = CANdb::makeValueTable({ { 0, "OFF" }, { 1, "ON" } }, 4);
+    return db;
+}
+} // namespace
+
+TEST(BusRegistryTests, shared_strings)
+{
+    CANdb::BusRegistry registry;
+    EXPECT_EQ(registry.add(makeDb("Brake", 16)), 0u);
+    const auto strings = registry.strings().size();
+    const auto bytes = registry.strings().bytes();
+    EXPECT_EQ(registry.add(makeDb("Brake", 16)), 1u);
+
+    EXPECT_EQ(registry.strings().size(), strings);
+    EXPECT_EQ(registry.strings().bytes(), bytes);
+    EXPECT_EQ(registry.bus(0).ecus[0].data(), registry.bus(1).ecus[0].data());
+    EXPECT_EQ(registry.bus(1).version, "1.0");
+}
+
+TEST(BusRegistryTests, find)
+{
+    CANdb::BusRegistry registry;
+    registry.add(makeDb("Brake", 16));
+    registry.add(makeDb("BrakeStatus", 16));
+
+    const auto brake = registry.find(1, 200);
+    ASSERT_NE(brake, nullptr);
+    EXPECT_EQ(brake->first.name, "BrakeStatus");
+    ASSERT_EQ(brake->second.size(), 1u);
+    EXPECT_EQ(brake->second[0].unit, "bar");
+
+    const auto diag = registry.find(0, 0x80001234);
+    ASSERT_NE(diag, nullptr);
+    EXPECT_EQ(diag->second[0].describe(1), "ON");
+
+    EXPECT_EQ(registry.find(0, 300), nullptr);
+    EXPECT_EQ(registry.find(2, 100), nullptr);
+    EXPECT_THROW(registry.bus(2), std::out_of_range);
+}
+
+TEST(BusRegistryTests, conflicts)
+{
+    CANdb::BusRegistry registry;
+    registry.add(makeDb("Brake", 16));
+    registry.add(makeDb("Brake", 16));
+    EXPECT_TRUE(registry.conflicts().empty());
+
+    registry.add(makeDb("BrakeStatus", 12));
+    const auto conflicts = registry.conflicts();
+    ASSERT_EQ(conflicts.size(), 2u);
+    EXPECT_EQ(conflicts[0].id, 100u);
+    EXPECT_EQ(conflicts[0].firstBus, 0u);
+    EXPECT_EQ(conflicts[0].secondBus, 2u);
+    EXPECT_EQ(conflicts[0].reason, "signal speed vs speed");
+    EXPECT_EQ(conflicts[1].id, 200u);
+    EXPECT_EQ(conflicts[1].reason, "name Brake vs BrakeStatus");
+}
+
+TEST(BusRegistryTests, parallel_load)
+{
+    std::vector<std::string> dbcs;
+    CANdb::GeneratorOptions options;
+    options.messages = 50;
+    options.valueTableRatio = 0.5;
+    for (std::uint32_t seed = 1; seed <= 6; ++seed) {
+        options.seed = seed;
+        dbcs.push_back(CANdb::generateDbc(options));
+    }
+
+    CANdb::BusRegistry registry;
+    ASSERT_TRUE(registry.load(dbcs, 3));
+    ASSERT_EQ(registry.buses(), dbcs.size());
+    for (std::size_t bus = 0; bus < registry.buses(); ++bus) {
+        EXPECT_EQ(registry.bus(bus).messages.size(), options.messages);
+        for (const auto& msg : registry.bus(bus).messages) {
+            EXPECT_EQ(registry.find(bus, msg.first.id), &msg);
+        }
+    }
+
+    dbcs.push_back("BO_ broken");
+    EXPECT_FALSE(registry.load(dbcs));
+    EXPECT_EQ(registry.buses(), dbcs.size() - 1);
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include "dbc_generator.h"
+#include "dbcparser.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+TEST(DbcGeneratorTests, deterministic_output)
+{
+    CANdb::GeneratorOptions options;
+    options.messages = 50;
+    options.commentRatio = 0.5;
+    options.attributeRatio = 0.5;
+    options.valueTableRatio = 0.5;
+    options.multiplexedRatio = 0.5;
+
+    const auto first = CANdb::generateDbc(options);
+    EXPECT_EQ(first, CANdb::generateDbc(options));
+
+    options.seed = 2;
+    EXPECT_NE(first, CANdb::generateDbc(options));
+}
+
+TEST(DbcGeneratorTests, crlf_line_endings)
+{
+    CANdb::GeneratorOptions options;
+    options.messages = 10;
+    options.commentRatio = 1;
+    options.crlf = true;
+
+    const auto dbc = CANdb::generateDbc(options);
+    std::size_t lines = 0;
+    for (std::size_t i = 0; i < dbc.size(); ++i) {
+        if (dbc[i] == '\n') {
+            ASSERT_GT(i, 0u);
+            EXPECT_EQ(dbc[i - 1], '\r');
+            ++lines;
+        }
+    }
+    EXPECT_GT(lines, 10u);
+}
+
+TEST(DbcGeneratorTests, generated_file_parses)
+{
+    CANdb::GeneratorOptions options;
+    options.messages = 200;
+    options.signalsPerMessage = 12;
+    options.multiplexedRatio = 0.25;
+    options.commentRatio = 0.5;
+    options.attributeRatio = 0.5;
+    options.valueTableRatio = 1;
+    options.crlf = true;
+
+    CANdb::DBCParser parser;
+    ASSERT_TRUE(parser.parse(CANdb::generateDbc(options)));
+
+    const auto db = parser.getDb();
+    EXPECT_EQ(db.ecus.size(), options.ecus);
+    ASSERT_EQ(db.messages.size(), options.messages);
+
+    std::size_t multiplexed = 0;
+    for (const auto& msg : db.messages) {
+        ASSERT_EQ(msg.second.size(), options.signalsPerMessage);
+        for (const auto& sig : msg.second) {
+            EXPECT_FALSE(sig.values.empty()) << sig.signal_name;
+        }
+        if (msg.second.front().multiplexer == "M") {
+            ++multiplexed;
+            EXPECT_EQ(msg.second.at(1).multiplexer, "m0");
+        }
+    }
+    EXPECT_GT(multiplexed, 0u);
+    EXPECT_LT(multiplexed, options.messages);
+}
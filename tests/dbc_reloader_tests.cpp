@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+#include "dbc_reloader.h"
+#include "log.hpp"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+// Both fields always hold the same value until destruction
+struct Pair {
+    explicit Pair(std::uint64_t v)
+        : first(v)
+        , second(v)
+    {
+    }
+    ~Pair() { first = second + 1; }
+
+    std::uint64_t first;
+    std::uint64_t second;
+};
+
+const char kDbc[] = R"(VERSION "{}"
+
+BU_ : NEO
+
+BO_ 100 Speed: 8 NEO
+  SG_ speed : 0|16@1+ (1,0) [0|0] "km/h" NEO
+
+)";
+
+class TempDir {
+public:
+    TempDir()
+    {
+        char path[] = "/tmp/candb_reloadXXXXXX";
+        _path = ::mkdtemp(path);
+    }
+    ~TempDir()
+    {
+        std::remove(file().c_str());
+        std::remove((file() + ".tmp").c_str());
+        ::rmdir(_path.c_str());
+    }
+
+    std::string file() const { return _path + "/bus.dbc"; }
+
+    // Replaces the file by renaming like most editors
+    void write(const std::string& data) const
+    {
+        std::ofstream{ file() + ".tmp", std::ios::binary } << data;
+        std::rename((file() + ".tmp").c_str(), file().c_str());
+    }
+
+private:
+    std::string _path;
+};
+
+template <typename Predicate> bool waitFor(Predicate predicate)
+{
+    const auto deadline
+        = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+} // namespace
+
+TEST(SnapshotCellTests, retired_until_readers_leave)
+{
+    CANdb::SnapshotCell<Pair> cell{ 2 };
+    auto reader = cell.reader();
+    EXPECT_FALSE(reader.lock());
+
+    cell.publish(std::make_unique<const Pair>(1));
+    {
+        const auto lock = reader.lock();
+        ASSERT_TRUE(lock);
+        cell.publish(std::make_unique<const Pair>(2));
+        EXPECT_EQ(cell.pending(), 1u);
+        EXPECT_EQ(lock->first, 1u);
+    }
+    EXPECT_EQ(cell.reclaim(), 0u);
+    EXPECT_EQ(reader.lock()->first, 2u);
+
+    auto second = cell.reader();
+    EXPECT_THROW(cell.reader(), std::runtime_error);
+}
+
+TEST(SnapshotCellTests, concurrent_readers)
+{
+    CANdb::SnapshotCell<Pair> cell;
+    cell.publish(std::make_unique<const Pair>(0));
+
+    std::atomic<bool> done{ false };
+    std::atomic<std::uint64_t> torn{ 0 };
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&cell, &done, &torn]() {
+            auto reader = cell.reader();
+            std::uint64_t last = 0;
+            while (!done) {
+                const auto lock = reader.lock();
+                if (lock->first != lock->second || lock->first < last) {
+                    ++torn;
+                }
+                last = lock->first;
+            }
+        });
+    }
+
+    for (std::uint64_t i = 1; i <= 20000; ++i) {
+        cell.publish(std::make_unique<const Pair>(i));
+    }
+    done = true;
+    for (auto& thread : readers) {
+        thread.join();
+    }
+    EXPECT_EQ(torn, 0u);
+    EXPECT_EQ(cell.reclaim(), 0u);
+}
+
+TEST(DbcReloaderTests, reload_on_change)
+{
+    TempDir dir;
+    dir.write(fmt::format(kDbc, "1"));
+
+    CANdb::DbcReloader reloader{ dir.file() };
+    std::vector<CANdb::Diagnostic> diagnostics;
+    reloader.onFailure(
+        [&diagnostics](const std::vector<CANdb::Diagnostic>& problems) {
+            diagnostics = problems;
+        });
+    ASSERT_TRUE(reloader.reload());
+    ASSERT_TRUE(reloader.start());
+
+    auto reader = reloader.reader();
+    EXPECT_EQ(reader.lock()->db.version, "1");
+    EXPECT_EQ(reader.lock()->generation, 1u);
+
+    dir.write(fmt::format(kDbc, "2"));
+    ASSERT_TRUE(waitFor([&reloader]() { return reloader.generation() == 2; }));
+    {
+        const auto snapshot = reader.lock();
+        EXPECT_EQ(snapshot->db.version, "2");
+        EXPECT_EQ(snapshot->db.messages.size(), 1u);
+    }
+
+    // A broken file keeps the last good snapshot
+    dir.write(fmt::format(kDbc, "3") + "BO_ 200 Broken 8 NEO\n SG_ x :\n");
+    ASSERT_TRUE(waitFor([&reloader]() { return reloader.failures() == 1; }));
+    EXPECT_FALSE(diagnostics.empty());
+    EXPECT_EQ(reloader.generation(), 2u);
+    EXPECT_EQ(reader.lock()->db.version, "2");
+
+    reloader.stop();
+}
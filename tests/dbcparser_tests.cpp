@@ -4,6 +4,7 @@
 #include "dbc_parser_data.hpp"
 #include "dbcparser.h"
 #include "log.hpp"
+#include "value_table.h"
 
 using strings = std::vector<std::string>;
 std::shared_ptr<spdlog::logger> kDefaultLogger
@@ -53,6 +54,10 @@ struct MessageTests : public ::testing::Test {
     CANdb::DBCParser parser;
 };
 
+struct ValueDescriptionTests : public ::testing::Test {
+    CANdb::DBCParser parser;
+};
+
 TEST_F(DBCParserTests, empty_data)
 {
     EXPECT_FALSE(parser.parse(""));
@@ -179,7 +184,32 @@ BU_ :
     dbc += "\n";
     ASSERT_TRUE(parser.parse(dbc));
 
-    EXPECT_EQ(parser.getDb().val_tables.size(), values.size());
+    ASSERT_EQ(parser.getDb().val_tables.size(), values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        EXPECT_EQ(parser.getDb().val_tables.at(i).identifier,
+            values.at(i).substr(0, values.at(i).find(' ')));
+    }
+}
+
+TEST_F(DBCParserTests, val_table_keeps_wide_values)
+{
+    ASSERT_TRUE(parser.parse(R"(VERSION ""
+
+NS_ :
+  NS_DESC
+
+BU_ :
+  NEO
+
+VAL_TABLE_ Wide 4294967296 "BIG" -1 "MINUS" ;
+
+)"));
+    ASSERT_EQ(parser.getDb().val_tables.size(), 1u);
+    const auto& entries = parser.getDb().val_tables.front().entries;
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_EQ(entries.at(0).id, 4294967296);
+    EXPECT_EQ(entries.at(0).ident, "BIG");
+    EXPECT_EQ(entries.at(1).id, -1);
 }
 
 TEST_F(MessageTests, messages)
@@ -247,6 +277,128 @@ BU_ :
     EXPECT_EQ(parser.getDb().messages.at(msg).at(3), expSig);
 }
 
+TEST_F(MessageTests, profiling)
+{
+    std::string dbc =
+        R"(VERSION ""
+
+NS_ :
+  NS_DESC
+
+BU_ :
+  NEO
+
+)";
+    dbc += test_data::bo1;
+    dbc += "\n\n";
+
+    ASSERT_TRUE(parser.parse(dbc));
+    EXPECT_TRUE(parser.profile().rules.empty());
+
+    parser.enableProfiling();
+    ASSERT_TRUE(parser.parse(dbc));
+    const auto& profile = parser.profile();
+    EXPECT_GT(profile.totalMs, 0);
+    EXPECT_FALSE(profile.lines.empty());
+
+    const auto signal = std::find_if(profile.rules.begin(),
+        profile.rules.end(),
+        [](const CANdb::RuleProfile& r) { return r.rule == "signal"; });
+    ASSERT_NE(signal, profile.rules.end());
+    EXPECT_GE(signal->successes, 5u);
+    EXPECT_EQ(signal->attempts, signal->successes + signal->failures);
+}
+
+TEST_F(MessageTests, recovery)
+{
+    std::string dbc =
+        R"(VERSION ""
+
+NS_ :
+  NS_DESC
+
+BU_ :
+  NEO
+
+)";
+    dbc += test_data::bo1;
+    dbc += "\n\n";
+    const auto brokenLine
+        = static_cast<std::size_t>(std::count(dbc.begin(), dbc.end(), '\n'))
+        + 1;
+    dbc += "BO_ 300 Broken 8 NEO\n"
+           " SG_ Lost : 0|8@1+ (1,0) [0|0] \"\" EPAS\n\n";
+    dbc += test_data::bo2;
+    dbc += "\n\n";
+
+    EXPECT_FALSE(parser.parse(dbc));
+    ASSERT_EQ(parser.diagnostics().size(), 1u);
+    EXPECT_EQ(parser.diagnostics().front().line, brokenLine);
+    EXPECT_EQ(parser.diagnostics().front().rule, "message");
+
+    CANdb::DBCParser recovering;
+    recovering.enableRecovery();
+    EXPECT_FALSE(recovering.parse(dbc));
+    ASSERT_EQ(recovering.diagnostics().size(), 1u);
+    EXPECT_EQ(recovering.diagnostics().front().line, brokenLine);
+
+    const auto db = recovering.getDb();
+    EXPECT_EQ(db.messages.size(), 2u);
+    EXPECT_EQ(db.messages.count(CANmessage{ 1160 }), 1u);
+    EXPECT_EQ(db.messages.count(CANmessage{ 257 }), 1u);
+    EXPECT_EQ(db.messages.count(CANmessage{ 300 }), 0u);
+}
+
+TEST_F(MessageTests, recovery_resumes_after_parsed_statements)
+{
+    std::string dbc =
+        R"(VERSION "2.0"
+
+NS_ :
+  NS_DESC
+
+BU_ :
+  NEO
+
+)";
+    dbc += test_data::bo1;
+    dbc += "\n\n";
+    const auto badSignalLine
+        = static_cast<std::size_t>(std::count(dbc.begin(), dbc.end(), '\n'))
+        + 3;
+    dbc += "BO_ 400 Partial: 2 NEO\n"
+           " SG_ Low : 0|8@1+ (1,0) [0|0] \"\" EPAS\n"
+           " SG_ Bad : 8|x@1+ (1,0) [0|0] \"\" EPAS\n"
+           " SG_ High : 8|8@1+ (1,0) [0|0] \"\" EPAS\n\n";
+    const auto brokenLine = badSignalLine + 3;
+    dbc += "BO_ 300 Broken 8 NEO\n\n";
+    dbc += test_data::bo2;
+    dbc += "\n\nVAL_ 400 High 1 \"ON\" ;\n";
+
+    parser.enableRecovery();
+    EXPECT_FALSE(parser.parse(dbc));
+    ASSERT_EQ(parser.diagnostics().size(), 2u);
+    EXPECT_EQ(parser.diagnostics().at(0).line, badSignalLine);
+    EXPECT_EQ(parser.diagnostics().at(0).rule, "signal");
+    EXPECT_EQ(parser.diagnostics().at(1).line, brokenLine);
+    EXPECT_EQ(parser.diagnostics().at(1).rule, "message");
+
+    // Statements before each error are kept, the message of the failed
+    // signal is parsed again with its remaining signals
+    const auto& db = parser.getDb();
+    EXPECT_EQ(db.version, "2.0");
+    EXPECT_EQ(db.ecus.size(), 1u);
+    EXPECT_EQ(db.messages.size(), 3u);
+    EXPECT_EQ(db.messages.at(CANmessage{ 1160 }).size(), 5u);
+    EXPECT_EQ(db.messages.count(CANmessage{ 257 }), 1u);
+    const auto& partial = db.messages.at(CANmessage{ 400 });
+    ASSERT_EQ(partial.size(), 2u);
+    EXPECT_EQ(partial.at(0).signal_name, "Low");
+    EXPECT_EQ(partial.at(1).signal_name, "High");
+    ASSERT_NE(partial.at(1).values.find(1), nullptr);
+    EXPECT_EQ(*partial.at(1).values.find(1), "ON");
+}
+
 TEST_P(ValuesTest, vals)
 {
     auto values = GetParam();
@@ -269,6 +421,285 @@ BU_ :
     ASSERT_TRUE(parser.parse(dbc));
 }
 
+TEST_F(ValueDescriptionTests, vals_attached_to_signals)
+{
+    std::string dbc =
+        R"(VERSION ""
+
+NS_ :
+  NS_DESC
+
+BU_ :
+  NEO
+  EPAS
+
+VAL_TABLE_ ControlType 3 "RESERVED" 2 "FULL" 1 "PARTIAL" 0 "NONE" ;
+
+BO_ 257 GTW_epasControl: 3 NEO
+  SG_ GTW_epasControlType : 8|2@1+ (1,0) [4|-1] "" NEO
+  SG_ GTW_epasPowerMode : 1|4@1+ (1,0) [4|14] "" NEO
+  SG_ GTW_epasTorque : 16|8@1- (1,0) [0|0] "" NEO
+  SG_ GTW_epasTuneRequest : 5|3@1+ (1,0) [8|-1] "" NEO
+
+VAL_ 257 GTW_epasPowerMode 0 "DRIVE_OFF" 1 "DRIVE_ON" 15 "SNA" ;
+VAL_ 257 GTW_epasControlType ControlType ;
+VAL_ 257 GTW_epasTorque -1 "MINUS_ONE" 100 "LARGE" ;
+)";
+    ASSERT_TRUE(parser.parse(dbc));
+
+    const auto db = parser.getDb();
+    ASSERT_EQ(db.val_tables.size(), 1);
+    EXPECT_EQ(db.val_tables.at(0).identifier, "ControlType");
+
+    const auto& signals = db.messages.at(CANmessage{ 257 });
+    ASSERT_EQ(signals.size(), 4);
+
+    const auto& controlType = signals.at(0).values;
+    ASSERT_EQ(controlType.entries.size(), 4);
+    ASSERT_NE(controlType.find(2), nullptr);
+    EXPECT_EQ(*controlType.find(2), "FULL");
+    EXPECT_EQ(controlType.find(4), nullptr);
+
+    const auto& powerMode = signals.at(1).values;
+    ASSERT_NE(powerMode.find(15), nullptr);
+    EXPECT_EQ(*powerMode.find(15), "SNA");
+    EXPECT_EQ(*powerMode.find(0), "DRIVE_OFF");
+    EXPECT_EQ(powerMode.find(7), nullptr);
+
+    // Negative values are matched against the raw bit pattern
+    const auto& torque = signals.at(2).values;
+    ASSERT_NE(torque.find(0xFF), nullptr);
+    EXPECT_EQ(*torque.find(0xFF), "MINUS_ONE");
+
+    EXPECT_TRUE(signals.at(3).values.empty());
+}
+
+TEST_F(ValueDescriptionTests, deferred_sections)
+{
+    const std::string dbc =
+        R"(VERSION "1.0"
+
+NS_ :
+  NS_DESC
+
+BU_ :
+  NEO
+
+BO_ 257 GTW_epasControl: 3 NEO
+  SG_ GTW_epasPowerMode : 1|4@1+ (1,0) [4|14] "" NEO
+
+CM_ SG_ 257 GTW_epasPowerMode "Power mode;
+of the EPAS";
+VAL_ 257 GTW_epasPowerMode 0 "DRIVE_OFF" 1 "DRIVE_ON" 15 "SNA" ;
+)";
+    parser.setSections(CANdb::kLayoutOnly);
+    ASSERT_TRUE(parser.parse(dbc));
+    EXPECT_EQ(parser.deferred().statements.size(), 2u);
+    EXPECT_EQ(parser.deferred().sections(),
+        CANdb::sectionBit(CANdb::Section::Comments)
+            | CANdb::sectionBit(CANdb::Section::ValueDescriptions));
+    EXPECT_TRUE(
+        parser.getDb().messages.at(CANmessage{ 257 }).at(0).values.empty());
+
+    ASSERT_TRUE(parser.materialize(
+        CANdb::sectionBit(CANdb::Section::ValueDescriptions)));
+    EXPECT_EQ(parser.deferred().statements.size(), 1u);
+
+    const auto db = parser.getDb();
+    EXPECT_EQ(db.version, "1.0");
+    ASSERT_EQ(db.messages.size(), 1u);
+    const auto& powerMode = db.messages.at(CANmessage{ 257 }).at(0).values;
+    ASSERT_NE(powerMode.find(15), nullptr);
+    EXPECT_EQ(*powerMode.find(15), "SNA");
+}
+
+TEST_F(ValueDescriptionTests, failed_materialize_keeps_statements_deferred)
+{
+    const std::string dbc =
+        R"(VERSION "1.0"
+
+NS_ :
+  NS_DESC
+
+BU_ :
+  NEO
+
+BO_ 257 GTW_epasControl: 3 NEO
+  SG_ GTW_epasPowerMode : 1|4@1+ (1,0) [4|14] "" NEO
+
+CM_ SG_ 257 GTW_epasPowerMode "Power mode";
+VAL_ 257 GTW_epasPowerMode 0 "DRIVE_OFF" 1 ;
+VAL_ 257 GTW_epasPowerMode 15 "SNA" ;
+)";
+    parser.setSections(CANdb::kLayoutOnly);
+    ASSERT_TRUE(parser.parse(dbc));
+    ASSERT_EQ(parser.deferred().statements.size(), 3u);
+
+    const auto values = CANdb::sectionBit(CANdb::Section::ValueDescriptions);
+    EXPECT_FALSE(parser.materialize(values));
+    ASSERT_EQ(parser.diagnostics().size(), 1u);
+    EXPECT_EQ(parser.deferred().statements.size(), 3u);
+    EXPECT_EQ(parser.deferred().sections(),
+        values | CANdb::sectionBit(CANdb::Section::Comments));
+    EXPECT_EQ(parser.getDb().messages.size(), 1u);
+}
+
+TEST_F(ValueDescriptionTests, materialize_with_recovery_keeps_layout)
+{
+    const std::string dbc =
+        R"(VERSION "1.0"
+
+NS_ :
+  NS_DESC
+
+BU_ :
+  NEO
+
+BO_ 257 GTW_epasControl: 3 NEO
+  SG_ GTW_epasPowerMode : 1|4@1+ (1,0) [4|14] "" NEO
+
+BA_DEF_ BO_ "GenMsgCycleTime" INT 0 1000;
+BA_ "GenMsgCycleTime" BO_ 257 ;
+BA_ "GenMsgCycleTime" BO_ 257 20;
+VAL_ 257 GTW_epasPowerMode 0 "DRIVE_OFF" 1 ;
+VAL_ 257 GTW_epasPowerMode 15 "SNA" ;
+)";
+    const auto lineOf = [&dbc](const std::string& statement) {
+        return static_cast<std::size_t>(std::count(
+                   dbc.begin(), dbc.begin() + dbc.find(statement), '\n'))
+            + 1;
+    };
+
+    parser.setSections(CANdb::kLayoutOnly);
+    parser.enableRecovery();
+    ASSERT_TRUE(parser.parse(dbc));
+    EXPECT_EQ(parser.deferred().statements.size(), 5u);
+
+    EXPECT_FALSE(parser.materialize());
+    EXPECT_TRUE(parser.deferred().empty());
+
+    // Lines of the input, not of the text materialize() parsed
+    ASSERT_EQ(parser.diagnostics().size(), 2u);
+    EXPECT_EQ(parser.diagnostics().at(0).line, lineOf("BO_ 257 ;"));
+    EXPECT_EQ(parser.diagnostics().at(0).rule, "ba");
+    EXPECT_EQ(parser.diagnostics().at(1).line, lineOf("\"DRIVE_OFF\" 1 ;"));
+    EXPECT_EQ(parser.diagnostics().at(1).rule, "vals");
+
+    // The layout parsed before is kept, the statements that parsed are added
+    const auto& db = parser.getDb();
+    EXPECT_EQ(db.version, "1.0");
+    EXPECT_EQ(db.ecus.size(), 1u);
+    ASSERT_EQ(db.messages.size(), 1u);
+    const auto& signals = db.messages.at(CANmessage{ 257 });
+    ASSERT_EQ(signals.size(), 1u);
+    ASSERT_NE(signals.at(0).values.find(15), nullptr);
+    EXPECT_EQ(*signals.at(0).values.find(15), "SNA");
+
+    const auto* cycle = parser.attributes().find(
+        "GenMsgCycleTime", CANdb::ObjectRef::message(257));
+    ASSERT_NE(cycle, nullptr);
+    EXPECT_DOUBLE_EQ(cycle->real, 20);
+}
+
+TEST_F(MessageTests, attributes)
+{
+    std::string dbc =
+        R"(VERSION ""
+
+NS_ :
+  NS_DESC
+
+BU_ :
+  NEO
+
+)";
+    dbc += test_data::bo1;
+    dbc += R"(
+
+BA_DEF_ BO_ "GenMsgCycleTime" INT 0 10000;
+BA_DEF_ BO_ "VFrameFormat" ENUM "StandardCAN","ExtendedCAN";
+BA_DEF_ SG_ "GenSigStartValue" FLOAT 0 100;
+BA_DEF_DEF_ "GenMsgCycleTime" 100;
+BA_DEF_DEF_ "VFrameFormat" "StandardCAN";
+BA_ "GenMsgCycleTime" BO_ 1160 20;
+BA_ "GenSigStartValue" SG_ 1160 DAS_steeringControlType 1.5;
+)";
+
+    ASSERT_TRUE(parser.parse(dbc));
+    const auto& attributes = parser.attributes();
+    EXPECT_EQ(attributes.definitions().size(), 3u);
+
+    const auto column
+        = attributes.messageColumn("GenMsgCycleTime", parser.getDb());
+    ASSERT_EQ(column.values.size(), 1u);
+    EXPECT_DOUBLE_EQ(column.values[0], 20);
+
+    const auto* format = attributes.find(
+        "VFrameFormat", CANdb::ObjectRef::message(1160));
+    ASSERT_NE(format, nullptr);
+    EXPECT_EQ(format->text, "StandardCAN");
+
+    const auto* start = attributes.find("GenSigStartValue",
+        CANdb::ObjectRef::signal(1160, "DAS_steeringControlType"));
+    ASSERT_NE(start, nullptr);
+    EXPECT_DOUBLE_EQ(start->real, 1.5);
+}
+
+TEST_F(MessageTests, attributes_deferred_with_definitions)
+{
+    std::string dbc =
+        R"(VERSION ""
+
+NS_ :
+  NS_DESC
+
+BU_ :
+  NEO
+
+)";
+    dbc += test_data::bo1;
+    dbc += R"(
+
+BA_DEF_ BO_ "GenMsgCycleTime" INT 0 10000;
+BA_DEF_DEF_ "GenMsgCycleTime" 100;
+BA_ "GenMsgCycleTime" BO_ 1160 20;
+)";
+
+    // Attributes are asked for, but cannot be read without definitions
+    parser.setSections(CANdb::kAllSections
+        & ~CANdb::sectionBit(CANdb::Section::AttributeDefinitions));
+    ASSERT_TRUE(parser.parse(dbc));
+    EXPECT_TRUE(parser.attributes().empty());
+    EXPECT_EQ(parser.deferred().statements.size(), 3u);
+
+    ASSERT_TRUE(
+        parser.materialize(CANdb::sectionBit(CANdb::Section::Attributes)));
+    EXPECT_TRUE(parser.deferred().empty());
+    const auto* cycle = parser.attributes().find(
+        "GenMsgCycleTime", CANdb::ObjectRef::message(1160));
+    ASSERT_NE(cycle, nullptr);
+    EXPECT_EQ(cycle->integer, 20);
+}
+
+TEST_F(ValueDescriptionTests, dense_and_sparse_lookup)
+{
+    const auto dense = CANdb::makeValueTable(
+        { { 1, "ONE" }, { 0, "ZERO" }, { 3, "THREE" } }, 8);
+    EXPECT_FALSE(dense.dense.empty());
+    EXPECT_EQ(*dense.find(0), "ZERO");
+    EXPECT_EQ(*dense.find(3), "THREE");
+    EXPECT_EQ(dense.find(2), nullptr);
+    EXPECT_EQ(dense.find(1000), nullptr);
+
+    const auto sparse = CANdb::makeValueTable(
+        { { 0, "OFF" }, { 100000, "FAR" }, { 0, "DUPLICATE" } }, 32);
+    EXPECT_TRUE(sparse.dense.empty());
+    ASSERT_EQ(sparse.entries.size(), 2);
+    EXPECT_EQ(*sparse.find(0), "OFF");
+    EXPECT_EQ(*sparse.find(100000), "FAR");
+    EXPECT_EQ(sparse.find(5), nullptr);
+}
+
 // test case instantiations
 
 INSTANTIATE_TEST_CASE_P(Ecus, EcusTest,
@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+
+#include "decoder.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+CANsignal makeSignal(const std::string& name, std::uint8_t startBit,
+    std::uint8_t size, std::uint8_t byteOrder, const std::string& sign = "+")
+{
+    return CANsignal{ name, startBit, size, byteOrder, sign, 1, 0, 0, 0, "",
+        "NEO" };
+}
+
+// Same layouts as GTW_epasControl and DAS_steeringControl from tesla_can.dbc
+CANdb_t makeDb()
+{
+    CANdb_t db;
+    db.messages[CANmessage{ 257, "GTW_epasControl", 3, "NEO" }] = {
+        makeSignal("GTW_epasControlChecksum", 16, 8, 1),
+        makeSignal("GTW_epasControlCounter", 12, 4, 1),
+        makeSignal("GTW_epasControlType", 8, 2, 1),
+        makeSignal("GTW_epasEmergencyOn", 0, 1, 1),
+    };
+    db.messages[CANmessage{ 1160, "DAS_steeringControl", 4, "NEO" }] = {
+        makeSignal("DAS_steeringControlType", 23, 2, 0),
+        makeSignal("DAS_steeringControlChecksum", 31, 8, 0),
+        makeSignal("DAS_steeringAngleRequest", 6, 15, 0, "-"),
+        makeSignal("DAS_steeringHapticRequest", 7, 1, 0),
+    };
+    return db;
+}
+
+using Decoded = std::map<std::string, std::uint64_t>;
+} // namespace
+
+struct DecoderTests : public ::testing::Test {
+    CANdb_t db{ makeDb() };
+    Decoded decoded;
+
+    std::size_t decode(CANdb::Decoder& decoder, std::uint32_t id,
+        std::vector<std::uint8_t> payload)
+    {
+        decoded.clear();
+        return decoder.decode(id, payload.data(), payload.size(),
+            [this](const CANmessage&, const CANsignal& sig, std::uint64_t raw) {
+                decoded[sig.signal_name] = raw;
+            });
+    }
+};
+
+TEST_F(DecoderTests, signal_mask)
+{
+    const auto intel = CANdb::signalMask(makeSignal("a", 12, 4, 1));
+    EXPECT_EQ(intel[0], 0xF000u);
+
+    // Motorola: MSB at bit 6 of byte 0, LSB at bit 0 of byte 1
+    const auto motorola = CANdb::signalMask(makeSignal("b", 6, 15, 0));
+    EXPECT_EQ(motorola[0], 0xFF7Fu);
+    EXPECT_EQ(motorola[1], 0u);
+}
+
+TEST_F(DecoderTests, extract_raw)
+{
+    const std::uint8_t payload[] = { 0x81, 0xA2, 0x5C, 0xC0 };
+
+    EXPECT_EQ(CANdb::extractRaw(makeSignal("a", 16, 8, 1), payload, 4), 0x5Cu);
+    EXPECT_EQ(CANdb::extractRaw(makeSignal("a", 12, 4, 1), payload, 4), 0xAu);
+    EXPECT_EQ(CANdb::extractRaw(makeSignal("a", 6, 15, 0), payload, 4), 0x01A2u);
+    EXPECT_EQ(CANdb::extractRaw(makeSignal("a", 23, 2, 0), payload, 4), 1u);
+    // Bits past the end of the payload read as zero
+    EXPECT_EQ(CANdb::extractRaw(makeSignal("a", 40, 8, 1), payload, 4), 0u);
+}
+
+TEST_F(DecoderTests, to_physical_sign_extends)
+{
+    const auto sig = makeSignal("a", 0, 4, 1, "-");
+    EXPECT_EQ(CANdb::toPhysical(sig, 0xF), -1.0);
+    EXPECT_EQ(CANdb::toPhysical(sig, 0x7), 7.0);
+}
+
+TEST_F(DecoderTests, full_mode_decodes_every_frame)
+{
+    CANdb::Decoder decoder{ db };
+
+    EXPECT_EQ(decode(decoder, 257, { 0x01, 0x32, 0x7F }), 4u);
+    EXPECT_EQ(decoded["GTW_epasControlChecksum"], 0x7Fu);
+    EXPECT_EQ(decoded["GTW_epasControlCounter"], 3u);
+    EXPECT_EQ(decoded["GTW_epasControlType"], 2u);
+    EXPECT_EQ(decoded["GTW_epasEmergencyOn"], 1u);
+
+    EXPECT_EQ(decode(decoder, 257, { 0x01, 0x32, 0x7F }), 4u);
+    EXPECT_EQ(decode(decoder, 42, { 0x01 }), 0u);
+
+    EXPECT_EQ(decoder.stats().frames, 3u);
+    EXPECT_EQ(decoder.stats().unknownFrames, 1u);
+    EXPECT_EQ(decoder.stats().signalsDecoded, 8u);
+}
+
+TEST_F(DecoderTests, change_detection_skips_unchanged_payloads)
+{
+    CANdb::Decoder decoder{ db, CANdb::Decoder::Mode::ChangeDetection };
+
+    EXPECT_EQ(decode(decoder, 257, { 0x01, 0x32, 0x7F }), 4u);
+    EXPECT_EQ(decode(decoder, 257, { 0x01, 0x32, 0x7F }), 0u);
+    EXPECT_TRUE(decoded.empty());
+
+    // Only the counter nibble changed
+    EXPECT_EQ(decode(decoder, 257, { 0x01, 0x42, 0x7F }), 1u);
+    ASSERT_EQ(decoded.size(), 1u);
+    EXPECT_EQ(decoded["GTW_epasControlCounter"], 4u);
+
+    // Counter and checksum changed
+    EXPECT_EQ(decode(decoder, 257, { 0x01, 0x52, 0x80 }), 2u);
+    EXPECT_EQ(decoded["GTW_epasControlCounter"], 5u);
+    EXPECT_EQ(decoded["GTW_epasControlChecksum"], 0x80u);
+
+    const auto& stats = decoder.stats();
+    EXPECT_EQ(stats.frames, 4u);
+    EXPECT_EQ(stats.unchangedFrames, 1u);
+    EXPECT_EQ(stats.signalsDecoded, 7u);
+    EXPECT_EQ(stats.signalsSkipped, 9u);
+}
+
+TEST_F(DecoderTests, change_detection_tracks_ids_separately)
+{
+    CANdb::Decoder decoder{ db, CANdb::Decoder::Mode::ChangeDetection };
+
+    EXPECT_EQ(decode(decoder, 257, { 0x01, 0x32, 0x7F }), 4u);
+    EXPECT_EQ(decode(decoder, 1160, { 0x01, 0x32, 0x7F, 0x00 }), 4u);
+    EXPECT_EQ(decode(decoder, 1160, { 0x01, 0x33, 0x7F, 0x00 }), 1u);
+    EXPECT_EQ(decoded.count("DAS_steeringAngleRequest"), 1u);
+
+    // A length change or a reset forces a full decode
+    EXPECT_EQ(decode(decoder, 257, { 0x01, 0x32 }), 4u);
+    decoder.reset();
+    EXPECT_EQ(decode(decoder, 257, { 0x01, 0x32 }), 4u);
+}
+
+TEST_F(DecoderTests, change_detection_survives_copies)
+{
+    CANdb::Decoder decoder{ db, CANdb::Decoder::Mode::ChangeDetection };
+    EXPECT_EQ(decode(decoder, 257, { 0x01, 0x32, 0x7F }), 4u);
+    EXPECT_EQ(decode(decoder, 1160, { 0x01, 0x32, 0x7F, 0x00 }), 4u);
+
+    // Copies compare against the payloads seen before they were made
+    std::vector<CANdb::Decoder> copies(5, decoder);
+    for (auto& copy : copies) {
+        EXPECT_EQ(decode(copy, 257, { 0x01, 0x32, 0x7F }), 0u);
+        EXPECT_EQ(decode(copy, 1160, { 0x01, 0x33, 0x7F, 0x00 }), 1u);
+        EXPECT_EQ(decoded.count("DAS_steeringAngleRequest"), 1u);
+    }
+    EXPECT_EQ(decode(decoder, 1160, { 0x01, 0x32, 0x7F, 0x00 }), 0u);
+}
+
+TEST_F(DecoderTests, change_detection_fd_payload)
+{
+    CANdb_t fd;
+    fd.messages[CANmessage{ 0x100, "FD_frame", 64, "NEO" }]
+        = { makeSignal("low", 0, 8, 1), makeSignal("high", 248, 8, 1) };
+    CANdb::Decoder decoder{ fd, CANdb::Decoder::Mode::ChangeDetection };
+
+    std::vector<std::uint8_t> payload(64, 0);
+    EXPECT_EQ(decode(decoder, 0x100, payload), 2u);
+    EXPECT_EQ(decode(decoder, 0x100, payload), 0u);
+
+    payload[31] = 0xAB;
+    EXPECT_EQ(decode(decoder, 0x100, payload), 1u);
+    EXPECT_EQ(decoded["high"], 0xABu);
+
+    // Changes outside of any signal are detected but emit nothing
+    payload[40] = 0x01;
+    EXPECT_EQ(decode(decoder, 0x100, payload), 0u);
+    EXPECT_EQ(decoder.stats().unchangedFrames, 1u);
+}
+
+TEST_F(DecoderTests, multiplexed_groups)
+{
+    CANdb_t mux;
+    auto& signals = mux.messages[CANmessage{ 0x200, "MUX", 8, "NEO" }];
+    signals = { makeSignal("mode", 0, 8, 1), makeSignal("a", 8, 8, 1),
+        makeSignal("b", 8, 8, 1), makeSignal("c", 16, 8, 1),
+        makeSignal("plain", 24, 8, 1) };
+    signals[0].multiplexer = "M";
+    signals[1].multiplexer = "m0";
+    signals[2].multiplexer = "m1";
+    signals[3].multiplexer = "m1M";
+
+    CANdb::Decoder full{ mux };
+    EXPECT_EQ(decode(full, 0x200, { 0, 5, 6, 7 }), 3u);
+    EXPECT_EQ(decoded, (Decoded{ { "mode", 0 }, { "a", 5 }, { "plain", 7 } }));
+    EXPECT_EQ(decode(full, 0x200, { 1, 5, 6, 7 }), 4u);
+    EXPECT_EQ(decoded,
+        (Decoded{ { "mode", 1 }, { "b", 5 }, { "c", 6 }, { "plain", 7 } }));
+    EXPECT_EQ(decode(full, 0x200, { 2, 5, 6, 7 }), 2u);
+
+    CANdb::Decoder changes{ mux, CANdb::Decoder::Mode::ChangeDetection };
+    EXPECT_EQ(decode(changes, 0x200, { 0, 5, 6, 7 }), 3u);
+    // Bits of group 1 changed while group 0 is sent
+    EXPECT_EQ(decode(changes, 0x200, { 0, 5, 9, 7 }), 0u);
+    // A new switch value sends the whole group
+    EXPECT_EQ(decode(changes, 0x200, { 1, 5, 9, 7 }), 4u);
+    EXPECT_EQ(decode(changes, 0x200, { 1, 8, 9, 7 }), 1u);
+    EXPECT_EQ(decoded, (Decoded{ { "b", 8 } }));
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+#include "dbcparser.h"
+#include "embedded_db.h"
+#include "log.hpp"
+
+CANDB_DECLARE_EMBEDDED_DBC(tesla_can)
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+std::string loadDBCFile(const std::string& filename)
+{
+    std::ifstream file{ std::string{ OPENDBC_DIR } + filename,
+        std::ios::binary };
+    return std::string{ std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>() };
+}
+
+std::string str(std::string_view s) { return std::string(s); }
+} // namespace
+
+struct EmbeddedDbTests : public ::testing::Test {
+    void SetUp() override
+    {
+        ASSERT_TRUE(parser.parse(loadDBCFile("tesla_can.dbc")));
+    }
+
+    CANdb::DBCParser parser;
+    const CANdb::EmbeddedDb& embedded{ CANdb::embedded::tesla_can() };
+};
+
+TEST_F(EmbeddedDbTests, matches_parser)
+{
+    const auto expected = parser.getDb();
+    EXPECT_EQ(str(embedded.version), expected.version);
+    ASSERT_EQ(embedded.ecus.size(), expected.ecus.size());
+    for (std::size_t i = 0; i < embedded.ecus.size(); ++i) {
+        EXPECT_EQ(str(embedded.ecus[i]), expected.ecus[i]);
+    }
+    ASSERT_EQ(embedded.symbols.size(), expected.symbols.size());
+
+    ASSERT_EQ(embedded.messages.size(), expected.messages.size());
+    auto parsed = expected.messages.begin();
+    for (const auto& msg : embedded.messages) {
+        EXPECT_EQ(msg.first.id, parsed->first.id);
+        EXPECT_EQ(str(msg.first.name), parsed->first.name);
+        EXPECT_EQ(msg.first.dlc, parsed->first.dlc);
+        EXPECT_EQ(str(msg.first.ecu), parsed->first.ecu);
+        ASSERT_EQ(msg.second.size(), parsed->second.size());
+        for (std::size_t i = 0; i < msg.second.size(); ++i) {
+            const auto& sig = msg.second[i];
+            const auto& parsedSig = parsed->second[i];
+            EXPECT_EQ(str(sig.signal_name), parsedSig.signal_name);
+            EXPECT_EQ(sig.startBit, parsedSig.startBit);
+            EXPECT_EQ(sig.signalSize, parsedSig.signalSize);
+            EXPECT_EQ(sig.byteOrder, parsedSig.byteOrder);
+            EXPECT_EQ(str(sig.value_type), parsedSig.value_type);
+            EXPECT_EQ(sig.factor, parsedSig.factor);
+            EXPECT_EQ(sig.offset, parsedSig.offset);
+            EXPECT_EQ(sig.min, parsedSig.min);
+            EXPECT_EQ(sig.max, parsedSig.max);
+            EXPECT_EQ(str(sig.unit), parsedSig.unit);
+            EXPECT_EQ(str(sig.receiver), parsedSig.receiver);
+            EXPECT_EQ(sig.type, parsedSig.type);
+            EXPECT_EQ(str(sig.multiplexer), parsedSig.multiplexer);
+
+            ASSERT_EQ(sig.values.size(), parsedSig.values.entries.size());
+            for (const auto& v : parsedSig.values.entries) {
+                EXPECT_EQ(str(sig.describe(v.raw)), v.description);
+            }
+        }
+        ++parsed;
+    }
+}
+
+TEST_F(EmbeddedDbTests, find)
+{
+    const auto& messages = embedded.messages;
+    for (const auto& msg : parser.getDb().messages) {
+        const auto it = messages.find(msg.first);
+        ASSERT_NE(it, messages.end());
+        EXPECT_EQ(it->first.id, msg.first.id);
+        EXPECT_EQ(messages.count(msg.first.id), 1u);
+        EXPECT_EQ(messages.at(msg.first.id).size(), msg.second.size());
+    }
+
+    EXPECT_EQ(messages.find(0x7FF), messages.end());
+    EXPECT_EQ(messages.find(0x1FFFFFFF), messages.end());
+    EXPECT_EQ(messages.count(0x1FFFFFFF), 0u);
+    EXPECT_THROW(messages.at(0x1FFFFFFF), std::out_of_range);
+}
+
+TEST_F(EmbeddedDbTests, to_database)
+{
+    const auto expected = parser.getDb();
+    const auto db = CANdb::toDatabase(embedded);
+    EXPECT_EQ(db.version, expected.version);
+    EXPECT_EQ(db.ecus, expected.ecus);
+    EXPECT_EQ(db.symbols, expected.symbols);
+
+    ASSERT_EQ(db.messages.size(), expected.messages.size());
+    auto parsed = expected.messages.begin();
+    for (const auto& msg : db.messages) {
+        EXPECT_EQ(msg.first.id, parsed->first.id);
+        EXPECT_EQ(msg.first.name, parsed->first.name);
+        EXPECT_EQ(msg.second, parsed->second);
+        for (std::size_t i = 0; i < msg.second.size(); ++i) {
+            EXPECT_EQ(msg.second[i].values.entries.size(),
+                parsed->second[i].values.entries.size());
+        }
+        ++parsed;
+    }
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+#include "alloc_counter.h"
+#include "dbcparser.h"
+#include "footprint.h"
+#include "log.hpp"
+
+CANDB_COUNTING_OPERATOR_NEW
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+std::string loadDBCFile(const std::string& filename)
+{
+    const std::string path = std::string{ OPENDBC_DIR } + filename;
+
+    std::fstream file{ path.c_str() };
+
+    std::string buff;
+    std::copy(std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>(), std::back_inserter(buff));
+
+    file.close();
+    return buff;
+}
+
+const std::string kLongName = "A_signal_name_longer_than_any_sso_buffer";
+} // namespace
+
+TEST(FootprintTests, accounting)
+{
+    CANdb_t db;
+    db.ecus = { "NEO", kLongName };
+
+    std::vector<CANsignal> signals(2);
+    signals[0].signal_name = kLongName;
+    signals[1].signal_name = "short";
+    signals[1].values.entries.push_back(CANvalueDescription{ 1, kLongName });
+    signals[1].values.dense.assign(2, 0);
+    db.messages[CANmessage{ 1, "MSG", 8, "NEO" }] = signals;
+    db.messages[CANmessage{ 2, "MSG2", 8, "NEO" }] = {};
+
+    const auto fp = CANdb::footprint(db);
+    EXPECT_EQ(fp.database, sizeof(CANdb_t));
+    EXPECT_EQ(fp.messageNodes,
+        2 * (sizeof(decltype(db.messages)::value_type) + 4 * sizeof(void*)));
+    EXPECT_EQ(fp.signalVectors,
+        db.messages.at(CANmessage{ 1 }).capacity() * sizeof(CANsignal));
+    EXPECT_EQ(fp.valueTables,
+        sizeof(CANvalueDescription) + 2 * sizeof(std::uint32_t));
+    EXPECT_EQ(fp.symbols, db.ecus.capacity() * sizeof(std::string));
+
+    // version, 2 x (name, ecu), 2 x 5 signal strings, description, 2 ecus
+    EXPECT_EQ(fp.strings, 1u + 4 + 10 + 1 + 2);
+    EXPECT_EQ(fp.heapStrings, 3u);
+    EXPECT_EQ(fp.stringHeap, 3 * (kLongName.capacity() + 1));
+    EXPECT_EQ(fp.total(),
+        fp.database + fp.messageNodes + fp.signalVectors + fp.valueTables
+            + fp.symbols + fp.stringHeap);
+}
+
+TEST(FootprintTests, allocation_scope)
+{
+    ASSERT_TRUE(CANdb::alloc::hooksInstalled());
+
+    CANdb::AllocationScope scope;
+    {
+        std::vector<int> v(1000);
+        v.resize(2000);
+    }
+    EXPECT_GE(scope.peakBytes(), 3000 * sizeof(int));
+    EXPECT_GE(scope.allocations(), 2u);
+    EXPECT_LT(scope.peakBytes(), 4000 * sizeof(int));
+}
+
+struct FootprintBudget {
+    const char* file;
+    std::size_t maxBytes;
+    std::size_t maxBytesPerSignal;
+};
+
+struct OpenDBCFootprintTest : public ::testing::TestWithParam<FootprintBudget> {
+};
+
+// Budgets pin the current layout with some headroom, growing them needs a
+// reason
+TEST_P(OpenDBCFootprintTest, within_budget)
+{
+    const auto budget = GetParam();
+    const auto data = loadDBCFile(budget.file);
+
+    CANdb::DBCParser parser;
+    CANdb::AllocationScope scope;
+    ASSERT_TRUE(parser.parse(data));
+    const auto parsePeak = scope.peakBytes();
+
+    const auto db = parser.getDb();
+    std::size_t signals = 0;
+    for (const auto& msg : db.messages) {
+        signals += msg.second.size();
+    }
+    ASSERT_GT(signals, 0u);
+
+    const auto fp = CANdb::footprint(db);
+    EXPECT_LE(fp.total(), budget.maxBytes) << budget.file;
+    EXPECT_LE(fp.total() / signals, budget.maxBytesPerSignal) << budget.file;
+    EXPECT_EQ(fp.signalVectors, signals * sizeof(CANsignal));
+
+    // The parse holds the database plus the grammar and the input copy
+    EXPECT_GT(parsePeak, fp.total());
+}
+
+INSTANTIATE_TEST_CASE_P(OpenDBC, OpenDBCFootprintTest,
+    ::testing::Values(FootprintBudget{ "tesla_can.dbc", 256 * 1024, 640 },
+        FootprintBudget{ "toyota_prius_2017_can0.dbc", 384 * 1024, 640 },
+        FootprintBudget{ "honda_civic_touring_2016_can.dbc", 512 * 1024, 640 }));
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include "id_filter.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+struct IdFilterTests : public ::testing::Test {
+    CANdb_t db;
+
+    IdFilterTests()
+    {
+        db.messages[CANmessage{ 257, "GTW_epasControl", 3, "GTW" }] = {};
+        db.messages[CANmessage{ 880, "EPAS_sysStatus", 8, "EPAS" }] = {};
+        db.messages[CANmessage{ 1160, "DAS_steeringControl", 4, "NEO" }] = {};
+        db.messages[CANmessage{ 0x80000000 | 0x18FEF100, "CCVS", 8, "ECM" }]
+            = {};
+    }
+};
+
+TEST_F(IdFilterTests, empty_filter_rejects_everything)
+{
+    const CANdb::IdFilter filter{ CANdb::FilterPredicates{}, db };
+    for (const auto& msg : db.messages) {
+        EXPECT_FALSE(filter.accepts(msg.first));
+    }
+    EXPECT_FALSE(filter.accepts(0, false));
+    EXPECT_FALSE(filter.accepts(0, true));
+}
+
+TEST_F(IdFilterTests, ranges_and_masks)
+{
+    CANdb::FilterPredicates predicates;
+    predicates.ranges.push_back(CANdb::IdRange{ 0x100, 0x1FF, false });
+    predicates.ranges.push_back(CANdb::IdRange{ 0x1000, 0x1FFF, true });
+    predicates.ranges.push_back(CANdb::IdRange{ 0x1800, 0x2FFF, true });
+    predicates.masks.push_back(CANdb::IdMask{ 0x700, 0x7F0, false });
+    predicates.masks.push_back(CANdb::IdMask{ 0x00FEF100, 0x00FFFF00, true });
+    const CANdb::IdFilter filter{ predicates, db };
+
+    EXPECT_TRUE(filter.accepts(0x100, false));
+    EXPECT_TRUE(filter.accepts(0x1FF, false));
+    EXPECT_FALSE(filter.accepts(0x200, false));
+    EXPECT_TRUE(filter.accepts(0x70F, false));
+    EXPECT_FALSE(filter.accepts(0x710, false));
+    EXPECT_FALSE(filter.accepts(0x4000, false));
+
+    // extended ranges are merged
+    EXPECT_TRUE(filter.accepts(0x1000, true));
+    EXPECT_TRUE(filter.accepts(0x2FFF, true));
+    EXPECT_FALSE(filter.accepts(0x3000, true));
+    EXPECT_FALSE(filter.accepts(0x100, true));
+    EXPECT_TRUE(filter.accepts(0x18FEF1AB, true));
+    EXPECT_FALSE(filter.accepts(0x18FEF2AB, true));
+
+    CANdb::FrameRecord frame{};
+    frame.id = 0x18FEF100;
+    frame.flags = CANdb::kFrameExtendedId;
+    EXPECT_TRUE(filter.accepts(frame));
+}
+
+TEST_F(IdFilterTests, ecus_and_name_patterns)
+{
+    CANdb::FilterPredicates predicates;
+    predicates.ecus.push_back("NEO");
+    predicates.ecus.push_back("ECM");
+    predicates.namePatterns.push_back("GTW_.*");
+    const CANdb::IdFilter filter{ predicates, db };
+
+    EXPECT_TRUE(filter.accepts(CANmessage{ 257 }));
+    EXPECT_FALSE(filter.accepts(CANmessage{ 880 }));
+    EXPECT_TRUE(filter.accepts(CANmessage{ 1160 }));
+    EXPECT_TRUE(filter.accepts(CANmessage{ 0x80000000 | 0x18FEF100 }));
+    EXPECT_TRUE(filter.accepts(0x18FEF100, true));
+    EXPECT_FALSE(filter.accepts(0x18FEF100 & 0x7FF, false));
+}
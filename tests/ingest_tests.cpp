@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include "ingest.h"
+#include "log.hpp"
+
+#include <cstring>
+#include <numeric>
+#include <unistd.h>
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+CANdb::FrameRecord makeFrame(std::uint32_t id, std::uint64_t seq)
+{
+    CANdb::FrameRecord frame{};
+    frame.timestamp = seq;
+    frame.id = id;
+    frame.dlc = 8;
+    std::memcpy(frame.payload, &seq, sizeof(seq));
+    return frame;
+}
+
+// Vector source that hands frames out in small chunks
+struct VectorSource : public CANdb::FrameSource {
+    std::vector<CANdb::FrameRecord> frames;
+    std::size_t pos{ 0 };
+
+    std::size_t read(CANdb::FrameRecord* out, std::size_t max) override
+    {
+        const auto count = std::min<std::size_t>({ max, 7, frames.size() - pos });
+        std::copy(frames.begin() + pos, frames.begin() + pos + count, out);
+        pos += count;
+        return count;
+    }
+};
+} // namespace
+
+TEST(SpscRingTests, push_pop_wraps_around)
+{
+    CANdb::SpscRing<int> ring{ 5 };
+    ASSERT_EQ(ring.capacity(), 8u);
+
+    std::vector<int> in(8);
+    std::iota(in.begin(), in.end(), 0);
+    std::vector<int> out(8);
+
+    for (int round = 0; round < 3; ++round) {
+        EXPECT_EQ(ring.push(in.data(), 6), 6u);
+        EXPECT_EQ(ring.pop(out.data(), 4), 4u);
+        EXPECT_EQ(out[3], 3);
+        EXPECT_EQ(ring.pop(out.data(), 8), 2u);
+        EXPECT_EQ(out[1], 5);
+    }
+
+    EXPECT_EQ(ring.push(in.data(), 8), 8u);
+    EXPECT_FALSE(ring.push(42));
+    int v = -1;
+    EXPECT_TRUE(ring.pop(v));
+    EXPECT_EQ(v, 0);
+}
+
+TEST(SpscRingTests, concurrent_order_is_preserved)
+{
+    constexpr std::uint64_t count = 200000;
+    CANdb::SpscRing<std::uint64_t> ring{ 64 };
+
+    std::thread producer{ [&ring]() {
+        for (std::uint64_t i = 0; i < count;) {
+            if (ring.push(i)) {
+                ++i;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    } };
+
+    std::uint64_t expected = 0;
+    std::uint64_t buff[16];
+    while (expected < count) {
+        const auto n = ring.pop(buff, 16);
+        if (n == 0) {
+            std::this_thread::yield();
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            ASSERT_EQ(buff[i], expected++);
+        }
+    }
+    producer.join();
+}
+
+TEST(IngestPipelineTests, consumes_every_frame_in_order)
+{
+    VectorSource source;
+    for (std::uint64_t i = 0; i < 10000; ++i) {
+        source.frames.push_back(makeFrame(257, i));
+    }
+
+    std::vector<std::uint64_t> seen;
+    CANdb::IngestPipeline pipeline{ source,
+        [&seen](const CANdb::FrameRecord* frames, std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i) {
+                seen.push_back(frames[i].timestamp);
+            }
+        },
+        16, 8 };
+    pipeline.start();
+    pipeline.join();
+
+    ASSERT_EQ(seen.size(), source.frames.size());
+    for (std::size_t i = 0; i < seen.size(); ++i) {
+        ASSERT_EQ(seen[i], i);
+    }
+    EXPECT_EQ(pipeline.stats().frames, seen.size());
+}
+
+TEST(IngestPipelineTests, decodes_frames_from_pipe)
+{
+    CANdb_t db;
+    db.messages[CANmessage{ 257, "GTW_epasControl", 8, "NEO" }]
+        = { CANsignal{ "counter", 0, 8, 1, "+", 1, 0, 0, 0, "", "NEO" } };
+    CANdb::Decoder decoder{ db, CANdb::Decoder::Mode::ChangeDetection };
+
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    CANdb::FdFrameSource source{ fds[0] };
+
+    std::uint64_t sum = 0;
+    CANdb::IngestPipeline pipeline{ source,
+        CANdb::makeDecodingConsumer(decoder,
+            [&sum](const CANmessage&, const CANsignal&, std::uint64_t raw) {
+                sum += raw;
+            }) };
+    pipeline.start();
+
+    std::thread writer{ [&fds]() {
+        std::vector<CANdb::FrameRecord> frames;
+        for (std::uint64_t i = 0; i < 1000; ++i) {
+            // every value is sent twice, the repeat is not decoded
+            frames.push_back(makeFrame(257, i / 2));
+            frames.push_back(makeFrame(42, i));
+        }
+        CANdb::writeFrames(fds[1], frames.data(), frames.size());
+        close(fds[1]);
+    } };
+    writer.join();
+    pipeline.join();
+    close(fds[0]);
+
+    EXPECT_EQ(pipeline.stats().frames, 2000u);
+    EXPECT_EQ(decoder.stats().unknownFrames, 1000u);
+    EXPECT_EQ(decoder.stats().unchangedFrames, 500u);
+    // Only the first frame of every value pair is decoded
+    std::uint64_t expected = 0;
+    for (std::uint64_t i = 0; i < 500; ++i) {
+        expected += i & 0xFF;
+    }
+    EXPECT_EQ(sum, expected);
+}
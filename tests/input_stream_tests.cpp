@@ -0,0 +1,244 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include "dbc_generator.h"
+#include "dbcparser.h"
+#include "ingest.h"
+#include "input_stream.h"
+#include "log.hpp"
+#include "stream_writer.h"
+
+#if CANDB_HAS_ZLIB
+#include <zlib.h>
+#endif
+#if CANDB_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+#include <unistd.h>
+
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+class TempFile {
+public:
+    explicit TempFile(const std::string& data)
+    {
+        char path[] = "/tmp/candb_inputXXXXXX";
+        const auto fd = ::mkstemp(path);
+        ::close(fd);
+        _path = path;
+        std::ofstream{ _path, std::ios::binary } << data;
+    }
+    ~TempFile() { std::remove(_path.c_str()); }
+
+    const std::string& path() const { return _path; }
+
+private:
+    std::string _path;
+};
+
+// Reads in odd sized pieces to cross chunk boundaries
+std::string readPieces(CANdb::InputStream& input, std::size_t piece)
+{
+    std::string out;
+    std::string buffer(piece, '\0');
+    while (const auto n = input.read(&buffer[0], buffer.size())) {
+        out.append(buffer, 0, n);
+    }
+    return out;
+}
+
+std::string sample()
+{
+    CANdb::GeneratorOptions options;
+    options.messages = 200;
+    options.commentRatio = 0.5;
+    options.crlf = true;
+    return CANdb::generateDbc(options);
+}
+
+#if CANDB_HAS_ZLIB
+std::string gzip(const std::string& data)
+{
+    z_stream z{};
+    // 15 window bits plus 16 writes a gzip header
+    deflateInit2(&z, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+    std::string out(deflateBound(&z, data.size()) + 32, '\0');
+    z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    z.avail_in = static_cast<uInt>(data.size());
+    z.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    z.avail_out = static_cast<uInt>(out.size());
+    deflate(&z, Z_FINISH);
+    out.resize(z.total_out);
+    deflateEnd(&z);
+    return out;
+}
+#endif
+} // namespace
+
+TEST(InputStreamTests, detect)
+{
+    EXPECT_EQ(CANdb::detectCompression("\x1f\x8b\x08", 3),
+        CANdb::Compression::Gzip);
+    EXPECT_EQ(CANdb::detectCompression("\x28\xb5\x2f\xfd", 4),
+        CANdb::Compression::Zstd);
+    EXPECT_EQ(CANdb::detectCompression("\x28\xb5", 2),
+        CANdb::Compression::None);
+    EXPECT_EQ(CANdb::detectCompression("VERSION", 7), CANdb::Compression::None);
+}
+
+TEST(InputStreamTests, plain_file)
+{
+    const auto data = sample();
+    TempFile file{ data };
+
+    auto input = CANdb::openInput(file.path());
+    EXPECT_EQ(input->sizeHint(), data.size());
+    EXPECT_EQ(readPieces(*input, 1000), data);
+
+    TempFile empty{ "" };
+    EXPECT_EQ(CANdb::readAll(*CANdb::openInput(empty.path())), "");
+    EXPECT_THROW(CANdb::openInput(file.path() + ".missing"),
+        std::runtime_error);
+}
+
+#if CANDB_HAS_ZLIB
+TEST(InputStreamTests, gzip)
+{
+    const auto data = sample();
+    TempFile file{ gzip(data) };
+
+    auto input = CANdb::openInput(file.path());
+    EXPECT_EQ(readPieces(*input, 777), data);
+    EXPECT_EQ(CANdb::readAll(*CANdb::openInput(file.path())), data);
+
+    // Small chunks keep the decompressor waiting for input mid-stream
+    const auto compressed = gzip(data);
+    CANdb::GzipInputStream small{
+        std::make_unique<CANdb::MemoryInputStream>(
+            compressed.data(), compressed.size()),
+        13 };
+    EXPECT_EQ(readPieces(small, 4096), data);
+}
+
+TEST(InputStreamTests, gzip_members)
+{
+    const auto compressed = gzip("first\n") + gzip("") + gzip("second\n");
+    CANdb::GzipInputStream input{ std::make_unique<CANdb::MemoryInputStream>(
+        compressed.data(), compressed.size()) };
+    EXPECT_EQ(CANdb::readAll(input), "first\nsecond\n");
+}
+
+TEST(InputStreamTests, gzip_errors)
+{
+    const auto compressed = gzip(sample());
+    const auto truncated = compressed.substr(0, compressed.size() / 2);
+    CANdb::GzipInputStream input{ std::make_unique<CANdb::MemoryInputStream>(
+        truncated.data(), truncated.size()) };
+    EXPECT_THROW(CANdb::readAll(input), std::runtime_error);
+
+    auto corrupt = compressed;
+    corrupt[corrupt.size() / 2] ^= 0x55;
+    corrupt[corrupt.size() / 2 + 1] ^= 0x55;
+    CANdb::GzipInputStream bad{ std::make_unique<CANdb::MemoryInputStream>(
+        corrupt.data(), corrupt.size()) };
+    EXPECT_THROW(CANdb::readAll(bad), std::runtime_error);
+}
+
+TEST(InputStreamTests, parse_gzip)
+{
+    const auto data = sample();
+    TempFile file{ gzip(data) };
+
+    CANdb::DBCParser plain;
+    ASSERT_TRUE(plain.parse(data));
+    CANdb::DBCParser compressed;
+    ASSERT_TRUE(compressed.parse(*CANdb::openInput(file.path())));
+    CANdb::OutputBuffer expected;
+    CANdb::writeJson(plain.getDb(), expected);
+    CANdb::OutputBuffer actual;
+    CANdb::writeJson(compressed.getDb(), actual);
+    EXPECT_EQ(actual.str(), expected.str());
+
+    const auto gz = gzip(data);
+    const auto truncated = gz.substr(0, gz.size() - 10);
+    CANdb::GzipInputStream input{ std::make_unique<CANdb::MemoryInputStream>(
+        truncated.data(), truncated.size()) };
+    EXPECT_FALSE(compressed.parse(input));
+    ASSERT_EQ(compressed.diagnostics().size(), 1u);
+    EXPECT_EQ(compressed.diagnostics().front().line, 0u);
+}
+
+TEST(InputStreamTests, frames_from_gzip)
+{
+    std::vector<CANdb::FrameRecord> frames(1000);
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        frames[i] = CANdb::FrameRecord{};
+        frames[i].timestamp = i;
+        frames[i].id = static_cast<std::uint32_t>(i % 2048);
+        frames[i].dlc = 8;
+        frames[i].payload[0] = static_cast<std::uint8_t>(i);
+    }
+    TempFile file{ gzip(std::string(reinterpret_cast<const char*>(
+                                        frames.data()),
+        frames.size() * sizeof(CANdb::FrameRecord))) };
+
+    auto input = CANdb::openInput(file.path());
+    CANdb::StreamFrameSource source{ *input };
+    std::vector<CANdb::FrameRecord> read;
+    CANdb::FrameRecord batch[37];
+    while (const auto n = source.read(batch, 37)) {
+        read.insert(read.end(), batch, batch + n);
+    }
+    ASSERT_EQ(read.size(), frames.size());
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        EXPECT_EQ(read[i].timestamp, i);
+        EXPECT_EQ(read[i].payload[0], static_cast<std::uint8_t>(i));
+    }
+}
+#endif
+
+#if CANDB_HAS_ZSTD
+TEST(InputStreamTests, zstd)
+{
+    const auto data = sample();
+    std::string compressed(ZSTD_compressBound(data.size()), '\0');
+    compressed.resize(ZSTD_compress(
+        &compressed[0], compressed.size(), data.data(), data.size(), 3));
+    TempFile file{ compressed + compressed };
+
+    auto input = CANdb::openInput(file.path());
+    EXPECT_EQ(readPieces(*input, 777), data + data);
+
+    const auto truncated = compressed.substr(0, compressed.size() - 3);
+    CANdb::ZstdInputStream bad{ std::make_unique<CANdb::MemoryInputStream>(
+        truncated.data(), truncated.size()) };
+    EXPECT_THROW(CANdb::readAll(bad), std::runtime_error);
+}
+#endif
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include "layout_check.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+CANsignal makeSignal(const std::string& name, std::uint8_t startBit,
+    std::uint8_t size, std::uint8_t byteOrder)
+{
+    return CANsignal{ name, startBit, size, byteOrder, "+", 1, 0, 0, 0, "",
+        "NEO" };
+}
+
+CANsignal multiplexed(const std::string& name, std::uint8_t startBit,
+    std::uint8_t size, const std::string& multiplexer)
+{
+    auto sig = makeSignal(name, startBit, size, 1);
+    sig.multiplexer = multiplexer;
+    return sig;
+}
+
+using Kind = CANdb::LayoutIssue::Kind;
+} // namespace
+
+struct LayoutCheckTests : public ::testing::Test {
+    CANdb_t db;
+
+    std::vector<CANdb::LayoutIssue> check(
+        std::uint32_t dlc, std::vector<CANsignal> signals)
+    {
+        db.messages[CANmessage{ 100, "MSG", dlc, "NEO" }] = signals;
+        return CANdb::checkLayout(db);
+    }
+};
+
+TEST_F(LayoutCheckTests, clean_layout)
+{
+    EXPECT_TRUE(check(4,
+        { makeSignal("a", 0, 8, 1), makeSignal("b", 8, 4, 1),
+            makeSignal("c", 23, 12, 0), makeSignal("d", 27, 4, 0) })
+                    .empty());
+}
+
+TEST_F(LayoutCheckTests, overlap)
+{
+    const auto issues = check(
+        8, { makeSignal("a", 0, 8, 1), makeSignal("b", 4, 8, 1),
+               makeSignal("c", 7, 8, 0) });
+    ASSERT_EQ(issues.size(), 3u);
+
+    EXPECT_EQ(issues[0].kind, Kind::Overlap);
+    EXPECT_EQ(issues[0].signal, "b");
+    EXPECT_EQ(issues[0].other, "a");
+    EXPECT_EQ(issues[0].firstBit, 4u);
+    EXPECT_EQ(issues[0].lastBit, 7u);
+
+    // Motorola c covers all of byte 0
+    EXPECT_EQ(issues[1].other, "a");
+    EXPECT_EQ(issues[1].firstBit, 0u);
+    EXPECT_EQ(issues[1].lastBit, 7u);
+    EXPECT_EQ(issues[2].other, "b");
+    EXPECT_EQ(issues[2].firstBit, 4u);
+    EXPECT_EQ(issues[2].lastBit, 7u);
+}
+
+TEST_F(LayoutCheckTests, exceeds_dlc)
+{
+    const auto issues = check(2, { makeSignal("a", 8, 16, 1) });
+    ASSERT_EQ(issues.size(), 1u);
+    EXPECT_EQ(issues[0].kind, Kind::ExceedsDlc);
+    EXPECT_EQ(issues[0].firstBit, 16u);
+    EXPECT_EQ(issues[0].lastBit, 23u);
+}
+
+TEST_F(LayoutCheckTests, byte_order_mistake)
+{
+    // A Motorola layout declared as Intel runs past the end of the frame
+    const auto issues = check(2, { makeSignal("a", 7, 16, 1) });
+    ASSERT_EQ(issues.size(), 1u);
+    EXPECT_EQ(issues[0].kind, Kind::ByteOrder);
+    EXPECT_EQ(issues[0].firstBit, 16u);
+    EXPECT_EQ(issues[0].lastBit, 22u);
+}
+
+TEST_F(LayoutCheckTests, invalid_signals)
+{
+    const auto issues
+        = check(8, { makeSignal("a", 0, 8, 2), makeSignal("b", 8, 0, 1) });
+    ASSERT_EQ(issues.size(), 2u);
+    EXPECT_EQ(issues[0].kind, Kind::InvalidByteOrder);
+    EXPECT_EQ(issues[1].kind, Kind::EmptySignal);
+    EXPECT_STREQ(CANdb::toString(issues[1].kind), "empty signal");
+}
+
+TEST_F(LayoutCheckTests, multiplexed_groups_share_bits)
+{
+    // Groups 0 and 1 reuse bits 8..23, as dbcgen lays them out
+    const auto issues = check(4,
+        { multiplexed("mode", 0, 8, "M"), multiplexed("a", 8, 16, "m0"),
+            multiplexed("b", 8, 8, "m1"), multiplexed("c", 16, 8, "m1"),
+            multiplexed("d", 20, 8, "m1"), multiplexed("e", 4, 8, "m2"),
+            makeSignal("f", 28, 4, 1) });
+    ASSERT_EQ(issues.size(), 2u);
+
+    // Signals of one group still overlap each other
+    EXPECT_EQ(issues[0].kind, Kind::Overlap);
+    EXPECT_EQ(issues[0].signal, "d");
+    EXPECT_EQ(issues[0].other, "c");
+    EXPECT_EQ(issues[0].firstBit, 20u);
+    EXPECT_EQ(issues[0].lastBit, 23u);
+
+    // and every group overlaps the switch and plain signals
+    EXPECT_EQ(issues[1].signal, "e");
+    EXPECT_EQ(issues[1].other, "mode");
+    EXPECT_EQ(issues[1].firstBit, 4u);
+    EXPECT_EQ(issues[1].lastBit, 7u);
+}
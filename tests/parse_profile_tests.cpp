@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include "parse_profile.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+TEST(ParseProfilerTests, counts_and_nesting)
+{
+    const std::string input = "BO_ 1 A: 8 X\nBO_ 2 B: 8 X\n";
+    CANdb::ParseProfiler profiler{ input };
+    const auto message = profiler.rule("message");
+    const auto token = profiler.rule("TOKEN");
+    profiler.rule("unused");
+
+    profiler.enter(message);
+    profiler.enter(token);
+    profiler.leave(token, input.data() + 4, true);
+    profiler.enter(token);
+    profiler.leave(token, input.data() + 4, false);
+    profiler.leave(message, input.data(), true);
+
+    profiler.enter(message);
+    profiler.enter(token);
+    profiler.leave(token, input.data() + 17, false);
+    profiler.leave(message, input.data() + 13, false);
+
+    const auto profile = profiler.finish();
+    ASSERT_EQ(profile.rules.size(), 2u);
+
+    const auto find = [&profile](const std::string& name) {
+        return *std::find_if(profile.rules.begin(), profile.rules.end(),
+            [&name](const CANdb::RuleProfile& r) { return r.rule == name; });
+    };
+    const auto m = find("message");
+    EXPECT_EQ(m.attempts, 2u);
+    EXPECT_EQ(m.successes, 1u);
+    EXPECT_EQ(m.failures, 1u);
+    EXPECT_LE(m.selfMs, m.totalMs);
+
+    const auto t = find("TOKEN");
+    EXPECT_EQ(t.attempts, 3u);
+    EXPECT_EQ(t.failures, 2u);
+    EXPECT_LE(t.totalMs, m.totalMs);
+    EXPECT_GE(profile.totalMs, m.totalMs);
+
+    ASSERT_EQ(profile.lines.size(), 2u);
+    EXPECT_EQ(profile.lines[0].line, 2u);
+    EXPECT_EQ(profile.lines[0].failures, 2u);
+    EXPECT_EQ(profile.lines[1].line, 1u);
+    EXPECT_EQ(profile.lines[1].failures, 1u);
+}
+
+TEST(ParseProfilerTests, unbalanced_frames_and_limits)
+{
+    const std::string input = "a\nb\nc\n";
+    CANdb::ParseProfiler profiler{ input };
+    const auto outer = profiler.rule("outer");
+    const auto inner = profiler.rule("inner");
+
+    // inner never leaves, e.g. an action threw
+    profiler.enter(outer);
+    profiler.enter(inner);
+    profiler.leave(outer, input.data() + 2, false);
+    profiler.leave(inner, input.data() + 4, false);
+
+    profiler.enter(inner);
+    profiler.leave(inner, input.data() + 4, false);
+
+    const auto profile = profiler.finish(1);
+    ASSERT_EQ(profile.lines.size(), 1u);
+    EXPECT_EQ(profile.lines[0].line, 2u);
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include "parse_recovery.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+const std::string kInput = R"(VERSION ""
+
+NS_ :
+  BA_DEF_
+  CM_
+
+BO_ 100 First: 8 NEO
+ SG_ A : 0|8@1+ (1,0) [0|0] "" EPAS
+ SG_ B : 8|8@1+ (1,0) [0|0] "" EPAS
+
+BO_ 200 Second: 8 NEO
+ SG_ C : 0|8@1+ (1,0) [0|0] "" EPAS
+
+CM_ SG_ 100 A "first
+comment line";
+CM_ SG_ 200 C "second";
+)";
+} // namespace
+
+TEST(RecoveryBufferTests, rules_of_statements)
+{
+    const CANdb::RecoveryBuffer buffer{ kInput };
+    EXPECT_EQ(buffer.ruleAt(1), "version");
+    EXPECT_EQ(buffer.ruleAt(5), "ns"); // NS_ symbols are not statements
+    EXPECT_EQ(buffer.ruleAt(7), "message");
+    EXPECT_EQ(buffer.ruleAt(9), "signal");
+    EXPECT_EQ(buffer.ruleAt(15), "cm"); // continuation of a comment
+    EXPECT_EQ(buffer.ruleAt(2), "");
+    EXPECT_EQ(buffer.ruleAt(100), "");
+    EXPECT_EQ(CANdb::statementRule("EV_"), "EV_");
+}
+
+TEST(RecoveryBufferTests, skip_message_with_signals)
+{
+    CANdb::RecoveryBuffer buffer{ kInput };
+    ASSERT_TRUE(buffer.skipStatement(7));
+    EXPECT_EQ(buffer.text().find("First"), std::string::npos);
+    EXPECT_EQ(buffer.text().find("SG_ A"), std::string::npos);
+    EXPECT_NE(buffer.text().find("Second"), std::string::npos);
+
+    // Line 7 is now the blank line in front of the second message
+    EXPECT_EQ(buffer.originalLine(7), 10u);
+    EXPECT_EQ(buffer.originalLine(8), 11u);
+    EXPECT_EQ(buffer.ruleAt(8), "message");
+}
+
+TEST(RecoveryBufferTests, skip_single_statements)
+{
+    CANdb::RecoveryBuffer buffer{ kInput };
+
+    // A signal goes alone, a comment with all its lines
+    ASSERT_TRUE(buffer.skipStatement(9));
+    EXPECT_EQ(buffer.text().find("SG_ B"), std::string::npos);
+    EXPECT_NE(buffer.text().find("SG_ A"), std::string::npos);
+    EXPECT_EQ(buffer.originalLine(9), 10u);
+
+    ASSERT_TRUE(buffer.skipStatement(14));
+    EXPECT_EQ(buffer.text().find("first"), std::string::npos);
+    EXPECT_NE(buffer.text().find("second"), std::string::npos);
+    EXPECT_EQ(buffer.originalLine(14), 17u);
+
+    EXPECT_FALSE(buffer.skipStatement(0));
+    EXPECT_FALSE(buffer.skipStatement(100));
+}
+
+TEST(RecoveryBufferTests, resume_lines)
+{
+    const CANdb::RecoveryBuffer buffer{ kInput };
+    EXPECT_EQ(buffer.lineAt(0), 1u);
+    EXPECT_EQ(buffer.lineAt(buffer.lineOffset(7)), 7u);
+    EXPECT_EQ(buffer.lineAt(buffer.lineOffset(7) + 3), 7u);
+    EXPECT_EQ(buffer.lineOffset(100), buffer.text().size());
+    EXPECT_EQ(buffer.text().compare(buffer.lineOffset(11), 3, "BO_"), 0);
+
+    EXPECT_EQ(buffer.statementLine(15), 14u);
+    EXPECT_EQ(buffer.statementLine(9), 9u);
+
+    // Signals resume at their message, other statements at themselves
+    EXPECT_EQ(buffer.resumeLine(9), 7u);
+    EXPECT_EQ(buffer.resumeLine(12), 11u);
+    EXPECT_EQ(buffer.resumeLine(14), 14u);
+    EXPECT_EQ(buffer.resumeLine(10), 10u);
+}
@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "dbc_generator.h"
+#include "dbcparser.h"
+#include "log.hpp"
+#include "parse_task.h"
+#include "stream_writer.h"
+
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+std::string sample()
+{
+    CANdb::GeneratorOptions options;
+    options.messages = 300;
+    options.commentRatio = 0.5;
+    options.attributeRatio = 0.5;
+    options.valueTableRatio = 0.5;
+    return CANdb::generateDbc(options);
+}
+
+std::string json(const CANdb_t& db)
+{
+    CANdb::OutputBuffer out;
+    CANdb::writeJson(db, out);
+    return out.str();
+}
+
+// Cancels after a number of statements and remembers their sections
+class CountingObserver : public CANdb::ParseObserver {
+public:
+    explicit CountingObserver(std::size_t limit)
+        : _limit(limit)
+    {
+    }
+
+    bool statement(std::size_t consumed, std::size_t total,
+        CANdb::ParseSection section) override
+    {
+        EXPECT_LE(consumed, total);
+        sections.push_back(section);
+        return sections.size() < _limit;
+    }
+
+    std::vector<CANdb::ParseSection> sections;
+
+private:
+    std::size_t _limit;
+};
+} // namespace
+
+TEST(ParseTaskTests, matches_sync_parse)
+{
+    const auto data = sample();
+    CANdb::DBCParser parser;
+    ASSERT_TRUE(parser.parse(data));
+
+    auto task = CANdb::parseAsync(data);
+    const auto result = task.get();
+    EXPECT_TRUE(result.success);
+    EXPECT_FALSE(result.cancelled);
+    EXPECT_TRUE(result.diagnostics.empty());
+    EXPECT_EQ(json(result.db), json(parser.getDb()));
+    EXPECT_EQ(result.attributes.definitions().size(),
+        parser.attributes().definitions().size());
+}
+
+TEST(ParseTaskTests, progress)
+{
+    std::vector<CANdb::ParseProgress> reports;
+    CANdb::AsyncParseOptions options;
+    options.progressInterval = std::chrono::milliseconds(0);
+    options.onProgress = [&reports](const CANdb::ParseProgress& progress) {
+        reports.push_back(progress);
+    };
+
+    const auto data = sample();
+    ASSERT_TRUE(CANdb::parseAsync(data, options).get().success);
+
+    ASSERT_GT(reports.size(), 300u);
+    for (std::size_t i = 1; i < reports.size(); ++i) {
+        EXPECT_GE(reports[i].bytesConsumed, reports[i - 1].bytesConsumed);
+        EXPECT_GE(
+            reports[i].sectionsCompleted, reports[i - 1].sectionsCompleted);
+        EXPECT_LE(reports[i].bytesConsumed, reports[i].bytesTotal);
+    }
+    EXPECT_EQ(reports.back().bytesConsumed, reports.back().bytesTotal);
+    EXPECT_EQ(reports.back().sectionsCompleted, CANdb::kParseSectionCount);
+    EXPECT_TRUE(std::any_of(reports.begin(), reports.end(),
+        [](const CANdb::ParseProgress& p) {
+            return p.sectionsCompleted
+                == static_cast<unsigned>(CANdb::ParseSection::Messages);
+        }));
+}
+
+TEST(ParseTaskTests, throttled)
+{
+    std::size_t reports = 0;
+    CANdb::AsyncParseOptions options;
+    options.progressInterval = std::chrono::hours(1);
+    options.onProgress
+        = [&reports](const CANdb::ParseProgress&) { ++reports; };
+
+    ASSERT_TRUE(CANdb::parseAsync(sample(), options).get().success);
+    // The first statement and the final report
+    EXPECT_EQ(reports, 2u);
+}
+
+TEST(ParseTaskTests, cancel)
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool started = false;
+    bool cancelled = false;
+
+    CANdb::AsyncParseOptions options;
+    options.onProgress = [&](const CANdb::ParseProgress&) {
+        std::unique_lock<std::mutex> lock{ mutex };
+        started = true;
+        cv.notify_all();
+        cv.wait(lock, [&cancelled] { return cancelled; });
+    };
+
+    auto task = CANdb::parseAsync(sample(), options);
+    {
+        std::unique_lock<std::mutex> lock{ mutex };
+        cv.wait(lock, [&started] { return started; });
+        task.cancel();
+        cancelled = true;
+        cv.notify_all();
+    }
+
+    const auto result = task.get();
+    EXPECT_FALSE(result.success);
+    EXPECT_TRUE(result.cancelled);
+    ASSERT_EQ(result.diagnostics.size(), 1u);
+    EXPECT_EQ(result.diagnostics.front().message, "parse cancelled");
+    EXPECT_LT(result.db.messages.size(), 300u);
+}
+
+TEST(ParseTaskTests, move_assignment_cancels)
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::size_t calls = 0;
+
+    CANdb::AsyncParseOptions options;
+    options.progressInterval = std::chrono::milliseconds(0);
+    options.onProgress = [&](const CANdb::ParseProgress&) {
+        {
+            std::lock_guard<std::mutex> lock{ mutex };
+            ++calls;
+        }
+        cv.notify_all();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    };
+
+    auto task = CANdb::parseAsync(sample(), options);
+    {
+        std::unique_lock<std::mutex> lock{ mutex };
+        cv.wait(lock, [&calls] { return calls > 0; });
+    }
+
+    // Waits for the first parse, which stops instead of reading 300 messages
+    task = CANdb::parseAsync("VERSION \"\"\n");
+    {
+        std::lock_guard<std::mutex> lock{ mutex };
+        EXPECT_LT(calls, 300u);
+    }
+    EXPECT_TRUE(task.get().success);
+
+    // Nothing is left to wait for
+    EXPECT_FALSE(task.ready());
+    EXPECT_FALSE(task.waitFor(std::chrono::seconds(1)));
+    auto other = std::move(task);
+    EXPECT_FALSE(task.ready());
+}
+
+TEST(ParseTaskTests, observer)
+{
+    const auto data = sample();
+    CANdb::DBCParser parser;
+    CountingObserver all{ ~std::size_t{ 0 } };
+    parser.setObserver(&all);
+    ASSERT_TRUE(parser.parse(data));
+    EXPECT_FALSE(parser.cancelled());
+    EXPECT_TRUE(std::is_sorted(all.sections.begin(), all.sections.end()));
+    EXPECT_EQ(std::count(all.sections.begin(), all.sections.end(),
+                  CANdb::ParseSection::Messages),
+        300);
+
+    CountingObserver some{ 10 };
+    parser.setObserver(&some);
+    EXPECT_FALSE(parser.parse(data));
+    EXPECT_TRUE(parser.cancelled());
+    EXPECT_EQ(some.sections.size(), 10u);
+
+    // Without an observer nothing is reported
+    parser.setObserver(nullptr);
+    EXPECT_TRUE(parser.parse(data));
+    EXPECT_FALSE(parser.cancelled());
+}
@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+
+#include "log.hpp"
+#include "scheduler.h"
+
+#include <chrono>
+#include <ctime>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+CANdb::FrameRecord makeFrame(std::uint32_t id, std::uint64_t seq)
+{
+    CANdb::FrameRecord frame{};
+    frame.timestamp = seq;
+    frame.id = id;
+    frame.dlc = 8;
+    frame.payload[0] = static_cast<std::uint8_t>(seq);
+    return frame;
+}
+} // namespace
+
+struct SchedulerTests : public ::testing::TestWithParam<std::size_t> {
+};
+
+TEST_P(SchedulerTests, preserves_per_id_order)
+{
+    constexpr std::uint32_t ids = 50;
+    constexpr std::uint64_t frames = 50000;
+
+    // Per id sequence numbers, only touched by the lane owning the id
+    std::vector<std::uint64_t> next(ids, 0);
+    std::vector<std::atomic<int>> inLane(GetParam() * 8);
+    std::atomic<std::uint64_t> handled{ 0 };
+    std::atomic<bool> ordered{ true };
+    std::atomic<bool> exclusive{ true };
+
+    CANdb::DecodeScheduler scheduler{ GetParam(),
+        [&](std::size_t lane, const CANdb::FrameRecord* f, std::size_t n) {
+            if (inLane[lane].fetch_add(1) != 0) {
+                exclusive = false;
+            }
+            for (std::size_t i = 0; i < n; ++i) {
+                if (next[f[i].id] != f[i].timestamp) {
+                    ordered = false;
+                }
+                next[f[i].id] = f[i].timestamp + 1;
+            }
+            handled += n;
+            inLane[lane].fetch_sub(1);
+        },
+        8, 64 };
+    ASSERT_EQ(scheduler.lanes(), inLane.size());
+
+    // Skewed traffic, id 0 carries half of the frames
+    std::vector<std::uint64_t> seq(ids, 0);
+    for (std::uint64_t i = 0; i < frames; ++i) {
+        const auto id = static_cast<std::uint32_t>(i % 2 == 0 ? 0 : i % ids);
+        scheduler.submit(makeFrame(id, seq[id]++));
+    }
+    scheduler.finish();
+
+    EXPECT_EQ(handled, frames);
+    EXPECT_TRUE(ordered);
+    EXPECT_TRUE(exclusive);
+    EXPECT_EQ(next, seq);
+
+    const auto stats = scheduler.stats();
+    ASSERT_EQ(stats.framesPerWorker.size(), GetParam());
+    EXPECT_EQ(std::accumulate(stats.framesPerWorker.begin(),
+                  stats.framesPerWorker.end(), std::uint64_t{ 0 }),
+        frames);
+}
+
+TEST_P(SchedulerTests, decodes_with_per_lane_decoders)
+{
+    CANdb_t db;
+    db.messages[CANmessage{ 257, "GTW_epasControl", 8, "NEO" }]
+        = { CANsignal{ "counter", 0, 8, 1, "+", 1, 0, 0, 0, "", "NEO" } };
+    db.messages[CANmessage{ 258, "GTW_epasStatus", 8, "NEO" }]
+        = { CANsignal{ "status", 0, 8, 1, "+", 1, 0, 0, 0, "", "NEO" } };
+
+    std::vector<CANdb::Decoder> decoders;
+    for (std::size_t i = 0; i < GetParam() * 4; ++i) {
+        decoders.emplace_back(db, CANdb::Decoder::Mode::ChangeDetection);
+    }
+
+    std::mutex mutex;
+    std::map<std::string, std::uint64_t> emitted;
+    CANdb::DecodeScheduler scheduler{ GetParam(),
+        CANdb::makeDecodingHandler(decoders,
+            [&](const CANmessage&, const CANsignal& s, std::uint64_t) {
+                std::lock_guard<std::mutex> lock{ mutex };
+                ++emitted[s.signal_name];
+            }),
+        4 };
+
+    for (std::uint64_t i = 0; i < 1000; ++i) {
+        scheduler.submit(makeFrame(257, i / 4));
+        scheduler.submit(makeFrame(258, 0));
+    }
+    scheduler.finish();
+
+    EXPECT_EQ(emitted["counter"], 250u);
+    EXPECT_EQ(emitted["status"], 1u);
+}
+
+TEST_P(SchedulerTests, idle_workers_sleep)
+{
+    std::atomic<std::uint64_t> handled{ 0 };
+    CANdb::DecodeScheduler scheduler{ GetParam(),
+        [&handled](std::size_t, const CANdb::FrameRecord*, std::size_t n) {
+            handled += n;
+        } };
+
+    // Spinning workers would use about one second of CPU per worker
+    const auto start = std::clock();
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    const auto cpu
+        = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+    EXPECT_LT(cpu, 0.25);
+
+    // Sleeping workers are woken by new frames
+    for (std::uint64_t i = 0; i < 100; ++i) {
+        scheduler.submit(makeFrame(static_cast<std::uint32_t>(i % 7), i));
+    }
+    while (handled < 100) {
+        std::this_thread::yield();
+    }
+    scheduler.finish();
+    EXPECT_EQ(handled, 100u);
+}
+
+TEST_P(SchedulerTests, workers_sleep_beside_a_held_lane)
+{
+    // The worker holding the only lane with frames is stuck in the handler
+    std::atomic<bool> released{ false };
+    std::atomic<std::uint64_t> handled{ 0 };
+    CANdb::DecodeScheduler scheduler{ GetParam(),
+        [&](std::size_t, const CANdb::FrameRecord*, std::size_t n) {
+            while (!released) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            handled += n;
+        },
+        8, 1024, 32 };
+    for (std::uint64_t i = 0; i < 100; ++i) {
+        scheduler.submit(makeFrame(7, i));
+    }
+
+    // Workers spinning on the held lane would use the CPU left over
+    const auto start = std::clock();
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    const auto cpu
+        = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+    EXPECT_LT(cpu, 0.25);
+
+    released = true;
+    scheduler.finish();
+    EXPECT_EQ(handled, 100u);
+}
+
+INSTANTIATE_TEST_CASE_P(Workers, SchedulerTests, ::testing::Values(1, 2, 4));
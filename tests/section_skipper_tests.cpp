@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "section_skipper.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+const std::string kInput = R"(VERSION ""
+
+BO_ 100 First: 8 NEO
+ SG_ A : 0|8@1+ (1,0) [0|0] "" EPAS
+
+CM_ SG_ 100 A "comment; with
+two lines";
+BA_DEF_ BO_ "GenMsgCycleTime" INT 0 1000;
+BA_DEF_DEF_ "GenMsgCycleTime" 100;
+BA_ "GenMsgCycleTime" BO_ 100 10;
+VAL_ 100 A 0 "OFF" 1 "ON" ;
+)";
+
+std::size_t lines(const std::string& text)
+{
+    return static_cast<std::size_t>(
+        std::count(text.begin(), text.end(), '\n'));
+}
+} // namespace
+
+TEST(SectionSkipperTests, all_sections_keep_input)
+{
+    CANdb::DeferredSections deferred;
+    EXPECT_EQ(CANdb::skipSections(kInput, CANdb::kAllSections, deferred),
+        kInput);
+    EXPECT_TRUE(deferred.empty());
+}
+
+TEST(SectionSkipperTests, layout_only)
+{
+    CANdb::DeferredSections deferred;
+    const auto layout
+        = CANdb::skipSections(kInput, CANdb::kLayoutOnly, deferred);
+
+    EXPECT_EQ(lines(layout), lines(kInput));
+    EXPECT_EQ(layout.find("CM_"), std::string::npos);
+    EXPECT_EQ(layout.find("BA_"), std::string::npos);
+    EXPECT_EQ(layout.find("VAL_"), std::string::npos);
+    EXPECT_NE(layout.find("SG_ A"), std::string::npos);
+
+    ASSERT_EQ(deferred.statements.size(), 5u);
+    EXPECT_EQ(deferred.sections(), CANdb::kAllSections);
+    const auto& comment = deferred.statements[0];
+    EXPECT_EQ(comment.section, CANdb::Section::Comments);
+    EXPECT_EQ(comment.line, 6u);
+    EXPECT_EQ(deferred.text.substr(comment.offset, comment.length),
+        "CM_ SG_ 100 A \"comment; with\ntwo lines\";\n");
+    EXPECT_EQ(deferred.statements[1].section,
+        CANdb::Section::AttributeDefinitions);
+    EXPECT_EQ(deferred.statements[2].section,
+        CANdb::Section::AttributeDefinitions);
+    EXPECT_EQ(deferred.statements[3].section, CANdb::Section::Attributes);
+    EXPECT_EQ(deferred.statements[4].section,
+        CANdb::Section::ValueDescriptions);
+    EXPECT_EQ(deferred.statements[4].line, 11u);
+}
+
+TEST(SectionSkipperTests, selected_sections)
+{
+    CANdb::DeferredSections deferred;
+    const auto kept = CANdb::skipSections(kInput,
+        CANdb::sectionBit(CANdb::Section::Comments)
+            | CANdb::sectionBit(CANdb::Section::ValueDescriptions),
+        deferred);
+
+    EXPECT_NE(kept.find("CM_"), std::string::npos);
+    EXPECT_NE(kept.find("VAL_"), std::string::npos);
+    EXPECT_EQ(kept.find("BA_"), std::string::npos);
+    EXPECT_EQ(deferred.statements.size(), 3u);
+}
+
+TEST(SectionSkipperTests, attributes_follow_their_definitions)
+{
+    CANdb::DeferredSections deferred;
+    const auto kept = CANdb::skipSections(kInput,
+        CANdb::kAllSections
+            & ~CANdb::sectionBit(CANdb::Section::AttributeDefinitions),
+        deferred);
+
+    EXPECT_EQ(kept.find("BA_"), std::string::npos);
+    EXPECT_NE(kept.find("CM_"), std::string::npos);
+    EXPECT_EQ(deferred.sections(),
+        CANdb::sectionBit(CANdb::Section::AttributeDefinitions)
+            | CANdb::sectionBit(CANdb::Section::Attributes));
+    ASSERT_EQ(deferred.statements.size(), 3u);
+    EXPECT_EQ(deferred.statements[2].line, 10u);
+}
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+
+#include "signal_index.h"
+#include "log.hpp"
+
+#include <cstring>
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+CANsignal makeSignal(const std::string& name, const std::string& unit)
+{
+    CANsignal sig;
+    sig.signal_name = name;
+    sig.unit = unit;
+    return sig;
+}
+
+std::vector<std::string> names(const std::vector<CANdb::IndexHit>& hits)
+{
+    std::vector<std::string> r;
+    for (const auto& hit : hits) {
+        r.push_back(
+            hit.file + ":" + CANdb::toString(hit.kind) + ":" + hit.name);
+    }
+    std::sort(r.begin(), r.end());
+    return r;
+}
+} // namespace
+
+struct SignalIndexTests : public ::testing::Test {
+    CANdb::SignalIndexBuilder builder;
+
+    SignalIndexTests()
+    {
+        CANdb_t tesla;
+        tesla.ecus = { "EPAS", "GTW" };
+        tesla.messages[CANmessage{ 880, "EPAS_sysStatus", 8, "EPAS" }]
+            = { makeSignal("EPAS_torsionBarTorque", "Nm"),
+                  makeSignal("EPAS_handsOnLevel", "") };
+        tesla.messages[CANmessage{ 264, "DI_torque1", 8, "DI" }]
+            = { makeSignal("DI_wheelSpeed", "km/h") };
+        builder.add("tesla.dbc", tesla);
+
+        CANdb_t honda;
+        honda.ecus = { "EPS" };
+        honda.messages[CANmessage{ 464, "WHEEL_SPEEDS", 8, "VSA" }]
+            = { makeSignal("WHEEL_SPEED_FL", "kph"),
+                  makeSignal("WHEEL_SPEED_FR", "kph") };
+        builder.add("honda.dbc", honda);
+    }
+};
+
+TEST(GlobMatchTests, wildcards)
+{
+    EXPECT_TRUE(CANdb::globMatch("*", ""));
+    EXPECT_TRUE(CANdb::globMatch("*wheel*", "WHEEL_SPEED_FL"));
+    EXPECT_TRUE(CANdb::globMatch("WHEEL_SPEED_F?", "wheel_speed_fr"));
+    EXPECT_TRUE(CANdb::globMatch("EPAS*Torque", "EPAS_torsionBarTorque"));
+    EXPECT_FALSE(CANdb::globMatch("EPAS*Torque", "EPAS_torsionBarTorque1"));
+    EXPECT_FALSE(CANdb::globMatch("WHEEL_SPEED_F?", "WHEEL_SPEED_F"));
+    EXPECT_FALSE(CANdb::globMatch("", "x"));
+}
+
+TEST_F(SignalIndexTests, trigram_query)
+{
+    const CANdb::SignalIndex index{ builder.serialize() };
+    EXPECT_EQ(index.files(), 2u);
+
+    const auto hits = index.query("*WHEEL_SPEED*");
+    const std::vector<std::string> expected{ "honda.dbc:message:WHEEL_SPEEDS",
+        "honda.dbc:signal:WHEEL_SPEED_FL", "honda.dbc:signal:WHEEL_SPEED_FR" };
+    EXPECT_EQ(names(hits), expected);
+
+    EXPECT_EQ(names(index.query("*wheelspeed*")),
+        std::vector<std::string>{ "tesla.dbc:signal:DI_wheelSpeed" });
+    EXPECT_TRUE(index.query("*NOT_THERE*").empty());
+}
+
+TEST_F(SignalIndexTests, prefix_and_short_patterns)
+{
+    const CANdb::SignalIndex index{ builder.serialize() };
+
+    const std::vector<std::string> expected{ "honda.dbc:ecu:EPS",
+        "tesla.dbc:ecu:EPAS" };
+    EXPECT_EQ(names(index.query("EP?S", CANdb::kindBit(CANdb::IndexKind::Ecu))),
+        std::vector<std::string>{ "tesla.dbc:ecu:EPAS" });
+    EXPECT_EQ(names(index.query("EP*", CANdb::kindBit(CANdb::IndexKind::Ecu))),
+        expected);
+    EXPECT_EQ(index.query("*").size(), 15u);
+}
+
+TEST_F(SignalIndexTests, hit_context)
+{
+    const CANdb::SignalIndex index{ builder.serialize() };
+
+    const auto signals = index.query(
+        "epas_torsion*", CANdb::kindBit(CANdb::IndexKind::Signal));
+    ASSERT_EQ(signals.size(), 1u);
+    EXPECT_EQ(signals[0].file, "tesla.dbc");
+    EXPECT_EQ(signals[0].messageId, 880u);
+    EXPECT_EQ(signals[0].context, "EPAS_sysStatus");
+
+    const auto units
+        = index.query("kph", CANdb::kindBit(CANdb::IndexKind::Unit));
+    ASSERT_EQ(units.size(), 2u);
+    EXPECT_EQ(units[0].messageId, 464u);
+    EXPECT_EQ(units[0].context.substr(0, 12), "WHEEL_SPEED_");
+}
+
+TEST_F(SignalIndexTests, rejects_corrupted_data)
+{
+    auto data = builder.serialize();
+    EXPECT_THROW(CANdb::SignalIndex{ data.substr(0, 30) }, std::runtime_error);
+    EXPECT_THROW(CANdb::SignalIndex{ data.substr(0, data.size() - 8) },
+        std::runtime_error);
+    data[0] = 'X';
+    EXPECT_THROW(CANdb::SignalIndex{ data }, std::runtime_error);
+}
+
+TEST_F(SignalIndexTests, rejects_corrupted_offsets)
+{
+    const auto data = builder.serialize();
+    std::vector<std::uint32_t> words(data.size() / 4);
+    std::memcpy(words.data(), data.data(), data.size());
+    const auto names = 8 + words[2] * 2;
+    const auto occurrences = names + words[3] * 4;
+    const auto trigrams = occurrences + words[4] * 4;
+    const auto postings = trigrams + words[5] * 3;
+
+    // Word at index set to value, the rest of the index intact
+    const auto corrupt = [&words](std::size_t index, std::uint32_t value) {
+        auto copy = words;
+        copy[index] = value;
+        return std::string(reinterpret_cast<const char*>(copy.data()),
+            copy.size() * 4);
+    };
+    // Occurrence count of the first name
+    EXPECT_THROW(CANdb::SignalIndex{ corrupt(names + 3, 1000) },
+        std::runtime_error);
+    // File of the first occurrence
+    EXPECT_THROW(CANdb::SignalIndex{ corrupt(occurrences, 1000) },
+        std::runtime_error);
+    // Posting list length of the first trigram
+    EXPECT_THROW(CANdb::SignalIndex{ corrupt(trigrams + 2, 100000) },
+        std::runtime_error);
+    // First posting
+    EXPECT_THROW(CANdb::SignalIndex{ corrupt(postings, 1000) },
+        std::runtime_error);
+    EXPECT_NO_THROW(CANdb::SignalIndex{ corrupt(0, words[0]) });
+}
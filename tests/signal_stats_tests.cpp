@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+
+#include "log.hpp"
+#include "signal_stats.h"
+
+#include <cmath>
+#include <random>
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+CANdb_t makeDb()
+{
+    CANdb_t db;
+    db.messages[CANmessage{ 257, "GTW_epasControl", 8, "NEO" }] = {
+        CANsignal{ "speed", 0, 8, 1, "+", 1, 0, 0, 100, "", "NEO" },
+        CANsignal{ "torque", 8, 8, 1, "-", 2, 0, 0, 0, "", "NEO" },
+    };
+    return db;
+}
+
+std::vector<std::uint8_t> frame(std::uint8_t speed, std::int8_t torque)
+{
+    return { speed, static_cast<std::uint8_t>(torque), 0, 0, 0, 0, 0, 0 };
+}
+} // namespace
+
+TEST(SignalStatsTests, accumulate_matches_naive_computation)
+{
+    std::mt19937 rng{ 7 };
+    std::uniform_real_distribution<double> dist{ -10, 110 };
+    std::vector<double> values(1001);
+    for (auto& v : values) {
+        v = dist(rng);
+    }
+
+    CANdb::SignalSummary summary;
+    summary.histogramLow = 0;
+    summary.histogramHigh = 100;
+    summary.bins.assign(10, 0);
+    // uneven batches exercise the merge path
+    CANdb::accumulate(summary, values.data(), 17);
+    CANdb::accumulate(summary, values.data() + 17, values.size() - 17);
+
+    double sum = 0;
+    for (const auto v : values) {
+        sum += v;
+    }
+    const auto mean = sum / values.size();
+    double m2 = 0;
+    std::vector<std::uint64_t> bins(10, 0);
+    std::uint64_t under = 0, over = 0;
+    for (const auto v : values) {
+        m2 += (v - mean) * (v - mean);
+        if (v < 0) {
+            ++under;
+        } else if (v > 100) {
+            ++over;
+        } else {
+            ++bins[std::min<std::size_t>(static_cast<std::size_t>(v / 10), 9)];
+        }
+    }
+
+    EXPECT_EQ(summary.count, values.size());
+    EXPECT_EQ(summary.min, *std::min_element(values.begin(), values.end()));
+    EXPECT_EQ(summary.max, *std::max_element(values.begin(), values.end()));
+    EXPECT_NEAR(summary.mean, mean, 1e-9);
+    EXPECT_NEAR(summary.variance(), m2 / values.size(), 1e-6);
+    EXPECT_EQ(summary.bins, bins);
+    EXPECT_EQ(summary.underflow, under);
+    EXPECT_EQ(summary.overflow, over);
+}
+
+TEST(SignalStatsTests, decodes_frames_into_summaries)
+{
+    const auto db = makeDb();
+    CANdb::SignalStatistics stats{ db, 10, 4 };
+    ASSERT_EQ(stats.size(), 2u);
+
+    for (std::uint8_t i = 0; i <= 100; ++i) {
+        const auto payload = frame(i, static_cast<std::int8_t>(-5));
+        stats.add(257, payload.data(), payload.size());
+    }
+    stats.add(42, frame(1, 1).data(), 8);
+    stats.flush();
+
+    const auto speed = stats.find(257, "speed");
+    ASSERT_NE(speed, nullptr);
+    EXPECT_EQ(speed->count, 101u);
+    EXPECT_EQ(speed->min, 0);
+    EXPECT_EQ(speed->max, 100);
+    EXPECT_DOUBLE_EQ(speed->mean, 50);
+    // edges come from [0|100]
+    EXPECT_EQ(speed->binEdge(1), 10);
+    EXPECT_EQ(speed->bins.front(), 10u);
+    EXPECT_EQ(speed->bins.back(), 11u);
+
+    // [0|0] falls back to the signed raw range scaled by the factor
+    const auto torque = stats.find(257, "torque");
+    ASSERT_NE(torque, nullptr);
+    EXPECT_EQ(torque->min, -10);
+    EXPECT_EQ(torque->variance(), 0);
+    EXPECT_EQ(torque->histogramLow, -256);
+    EXPECT_EQ(torque->histogramHigh, 254);
+
+    EXPECT_EQ(stats.find(257, "nope"), nullptr);
+}
+
+TEST(SignalStatsTests, multiplexed_signals_follow_the_switch)
+{
+    CANdb_t db;
+    db.messages[CANmessage{ 300, "MUX", 8, "NEO" }] = {
+        CANsignal{ "mode", 0, 8, 1, "+", 1, 0, 0, 0, "", "NEO" },
+        CANsignal{ "a", 8, 8, 1, "+", 1, 0, 0, 0, "", "NEO" },
+        CANsignal{ "b", 8, 8, 1, "+", 1, 0, 0, 0, "", "NEO" },
+    };
+    auto& signals = db.messages.begin()->second;
+    signals[0].multiplexer = "M";
+    signals[1].multiplexer = "m0";
+    signals[2].multiplexer = "m1";
+
+    CANdb::SignalStatistics stats{ db };
+    for (std::uint8_t i = 0; i < 30; ++i) {
+        const std::uint8_t payload[8] = { static_cast<std::uint8_t>(i % 3),
+            static_cast<std::uint8_t>(i % 3 == 0 ? 10 : 20) };
+        stats.add(300, payload, sizeof(payload));
+    }
+    stats.flush();
+
+    EXPECT_EQ(stats.find(300, "mode")->count, 30u);
+    EXPECT_EQ(stats.find(300, "a")->count, 10u);
+    EXPECT_EQ(stats.find(300, "a")->max, 10);
+    EXPECT_EQ(stats.find(300, "b")->count, 10u);
+    EXPECT_EQ(stats.find(300, "b")->min, 20);
+}
+
+TEST(SignalStatsTests, merged_partials_equal_single_pass)
+{
+    const auto db = makeDb();
+    CANdb::SignalStatistics all{ db }, left{ db }, right{ db };
+
+    std::mt19937 rng{ 3 };
+    for (int i = 0; i < 5000; ++i) {
+        const auto payload = frame(static_cast<std::uint8_t>(rng() % 100),
+            static_cast<std::int8_t>(rng() % 50 - 25));
+        all.add(257, payload.data(), payload.size());
+        (i % 3 == 0 ? left : right).add(257, payload.data(), payload.size());
+    }
+    all.flush();
+    left.flush();
+    // right still has staged values, merge folds them in
+    left.merge(right);
+
+    for (std::size_t i = 0; i < all.size(); ++i) {
+        const auto& a = all.summary(i);
+        const auto& b = left.summary(i);
+        EXPECT_EQ(a.count, b.count);
+        EXPECT_EQ(a.min, b.min);
+        EXPECT_EQ(a.max, b.max);
+        EXPECT_NEAR(a.mean, b.mean, 1e-9);
+        EXPECT_NEAR(a.variance(), b.variance(), 1e-6);
+        EXPECT_EQ(a.bins, b.bins);
+    }
+}
@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "dbc_generator.h"
+#include "dbcparser.h"
+#include "log.hpp"
+#include "stream_writer.h"
+#include "value_table.h"
+
+#include <cereal/archives/json.hpp>
+#include <cereal/archives/xml.hpp>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+// Database with every field set and strings that need escaping
+CANdb_t sampleDb()
+{
+    CANdb_t db;
+    db.version = "1.0 \"beta\"";
+    db.symbols = { "NS_DESC_", "CM_" };
+    db.ecus = { "NEO", "EPAS" };
+    db.val_tables.push_back(
+        { "ControlType", { { 0, "NONE" }, { -1, "<a&b>" } } });
+
+    CANsignal torque{ "torque", 16, 8, 1, "-", 1, 0, -10, 100, "N\\m",
+        " EPAS", CANsignalType::Int };
+    torque.values = CANdb::makeValueTable(
+        { { 0, "tab\there" }, { 1, "ctl\x01" }, { -1, "line\nbreak" } }, 8);
+    torque.multiplexer = "m3";
+    CANsignal mode{ "mode", 0, 4, 0, "+", 1, 0, 0, 15, "", "NEO" };
+    mode.multiplexer = "M";
+
+    db.messages[CANmessage{ 257, "GTW_epas", 3, "NEO" }] = { mode, torque };
+    db.messages[CANmessage{ 0x80001234, "Diag", 8, "EPAS" }] = {};
+    return db;
+}
+
+template <typename Archive> std::string archive(CANdb_t db)
+{
+    std::ostringstream os;
+    {
+        Archive ar{ os };
+        ar(db);
+    }
+    return os.str();
+}
+
+template <typename Archive> CANdb_t load(const std::string& data)
+{
+    std::istringstream is{ data };
+    Archive ar{ is };
+    CANdb_t db;
+    ar(db);
+    return db;
+}
+
+void expectEqual(const CANdb_t& lhs, const CANdb_t& rhs)
+{
+    EXPECT_EQ(lhs.version, rhs.version);
+    EXPECT_EQ(lhs.symbols, rhs.symbols);
+    EXPECT_EQ(lhs.ecus, rhs.ecus);
+    ASSERT_EQ(lhs.val_tables.size(), rhs.val_tables.size());
+    ASSERT_EQ(lhs.messages.size(), rhs.messages.size());
+    auto it = rhs.messages.begin();
+    for (const auto& msg : lhs.messages) {
+        EXPECT_EQ(msg.first.id, it->first.id);
+        EXPECT_EQ(msg.first.name, it->first.name);
+        ASSERT_EQ(msg.second.size(), it->second.size());
+        for (std::size_t i = 0; i < msg.second.size(); ++i) {
+            const auto& sig = msg.second[i];
+            const auto& other = it->second[i];
+            EXPECT_EQ(sig.signal_name, other.signal_name);
+            EXPECT_EQ(sig.min, other.min);
+            EXPECT_EQ(sig.receiver, other.receiver);
+            EXPECT_EQ(sig.multiplexer, other.multiplexer);
+            EXPECT_EQ(sig.values.entries.size(), other.values.entries.size());
+            EXPECT_EQ(sig.values.dense, other.values.dense);
+        }
+        ++it;
+    }
+}
+} // namespace
+
+TEST(StreamWriterTests, integers)
+{
+    CANdb::OutputBuffer out;
+    for (const auto value : { 0ull, 9ull, 10ull, 99ull, 100ull, 12345ull,
+             18446744073709551615ull }) {
+        out.appendUnsigned(value);
+        out.put(' ');
+    }
+    out.appendSigned(-9223372036854775807ll - 1);
+    out.put(' ');
+    out.appendSigned(-42);
+    EXPECT_EQ(out.str(),
+        "0 9 10 99 100 12345 18446744073709551615 -9223372036854775808 -42");
+}
+
+TEST(StreamWriterTests, json_matches_cereal)
+{
+    const auto db = sampleDb();
+    CANdb::OutputBuffer out;
+    CANdb::writeJson(db, out);
+    EXPECT_EQ(out.str(), archive<cereal::JSONOutputArchive>(db));
+
+    out.clear();
+    CANdb::writeJson(CANdb_t{}, out);
+    EXPECT_EQ(out.str(), archive<cereal::JSONOutputArchive>(CANdb_t{}));
+}
+
+TEST(StreamWriterTests, json_matches_cereal_generated)
+{
+    CANdb::GeneratorOptions options;
+    options.messages = 200;
+    options.multiplexedRatio = 0.25;
+    options.valueTableRatio = 0.5;
+    CANdb::DBCParser parser;
+    ASSERT_TRUE(parser.parse(CANdb::generateDbc(options)));
+    const auto db = parser.getDb();
+
+    CANdb::OutputBuffer out{ 64 };
+    CANdb::writeJson(db, out);
+    EXPECT_EQ(out.str(), archive<cereal::JSONOutputArchive>(db));
+}
+
+TEST(StreamWriterTests, xml_loads_with_cereal)
+{
+    const auto db = sampleDb();
+    CANdb::OutputBuffer out;
+    CANdb::writeXml(db, out);
+    expectEqual(load<cereal::XMLInputArchive>(out.str()), db);
+    expectEqual(load<cereal::XMLInputArchive>(
+                    archive<cereal::XMLOutputArchive>(db)),
+        db);
+}
+
+#ifndef _WIN32
+TEST(StreamWriterTests, fd_output)
+{
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    {
+        // Smaller than the document, so it is written in several parts
+        CANdb::OutputBuffer out{ fds[1], 256 };
+        CANdb::writeJson(sampleDb(), out);
+        out.flush();
+    }
+    ::close(fds[1]);
+
+    std::string written;
+    char buffer[4096];
+    for (auto n = ::read(fds[0], buffer, sizeof(buffer)); n > 0;
+         n = ::read(fds[0], buffer, sizeof(buffer))) {
+        written.append(buffer, static_cast<std::size_t>(n));
+    }
+    ::close(fds[0]);
+    EXPECT_EQ(written, archive<cereal::JSONOutputArchive>(sampleDb()));
+}
+#endif
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+#include "dbc_generator.h"
+#include "dbcparser.h"
+#include "log.hpp"
+#include "text_normalizer.h"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+// Byte at a time version of normalizeText() for Utf8 and Windows1252
+std::string reference(const std::string& data, bool transcode)
+{
+    std::string out;
+    std::size_t i = data.compare(0, 3, "\xEF\xBB\xBF") == 0 ? 3 : 0;
+    for (; i < data.size(); ++i) {
+        const auto c = static_cast<unsigned char>(data[i]);
+        if (c == '\r' && i + 1 < data.size() && data[i + 1] == '\n') {
+            continue;
+        }
+        if (c >= 0xA0 && transcode) {
+            out += static_cast<char>(0xC0 | (c >> 6));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        } else if (c >= 0x80 && transcode) {
+            // Only the bytes the random text below uses
+            out += c == 0x80 ? "\xE2\x82\xAC" : "\xC2\x81";
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    return out;
+}
+
+std::string unit(const std::string& dbc, CANdb::TextEncoding encoding)
+{
+    CANdb::DBCParser parser;
+    parser.setEncoding(encoding);
+    EXPECT_TRUE(parser.parse(dbc));
+    const auto& db = parser.getDb();
+    if (db.messages.empty() || db.messages.begin()->second.empty()) {
+        return {};
+    }
+    const auto& u = db.messages.begin()->second.front().unit;
+    return std::string{ u.begin(), u.end() };
+}
+
+const char kDbc[] = "\xEF\xBB\xBFVERSION \"\"\r\n"
+                    "\r\n"
+                    "BU_ : NEO\r\n"
+                    "\r\n"
+                    "BO_ 100 Temp: 8 NEO\r\n"
+                    " SG_ t : 0|8@1+ (1,0) [0|0] \"\xB0"
+                    "C\" NEO\r\n"
+                    "\r\n";
+} // namespace
+
+TEST(TextNormalizerTests, crlf_and_bom)
+{
+    CANdb::GeneratorOptions options;
+    options.messages = 50;
+    options.commentRatio = 0.5;
+    options.crlf = true;
+    const auto crlf = CANdb::generateDbc(options);
+    const auto lf = CANdb::normalizeText(crlf);
+
+    EXPECT_EQ(lf.find('\r'), std::string::npos);
+    EXPECT_EQ(lf.size(),
+        crlf.size() - std::count(crlf.begin(), crlf.end(), '\n'));
+    EXPECT_EQ(lf, reference(crlf, false));
+    EXPECT_EQ(CANdb::normalizeText("\xEF\xBB\xBF" + crlf), lf);
+    EXPECT_EQ(CANdb::normalizeText(lf), lf);
+
+    // A lone CR is no line ending of a DBC file and a BOM only counts first
+    EXPECT_EQ(CANdb::normalizeText("a\rb\r\r\nc\r"), "a\rb\r\nc\r");
+    EXPECT_EQ(CANdb::normalizeText("a\xEF\xBB\xBF"), "a\xEF\xBB\xBF");
+    EXPECT_EQ(CANdb::normalizeText("\xEF\xBB\xBF"), "");
+    EXPECT_EQ(CANdb::normalizeText(""), "");
+}
+
+TEST(TextNormalizerTests, matches_reference)
+{
+    // CR, LF and non-ASCII bytes at every offset of the 16 byte blocks
+    const char alphabet[] = { 'a', 'b', '\r', '\n', '\x80', '\x81', '\xE4' };
+    std::mt19937 rng{ 7 };
+    std::string out;
+    for (std::size_t size = 0; size < 80; ++size) {
+        for (int round = 0; round < 50; ++round) {
+            std::string data;
+            for (std::size_t i = 0; i < size; ++i) {
+                data += alphabet[rng() % sizeof(alphabet)];
+            }
+            CANdb::normalizeText(data, out, CANdb::TextEncoding::Utf8);
+            EXPECT_EQ(out, reference(data, false));
+            CANdb::normalizeText(data, out, CANdb::TextEncoding::Windows1252);
+            EXPECT_EQ(out, reference(data, true));
+        }
+    }
+}
+
+TEST(TextNormalizerTests, windows1252)
+{
+    const auto cp1252 = CANdb::TextEncoding::Windows1252;
+    EXPECT_EQ(CANdb::normalizeText("\x80 \x9F \xA0 \xE4 \xFF", cp1252),
+        "\xE2\x82\xAC \xC5\xB8 \xC2\xA0 \xC3\xA4 \xC3\xBF");
+    // Unassigned bytes become C1 controls
+    EXPECT_EQ(CANdb::normalizeText("\x81\x8D\x8F\x90\x9D", cp1252),
+        "\xC2\x81\xC2\x8D\xC2\x8F\xC2\x90\xC2\x9D");
+    // Growing the output keeps what was written before
+    const std::string ascii(1000, 'x');
+    EXPECT_EQ(CANdb::normalizeText(ascii + "\x80\r\n", cp1252),
+        ascii + "\xE2\x82\xAC\n");
+}
+
+TEST(TextNormalizerTests, detect)
+{
+    const auto detect = CANdb::TextEncoding::Detect;
+    const std::string ascii(40, 'x');
+    EXPECT_EQ(CANdb::normalizeText(ascii + "\xC3\xA4\r\n", detect),
+        ascii + "\xC3\xA4\n");
+    EXPECT_EQ(CANdb::normalizeText(ascii + "\xC3\xA4 \xE4", detect),
+        ascii + "\xC3\x83\xC2\xA4 \xC3\xA4");
+    // A BOM says UTF-8 even if the text is not
+    EXPECT_EQ(CANdb::normalizeText("\xEF\xBB\xBF\xE4", detect), "\xE4");
+}
+
+TEST(TextNormalizerTests, valid_utf8)
+{
+    const auto valid = [](const std::string& s) {
+        return CANdb::isValidUtf8(s.data(), s.size());
+    };
+    EXPECT_TRUE(valid(""));
+    EXPECT_TRUE(valid(std::string(33, 'a') + "\xC3\xA4\xE2\x82\xAC"));
+    EXPECT_TRUE(valid("\xF0\x9F\x9A\x97"));
+    EXPECT_TRUE(valid("\xF4\x8F\xBF\xBF"));
+    EXPECT_FALSE(valid("\xE4"));
+    EXPECT_FALSE(valid("\xC3"));
+    EXPECT_FALSE(valid("\xE2\x82"));
+    EXPECT_FALSE(valid("\xC0\x80"));
+    EXPECT_FALSE(valid("\xE0\x9F\xBF"));
+    EXPECT_FALSE(valid("\xED\xA0\x80"));
+    EXPECT_FALSE(valid("\xF4\x90\x80\x80"));
+    EXPECT_FALSE(valid("\xF8\x88\x80\x80\x80"));
+    EXPECT_FALSE(valid("\x80"));
+}
+
+TEST(TextNormalizerTests, parser_encoding)
+{
+    // Degree sign and C, the hex escape would swallow the C otherwise
+    const std::string utf8 = "\xC2\xB0" "C";
+    const std::string latin1 = "\xB0" "C";
+    EXPECT_EQ(unit(kDbc, CANdb::TextEncoding::Windows1252), utf8);
+    EXPECT_EQ(unit(kDbc, CANdb::TextEncoding::Detect), utf8);
+    EXPECT_EQ(unit(kDbc, CANdb::TextEncoding::Utf8), latin1);
+}
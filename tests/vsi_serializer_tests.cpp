@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "dbcparser.h"
+#include "log.hpp"
+#include "vsi_serializer.hpp"
+
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+namespace {
+CANdb_t sampleDb()
+{
+    CANdb_t db;
+    db.messages.emplace(CANmessage{ 0x7FF, "Last", 8, "NEO" },
+        std::vector<CANsignal>{
+            CANsignal{ "speed", 7, 16, 0, "+", 1, 0, 0, 100, "", "" },
+            CANsignal{ "accel", 24, 32, 1, "-", 1, 0, -10, 10, "", "",
+                CANsignalType::Float } });
+    db.messages.emplace(CANmessage{ 0x10, "First", 8, "NEO" },
+        std::vector<CANsignal>{
+            CANsignal{ "torque", 16, 8, 1, "-", 1, 0, -10, 100, "", "" } });
+    db.messages.emplace(CANmessage{ 0x18FEF100, "Extended", 8, "NEO" },
+        std::vector<CANsignal>{
+            CANsignal{ "level", 0, 8, 1, "+", 1, 0, 0, 100, "", "" } });
+    return db;
+}
+
+std::string serialize(const CANdb_t& db, bool directIndex)
+{
+    std::ostringstream os;
+    VSISerializer ar{ os, directIndex };
+    ar(db);
+    return os.str();
+}
+} // namespace
+
+TEST(VSISerializerTests, signals)
+{
+    const auto out = serialize(sampleDb(), true);
+
+    EXPECT_NE(out.find(".canId = 0x10,\n        .sigId = 0,\n"
+                       "        .sigName = \"torque\",\n"
+                       "        .start = 16,\n        .end = 23,\n"
+                       "        .min = -10,\n        .max = 100,\n"
+                       "        .type = SIGNED_INT\n"),
+        std::string::npos);
+    // Motorola bits count down within a byte, then continue with the
+    // following byte
+    EXPECT_NE(out.find(".sigId = 1,\n        .sigName = \"speed\",\n"
+                       "        .start = 7,\n        .end = 8,\n"),
+        std::string::npos);
+    EXPECT_NE(out.find(".end = 55,\n        .min = -10,\n        .max = 10,\n"
+                       "        .type = SP_FLOAT\n"),
+        std::string::npos);
+    EXPECT_NE(out.find("const uint32_t can_signal_count = 4;\n"),
+        std::string::npos);
+}
+
+TEST(VSISerializerTests, sorted_message_table)
+{
+    const auto out = serialize(sampleDb(), true);
+
+    EXPECT_NE(out.find("struct CanMessage can_message_array[] = {\n"
+                       "    { .canId = 0x10, .offset = 0, .count = 1 },\n"
+                       "    { .canId = 0x7ff, .offset = 1, .count = 2 },\n"
+                       "    { .canId = 0x18fef100, .offset = 3, .count = 1 "
+                       "},\n};\n"),
+        std::string::npos);
+    EXPECT_NE(out.find("const uint32_t can_message_count = 3;\n"),
+        std::string::npos);
+}
+
+TEST(VSISerializerTests, direct_index)
+{
+    const auto out = serialize(sampleDb(), true);
+    const auto begin = out.find("can_message_index[2048] = {");
+    ASSERT_NE(begin, std::string::npos);
+
+    std::vector<int> slots;
+    std::istringstream is{ out.substr(out.find('{', begin) + 1) };
+    int slot = 0;
+    char comma = 0;
+    while (is >> slot >> comma) {
+        slots.push_back(slot);
+    }
+    ASSERT_EQ(slots.size(), 2048u);
+    EXPECT_EQ(slots[0x10], 1);
+    EXPECT_EQ(slots[0x7FF], 2);
+    EXPECT_EQ(std::count(slots.begin(), slots.end(), 0), 2046);
+
+    EXPECT_EQ(serialize(sampleDb(), false).find("can_message_index"),
+        std::string::npos);
+}
+
+TEST(VSISerializerTests, float_types_from_dbc)
+{
+    CANdb::DBCParser parser;
+    ASSERT_TRUE(parser.parse(R"(VERSION ""
+
+NS_ :
+  NS_DESC
+
+BU_ :
+  NEO
+
+BO_ 256 Floats: 16 NEO
+ SG_ single : 0|32@1- (1,0) [0|0] "" NEO
+ SG_ twice : 32|64@1- (1,0) [0|0] "" NEO
+ SG_ plain : 96|8@1- (1,0) [0|0] "" NEO
+
+SIG_VALTYPE_ 256 single : 1;
+SIG_VALTYPE_ 256 twice : 2;
+)"));
+    const auto out = serialize(parser.getDb(), false);
+
+    const auto type = [&out](const std::string& name) {
+        const auto begin = out.find("\"" + name + "\"");
+        const auto at = out.find(".type = ", begin) + 8;
+        return out.substr(at, out.find('\n', at) - at);
+    };
+    EXPECT_EQ(type("single"), "SP_FLOAT");
+    EXPECT_EQ(type("twice"), "DP_FLOAT");
+    EXPECT_EQ(type("plain"), "SIGNED_INT");
+}
@@ -0,0 +1,99 @@
+#include <cxxopts.hpp>
+#include <fstream>
+#include <iostream>
+#include <spdlog/fmt/fmt.h>
+
+#include "dbcparser.h"
+#include "embedded_db.h"
+#include "log.hpp"
+
+namespace {
+std::string loadDBCFile(const std::string& filename)
+{
+    std::ifstream file{ filename, std::ios::binary };
+
+    if (!file.good()) {
+        throw std::runtime_error(
+            fmt::format("File {} does not exists", filename));
+    }
+
+    return std::string{ std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>() };
+}
+} // namespace
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+int main(int argc, char* argv[])
+{
+    cxxopts::Options options(argv[0], "compiles a dbc file into C++ tables");
+    std::string input, output, name;
+    // clang-format off
+    options.add_options()
+    ("i,input", "Input dbc file", cxxopts::value<std::string>(input), "[path to file]")
+    ("o,output", "Generated C++ source", cxxopts::value<std::string>(output), "[path to file]")
+    ("n,name", "Accessor name, CANdb::embedded::<name>()", cxxopts::value<std::string>(name), "identifier")
+    ("h,help", "show help message");
+    // clang-format on
+
+    try {
+        options.parse(argc, argv);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        std::cerr << options.help({ "" }) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (options.count("h") != 0) {
+        std::cout << options.help({ "" }) << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    if (input.empty() || output.empty() || name.empty()) {
+        std::cerr << "Input, output and name are required" << std::endl;
+        std::cerr << options.help({ "" }) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    CANdb::DBCParser parser;
+    try {
+        if (!parser.parse(loadDBCFile(input))) {
+            std::cerr << "Unable to parse " << input << std::endl;
+            return EXIT_FAILURE;
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const auto source
+        = CANdb::generateEmbeddedSource(parser.getDb(), name, input);
+    std::ofstream file{ output, std::ios::binary };
+    file << source;
+    if (!file.good()) {
+        std::cerr << "Unable to write " << output << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,87 @@
+#include <cxxopts.hpp>
+#include <fstream>
+#include <iostream>
+
+#include "dbc_generator.h"
+#include "log.hpp"
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+int main(int argc, char* argv[])
+{
+    cxxopts::Options options(argv[0], "synthetic dbc generator");
+    CANdb::GeneratorOptions generator;
+    std::size_t messages, signals, ecus, commentLength;
+    std::uint32_t seed;
+    // clang-format off
+    options.add_options()
+    ("o,output", "Output file, stdout by default", cxxopts::value<std::string>(), "[path to file]")
+    ("m,messages", "Number of messages", cxxopts::value<std::size_t>(messages)->default_value("100"), "count")
+    ("s,signals", "Signals per message", cxxopts::value<std::size_t>(signals)->default_value("8"), "count")
+    ("e,ecus", "Number of ECUs", cxxopts::value<std::size_t>(ecus)->default_value("16"), "count")
+    ("x,multiplexed", "Ratio of multiplexed messages", cxxopts::value<double>(generator.multiplexedRatio)->default_value("0"), "[0-1]")
+    ("c,comments", "Ratio of messages and signals with CM_", cxxopts::value<double>(generator.commentRatio)->default_value("0"), "[0-1]")
+    ("a,attributes", "Ratio of messages and signals with BA_", cxxopts::value<double>(generator.attributeRatio)->default_value("0"), "[0-1]")
+    ("v,values", "Ratio of signals with VAL_", cxxopts::value<double>(generator.valueTableRatio)->default_value("0"), "[0-1]")
+    ("l,comment-length", "Characters per comment", cxxopts::value<std::size_t>(commentLength)->default_value("80"), "count")
+    ("r,crlf", "Use CRLF line endings")
+    ("seed", "Random seed", cxxopts::value<std::uint32_t>(seed)->default_value("1"), "number")
+    ("h,help", "show help message");
+    // clang-format on
+
+    try {
+        options.parse(argc, argv);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        std::cerr << options.help({ "" }) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (options.count("h") != 0) {
+        std::cout << options.help({ "" }) << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    generator.messages = messages;
+    generator.signalsPerMessage = signals;
+    generator.ecus = ecus;
+    generator.commentLength = commentLength;
+    generator.crlf = options.count("r") != 0;
+    generator.seed = seed;
+
+    const auto dbc = CANdb::generateDbc(generator);
+    if (options.count("o") == 0) {
+        std::cout << dbc;
+        return EXIT_SUCCESS;
+    }
+
+    const auto path = options["o"].as<std::string>();
+    std::ofstream file{ path, std::ios::binary };
+    file << dbc;
+    if (!file.good()) {
+        std::cerr << "Unable to write " << path << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
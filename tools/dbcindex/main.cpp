@@ -0,0 +1,243 @@
+#include <chrono>
+#include <cxxopts.hpp>
+#include <fstream>
+#include <iostream>
+#include <spdlog/fmt/fmt.h>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#include "dbcparser.h"
+#include "log.hpp"
+#include "signal_index.h"
+
+namespace {
+std::string loadDBCFile(const std::string& filename)
+{
+    const std::string path = filename;
+
+    std::fstream file{ path.c_str() };
+
+    if (!file.good()) {
+        throw std::runtime_error(
+            fmt::format("File {} does not exists", filename));
+    }
+
+    std::string buff;
+    std::copy(std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>(), std::back_inserter(buff));
+
+    file.close();
+    return buff;
+}
+
+bool hasDbcExtension(const std::string& path)
+{
+    if (path.size() < 4) {
+        return false;
+    }
+    auto ext = path.substr(path.size() - 4);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".dbc";
+}
+
+// Expands directories (recursively on POSIX) into the *.dbc files they hold
+void collectFiles(const std::string& path, std::vector<std::string>& files)
+{
+#ifndef _WIN32
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+        auto dir = opendir(path.c_str());
+        if (dir == nullptr) {
+            cdb_warn("Unable to open directory {}", path);
+            return;
+        }
+        std::vector<std::string> entries;
+        while (auto entry = readdir(dir)) {
+            const std::string name{ entry->d_name };
+            if (name != "." && name != "..") {
+                entries.push_back(path + "/" + name);
+            }
+        }
+        closedir(dir);
+
+        std::sort(entries.begin(), entries.end());
+        for (const auto& entry : entries) {
+            if (stat(entry.c_str(), &st) == 0
+                && (S_ISDIR(st.st_mode) || hasDbcExtension(entry))) {
+                collectFiles(entry, files);
+            }
+        }
+        return;
+    }
+#endif
+    files.push_back(path);
+}
+
+std::string hexId(std::uint32_t id)
+{
+    return fmt::format("0x{:X}", id & 0x7FFFFFFF);
+}
+
+unsigned parseKinds(const std::string& kinds)
+{
+    if (kinds.empty() || kinds == "all") {
+        return CANdb::kAllKinds;
+    }
+    unsigned mask = 0;
+    std::size_t start = 0;
+    while (start <= kinds.size()) {
+        auto end = kinds.find(',', start);
+        if (end == std::string::npos) {
+            end = kinds.size();
+        }
+        const auto kind = kinds.substr(start, end - start);
+        bool found = false;
+        for (auto k : { CANdb::IndexKind::Message, CANdb::IndexKind::Signal,
+                 CANdb::IndexKind::Ecu, CANdb::IndexKind::Unit }) {
+            if (kind == CANdb::toString(k)) {
+                mask |= CANdb::kindBit(k);
+                found = true;
+            }
+        }
+        if (!found) {
+            throw std::runtime_error(fmt::format("Unknown kind {}", kind));
+        }
+        start = end + 1;
+    }
+    return mask;
+}
+} // namespace
+
+std::shared_ptr<spdlog::logger> kDefaultLogger
+    = []() -> std::shared_ptr<spdlog::logger> {
+    auto z = std::getenv("CDB_LEVEL");
+    auto logger = spdlog::stdout_color_mt("cdb");
+
+    if (z == nullptr) {
+        logger->set_level(spdlog::level::err);
+    } else {
+        const std::string ll{ z };
+
+        auto it = std::find_if(std::begin(spdlog::level::level_names),
+            std::end(spdlog::level::level_names),
+            [&ll](const char* name) { return std::string{ name } == ll; });
+
+        if (it != std::end(spdlog::level::level_names)) {
+            int i = std::distance(std::begin(spdlog::level::level_names), it);
+            logger->set_level(static_cast<spdlog::level::level_enum>(i));
+        }
+    }
+
+    return logger;
+}();
+
+int main(int argc, char* argv[])
+{
+    cxxopts::Options options(argv[0], "dbc cross-file search index");
+    std::string output;
+    std::string index;
+    std::string kinds;
+    // clang-format off
+    options.add_options()
+    ("i,input", "DBC files or directories to index", cxxopts::value<std::vector<std::string>>(), "[path]")
+    ("o,output", "Write index to file", cxxopts::value<std::string>(output), "[path to index]")
+    ("x,index", "Index to query", cxxopts::value<std::string>(index), "[path to index]")
+    ("q,query", "Glob pattern, e.g. *WHEEL_SPEED*", cxxopts::value<std::string>(), "pattern")
+    ("k,kind", "Restrict query to kinds", cxxopts::value<std::string>(kinds)->default_value("all"), "[message,signal,ecu,unit]")
+    ("h,help", "show help message");
+    // clang-format on
+    options.parse_positional({ "input" });
+
+    try {
+        options.parse(argc, argv);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        std::cerr << options.help({ "" }) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (options.count("h") != 0) {
+        std::cout << options.help({ "" }) << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    try {
+        if (options.count("o") != 0) {
+            std::vector<std::string> files;
+            if (options.count("i") != 0) {
+                for (const auto& path :
+                    options["i"].as<std::vector<std::string>>()) {
+                    collectFiles(path, files);
+                }
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            CANdb::SignalIndexBuilder builder;
+            std::size_t failed = 0;
+            for (const auto& file : files) {
+                CANdb::DBCParser parser;
+                if (!parser.parse(loadDBCFile(file))) {
+                    cdb_error("Unable to parse {}", file);
+                    ++failed;
+                    continue;
+                }
+                builder.add(file, parser.getDb());
+            }
+            builder.write(output);
+
+            const std::chrono::duration<double, std::milli> elapsed
+                = std::chrono::steady_clock::now() - start;
+            std::cout << fmt::format("Indexed {} files ({} failed) into {} in "
+                                     "{:.1f} ms",
+                             files.size() - failed, failed, output,
+                             elapsed.count())
+                      << std::endl;
+            if (failed != 0) {
+                return EXIT_FAILURE;
+            }
+        }
+
+        if (options.count("q") != 0) {
+            if (index.empty()) {
+                index = output;
+            }
+            if (index.empty()) {
+                std::cerr << options.help({ "" }) << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            const auto db = CANdb::SignalIndex::load(index);
+            const auto hits
+                = db.query(options["q"].as<std::string>(), parseKinds(kinds));
+            const std::chrono::duration<double, std::milli> elapsed
+                = std::chrono::steady_clock::now() - start;
+
+            for (const auto& hit : hits) {
+                std::cout << fmt::format("{}: {:<8} {}", hit.file,
+                    CANdb::toString(hit.kind), hit.name);
+                if (hit.kind != CANdb::IndexKind::Ecu) {
+                    std::cout << fmt::format(" id= {}", hexId(hit.messageId));
+                }
+                if (!hit.context.empty()) {
+                    std::cout << fmt::format(" ({})", hit.context);
+                }
+                std::cout << std::endl;
+            }
+            std::cout << fmt::format("{} hits in {} files, {:.3f} ms",
+                             hits.size(), db.files(), elapsed.count())
+                      << std::endl;
+        } else if (options.count("o") == 0) {
+            std::cerr << options.help({ "" }) << std::endl;
+            return EXIT_FAILURE;
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -1,10 +1,14 @@
 #include <cxxopts.hpp>
 #include <fstream>
-#include <regex>
+#include <sstream>
 #include <spdlog/fmt/fmt.h>
 
 #include "Resource.h"
+#include "alloc_counter.h"
 #include "dbcparser.h"
+#include "footprint.h"
+#include "id_filter.h"
+#include "layout_check.h"
 #include "log.hpp"
 #include "termcolor.hpp"
 
@@ -64,19 +68,18 @@ std::string dumpSignal(const CANsignal& sig)
         sig.startBit, sig.signalSize);
 }
 
-std::string dumpMessages(
-    const CANdb_t& dbc, const std::string& regex, bool dumpMessages = false)
+std::string dumpMessages(const CANdb_t& dbc, const CANdb::IdFilter& filter,
+    bool dumpMessages = false)
 {
     std::string buff;
     buff += "messages: \n";
     for (const auto& msg : dbc.messages) {
-        const bool isMatch
-            = std::regex_match(msg.first.name, std::regex{ regex });
-        if (isMatch) {
-            buff += fmt::format("  id= {}, name= {:<30}, dlc= {}, ecu={} \n",
-                green(msg.first.id), red(msg.first.name), blue(msg.first.dlc),
-                magenta(msg.first.ecu));
+        if (!filter.accepts(msg.first)) {
+            continue;
         }
+        buff += fmt::format("  id= {}, name= {:<30}, dlc= {}, ecu={} \n",
+            green(msg.first.id), red(msg.first.name), blue(msg.first.dlc),
+            magenta(msg.first.ecu));
 
         if (dumpMessages) {
             for (const auto& signal : msg.second) {
@@ -86,8 +89,133 @@ std::string dumpMessages(
     }
     return buff;
 }
+
+std::string dumpLayoutIssues(const std::vector<CANdb::LayoutIssue>& issues)
+{
+    std::string buff;
+    for (const auto& issue : issues) {
+        buff += fmt::format("  {:<18} id= {}, message= {}, signal= {}",
+            red(CANdb::toString(issue.kind)), green(issue.messageId),
+            issue.message, blue(issue.signal));
+        if (!issue.other.empty()) {
+            buff += fmt::format(", with= {}", blue(issue.other));
+        }
+        buff += fmt::format(", bits= {}..{}\n", issue.firstBit, issue.lastBit);
+    }
+    return buff;
+}
+
+std::string dumpProfile(const CANdb::ParseProfile& profile,
+    const std::string& data, std::size_t maxLines = 20)
+{
+    std::string buff = fmt::format(
+        "Parsed in {:.3f} ms\n{:<22} {:>10} {:>10} {:>10} {:>11} {:>11} {:>6}\n",
+        profile.totalMs, "rule", "attempts", "successes", "failures",
+        "total ms", "self ms", "self%");
+    for (const auto& rule : profile.rules) {
+        buff += fmt::format(
+            "{:<22} {:>10} {:>10} {:>10} {:>11.3f} {:>11.3f} {:>6.1f}\n",
+            rule.rule, rule.attempts, rule.successes, rule.failures,
+            rule.totalMs, rule.selfMs,
+            profile.totalMs > 0 ? 100 * rule.selfMs / profile.totalMs : 0.0);
+    }
+
+    std::vector<std::string> lines;
+    std::istringstream ss{ data };
+    for (std::string line; std::getline(ss, line);) {
+        lines.push_back(line);
+    }
+
+    buff += "\nBacktracking hot spots:\n";
+    for (std::size_t i = 0; i < profile.lines.size() && i < maxLines; ++i) {
+        const auto& spot = profile.lines[i];
+        auto text = spot.line <= lines.size() ? lines[spot.line - 1] : "";
+        if (text.size() > 60) {
+            text = text.substr(0, 57) + "...";
+        }
+        buff += fmt::format("  line {:>7} {:>10} failures  {}\n",
+            spot.line, spot.failures, text);
+    }
+    return buff;
+}
+
+std::string dumpAttributes(const CANdb::AttributeStore& attributes)
+{
+    std::string buff = fmt::format("{} attribute definitions, {} values:\n",
+        attributes.definitions().size(), attributes.size());
+    for (const auto& def : attributes.definitions()) {
+        std::string defaultValue = "-";
+        if (def.hasDefault) {
+            const auto& value = def.defaultValue;
+            defaultValue = def.type == CANdb::AttributeType::String
+                    || def.type == CANdb::AttributeType::Enum
+                ? value.text
+                : fmt::format("{}", value.real);
+        }
+        buff += fmt::format("  {:<30} {:<8} {:<20} default= {}\n",
+            def.name, CANdb::toString(def.type),
+            CANdb::toString(def.kind), defaultValue);
+    }
+    return buff;
+}
+
+// Compiler style "file:line:column: error: ..." lines with the source line
+std::string dumpDiagnostics(const std::string& file, const std::string& data,
+    const std::vector<CANdb::Diagnostic>& diagnostics)
+{
+    std::vector<std::string> lines;
+    std::istringstream ss{ data };
+    for (std::string line; std::getline(ss, line);) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        lines.push_back(line);
+    }
+
+    std::string buff;
+    for (const auto& d : diagnostics) {
+        buff += fmt::format("{}:{}:{}: {} {}{}\n", file, d.line, d.column,
+            red("error:"), d.rule.empty() ? "" : "[" + d.rule + "] ",
+            d.message);
+        if (d.line > 0 && d.line <= lines.size()) {
+            buff += fmt::format("  {}\n", lines[d.line - 1]);
+        }
+    }
+    buff += fmt::format("{} error(s)\n", diagnostics.size());
+    return buff;
+}
+
+std::string dumpFootprint(const CANdb_t& db, std::size_t parsePeak,
+    std::uint64_t parseAllocations)
+{
+    std::size_t signals = 0;
+    for (const auto& msg : db.messages) {
+        signals += msg.second.size();
+    }
+
+    const auto fp = CANdb::footprint(db);
+    std::string buff = fmt::format(
+        "Footprint of {} messages, {} signals:\n", db.messages.size(), signals);
+    for (const auto& row :
+        { std::make_pair("database", fp.database),
+            std::make_pair("message nodes", fp.messageNodes),
+            std::make_pair("signal vectors", fp.signalVectors),
+            std::make_pair("value tables", fp.valueTables),
+            std::make_pair("symbols", fp.symbols),
+            std::make_pair("string heap", fp.stringHeap),
+            std::make_pair("total", fp.total()) }) {
+        buff += fmt::format("  {:<16} {:>12} bytes\n", row.first, row.second);
+    }
+    buff += fmt::format("  strings {}, on heap {}, sso {}\n", fp.strings,
+        fp.heapStrings, fp.strings - fp.heapStrings);
+    buff += fmt::format("Parse peak heap {} bytes in {} allocations\n",
+        parsePeak, parseAllocations);
+    return buff;
+}
 } // namespace
 
+CANDB_COUNTING_OPERATOR_NEW
+
 std::shared_ptr<spdlog::logger> kDefaultLogger
     = []() -> std::shared_ptr<spdlog::logger> {
     auto z = std::getenv("CDB_LEVEL");
@@ -121,6 +249,11 @@ int main(int argc, char* argv[])
     ("d, dump-peg", "Dump DBC grammar")
     ("m, messages", "Dump messages from DBC")
     ("t, tree", "Dump messages and signals")
+    ("l, layout", "Check signals for overlaps, dlc overruns and byte order")
+    ("p, profile", "Profile grammar rules and show backtracking hot spots")
+    ("s, stats", "Show memory footprint of the database and peak parse memory")
+    ("a, attributes", "Dump attribute definitions and defaults")
+    ("e, max-errors", "Stop after this many syntax errors", cxxopts::value<std::size_t>()->default_value("100"), "count")
     ("f, filter", "filter by messages/signals", cxxopts::value<std::string>(regex)->default_value(".*"), "regexp")
     ("h,help", "show help message");
     // clang-format on
@@ -159,16 +292,49 @@ int main(int argc, char* argv[])
     try {
         CANdb::DBCParser parser;
         const auto file = options["i"].as<std::string>();
-        success = parser.parse(loadDBCFile(file));
+        const auto data = loadDBCFile(file);
+        parser.enableProfiling(options.count("p") != 0);
+        parser.enableRecovery(true, options["e"].as<std::size_t>());
+        const CANdb::AllocationScope allocations;
+        success = parser.parse(data);
+        const auto parsePeak = allocations.peakBytes();
+        const auto parseAllocations = allocations.allocations();
+
+        if (options.count("p")) {
+            std::cout << dumpProfile(parser.profile(), data);
+        }
 
         if (success) {
             std::cout << fmt::format("DBC file {} successfully parsed", file)
                       << std::endl;
+        } else {
+            std::cerr << dumpDiagnostics(file, data, parser.diagnostics());
+        }
+        if (options.count("a")) {
+            std::cout << dumpAttributes(parser.attributes());
+        }
+        if (options.count("s")) {
+            std::cout << dumpFootprint(
+                parser.getDb(), parsePeak, parseAllocations);
         }
-        if (options.count("m")) {
-            std::cout << dumpMessages(parser.getDb(), regex);
-        } else if (options.count("t")) {
-            std::cout << dumpMessages(parser.getDb(), regex, true);
+        if (options.count("m") || options.count("t")) {
+            const auto db = parser.getDb();
+            CANdb::FilterPredicates predicates;
+            predicates.namePatterns.push_back(regex);
+            const CANdb::IdFilter filter{ predicates, db };
+            std::cout << dumpMessages(db, filter, options.count("m") == 0);
+        }
+
+        if (success && options.count("l")) {
+            const auto issues = CANdb::checkLayout(parser.getDb());
+            if (issues.empty()) {
+                std::cout << "Signal layout OK" << std::endl;
+            } else {
+                std::cout << fmt::format(
+                    "{} signal layout issues:\n{}", issues.size(),
+                    dumpLayoutIssues(issues));
+                success = false;
+            }
         }
 
     } catch (const std::exception& ex) {
@@ -0,0 +1,323 @@
+#include "batch_converter.hpp"
+#include "dbcparser.h"
+#include "input_stream.h"
+#include "log.hpp"
+#include "stream_writer.h"
+#include "vsi_serializer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <spdlog/fmt/fmt.h>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double msSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start)
+        .count();
+}
+
+std::string lower(std::string s)
+{
+    std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+    return s;
+}
+
+bool endsWith(const std::string& s, const std::string& suffix)
+{
+    return s.size() >= suffix.size()
+        && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Length of a compression suffix openInput() decompresses, 0 if none
+std::size_t compressionSuffix(const std::string& path)
+{
+    const auto name = lower(path);
+    if (endsWith(name, ".gz")) {
+        return 3;
+    }
+    return endsWith(name, ".zst") ? 4 : 0;
+}
+
+bool hasDbcExtension(const std::string& path)
+{
+    const auto name = lower(path);
+    return endsWith(name.substr(0, name.size() - compressionSuffix(name)),
+        ".dbc");
+}
+
+void collectFiles(const std::string& path, std::vector<std::string>& files)
+{
+#ifndef _WIN32
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+        auto dir = opendir(path.c_str());
+        if (dir == nullptr) {
+            cdb_warn("Unable to open directory {}", path);
+            return;
+        }
+        std::vector<std::string> entries;
+        while (auto entry = readdir(dir)) {
+            const std::string name{ entry->d_name };
+            if (name != "." && name != "..") {
+                entries.push_back(path + "/" + name);
+            }
+        }
+        closedir(dir);
+
+        // Symlinked directories are not followed, they may form a loop
+        std::sort(entries.begin(), entries.end());
+        for (const auto& entry : entries) {
+            if (lstat(entry.c_str(), &st) != 0) {
+                continue;
+            }
+            if (S_ISLNK(st.st_mode)
+                && (stat(entry.c_str(), &st) != 0 || S_ISDIR(st.st_mode))) {
+                continue;
+            }
+            if (S_ISDIR(st.st_mode) || hasDbcExtension(entry)) {
+                collectFiles(entry, files);
+            }
+        }
+        return;
+    }
+#endif
+    files.push_back(path);
+}
+
+const char* extension(OutputFormat format)
+{
+    switch (format) {
+    case OutputFormat::Xml:
+        return ".xml";
+    case OutputFormat::Cvsi:
+        return ".c";
+    default:
+        return ".json";
+    }
+}
+
+std::string fileName(const std::string& path)
+{
+    const auto slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+// Hidden and unique per process, in the target's directory for rename()
+std::string temporaryPath(const std::string& dir, const std::string& name)
+{
+#ifndef _WIN32
+    const auto pid = static_cast<long>(getpid());
+#else
+    const long pid = 0;
+#endif
+    return fmt::format("{}/.{}.{}.tmp", dir, name, pid);
+}
+
+// State a worker keeps from one file to the next
+struct Worker {
+    CANdb::DBCParser parser;
+    CANdb::OutputBuffer buffer;
+    std::string input;
+};
+
+void readFile(const std::string& path, std::string& buffer)
+{
+    const auto input = CANdb::openInput(path);
+    CANdb::readAll(*input, buffer);
+}
+
+void writeFile(const std::string& temp, const std::string& target,
+    OutputFormat format, const CANdb_t& db, Worker& worker,
+    BatchResult& result)
+{
+    {
+        std::ofstream file{ temp, std::ios::binary | std::ios::trunc };
+        if (!file.good()) {
+            throw std::runtime_error(
+                fmt::format("Unable to create {}", temp));
+        }
+        if (format == OutputFormat::Cvsi) {
+            VSISerializer ar{ file };
+            ar(db);
+        } else {
+            worker.buffer.clear();
+            if (format == OutputFormat::Xml) {
+                CANdb::writeXml(db, worker.buffer);
+            } else {
+                CANdb::writeJson(db, worker.buffer);
+            }
+            const auto& data = worker.buffer.str();
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        }
+        result.bytesOut = static_cast<std::size_t>(file.tellp());
+        file.close();
+        if (file.fail()) {
+            std::remove(temp.c_str());
+            throw std::runtime_error(fmt::format("Unable to write {}", temp));
+        }
+    }
+
+#ifdef _WIN32
+    std::remove(target.c_str());
+#endif
+    if (std::rename(temp.c_str(), target.c_str()) != 0) {
+        std::remove(temp.c_str());
+        throw std::runtime_error(
+            fmt::format("Unable to rename {} to {}", temp, target));
+    }
+}
+
+void convert(const std::string& outputDir, OutputFormat format,
+    Worker& worker, BatchResult& result)
+{
+    auto start = Clock::now();
+    readFile(result.input, worker.input);
+    result.bytesIn = worker.input.size();
+    result.readMs = msSince(start);
+
+    start = Clock::now();
+    if (!worker.parser.parse(worker.input)) {
+        const auto& diagnostics = worker.parser.diagnostics();
+        throw std::runtime_error(diagnostics.empty()
+                ? std::string{ "parse failed" }
+                : fmt::format("parse failed at line {}: {}",
+                      diagnostics.front().line, diagnostics.front().message));
+    }
+    const auto& db = worker.parser.getDb();
+    result.parseMs = msSince(start);
+
+    start = Clock::now();
+    const auto name = fileName(result.output);
+    writeFile(temporaryPath(outputDir, name), result.output, format, db,
+        worker, result);
+    result.writeMs = msSince(start);
+}
+} // namespace
+
+BatchConverter::BatchConverter(std::string outputDir, OutputFormat format,
+    unsigned jobs, CANdb::TextEncoding encoding)
+    : _outputDir(std::move(outputDir))
+    , _format(format)
+    , _jobs(jobs)
+    , _encoding(encoding)
+{
+}
+
+std::vector<std::string> BatchConverter::collect(
+    const std::vector<std::string>& paths)
+{
+    std::vector<std::string> files;
+    for (const auto& path : paths) {
+        collectFiles(path, files);
+    }
+    return files;
+}
+
+std::string BatchConverter::outputPath(const std::string& input) const
+{
+    auto name = fileName(input);
+    name.resize(name.size() - compressionSuffix(name));
+    const auto dot = name.find_last_of('.');
+    if (dot != std::string::npos && dot != 0) {
+        name.resize(dot);
+    }
+    return _outputDir + "/" + name + extension(_format);
+}
+
+std::vector<BatchResult> BatchConverter::run(
+    const std::vector<std::string>& files) const
+{
+#ifndef _WIN32
+    if (mkdir(_outputDir.c_str(), 0777) == 0) {
+        cdb_info("Created output directory {}", _outputDir);
+    }
+#endif
+
+    // Two inputs with the same name would overwrite each other's output
+    std::vector<BatchResult> results(files.size());
+    std::map<std::string, std::size_t> targets;
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        results[i].input = files[i];
+        const auto target = outputPath(files[i]);
+        const auto it = targets.emplace(target, i);
+        if (it.second) {
+            results[i].output = target;
+        } else {
+            results[i].error = fmt::format("{} is already written from {}",
+                target, files[it.first->second]);
+        }
+    }
+
+    auto threads = _jobs;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::max(1u, std::min<unsigned>(threads, files.size()));
+
+    std::atomic<std::size_t> next{ 0 };
+    const auto work = [&]() {
+        Worker worker;
+        worker.parser.setEncoding(_encoding);
+        for (auto i = next++; i < files.size(); i = next++) {
+            auto& result = results[i];
+            if (result.output.empty()) {
+                continue;
+            }
+            try {
+                convert(_outputDir, _format, worker, result);
+            } catch (const std::exception& ex) {
+                result.output.clear();
+                result.error = ex.what();
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads; ++i) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    return results;
+}
+
+std::string summary(const std::vector<BatchResult>& results, double totalMs)
+{
+    std::string out = fmt::format("{:<40} {:>9} {:>9} {:>9} {:>9}  {}\n",
+        "input", "KiB", "read ms", "parse ms", "write ms", "output");
+
+    std::size_t failed = 0;
+    std::size_t bytes = 0;
+    double parseMs = 0;
+    for (const auto& r : results) {
+        out += fmt::format("{:<40} {:>9.1f} {:>9.2f} {:>9.2f} {:>9.2f}  {}\n",
+            r.input, r.bytesIn / 1024.0, r.readMs, r.parseMs, r.writeMs,
+            r.output.empty() ? "FAILED: " + r.error : r.output);
+        failed += r.output.empty() ? 1 : 0;
+        bytes += r.bytesIn;
+        parseMs += r.parseMs;
+    }
+
+    out += fmt::format("Converted {} files ({} failed), {:.1f} MiB in "
+                       "{:.1f} ms ({:.1f} ms parsing)\n",
+        results.size() - failed, failed, bytes / (1024.0 * 1024.0), totalMs,
+        parseMs);
+    return out;
+}
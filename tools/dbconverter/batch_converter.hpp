@@ -0,0 +1,60 @@
+#ifndef BATCH_CONVERTER_HPP_R7WQ2KXD
+#define BATCH_CONVERTER_HPP_R7WQ2KXD
+
+#include "text_normalizer.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+enum class OutputFormat { Json, Xml, Cvsi };
+
+// Outcome of one input file, times in milliseconds
+struct BatchResult {
+    std::string input;
+    std::string output; // empty if the conversion failed
+    std::string error;
+    std::size_t bytesIn{ 0 };
+    std::size_t bytesOut{ 0 };
+    double readMs{ 0 };
+    double parseMs{ 0 };
+    double writeMs{ 0 };
+};
+
+/**
+ * Converts many DBC files within one process. Every worker keeps its parser,
+ * whose grammar is loaded once, and its input and output buffers for all
+ * files it takes. Outputs are written to a hidden temporary file in the
+ * output directory and renamed over the target, so readers never see a
+ * partial file and a failed conversion leaves the previous output alone.
+ */
+class BatchConverter {
+public:
+    // jobs == 0 uses one worker per hardware thread, every input is read
+    // with encoding
+    BatchConverter(std::string outputDir, OutputFormat format, unsigned jobs,
+        CANdb::TextEncoding encoding = CANdb::TextEncoding::Utf8);
+
+    // Expands directories (recursively on POSIX) into their *.dbc files,
+    // also gzip or zstd compressed ones
+    static std::vector<std::string> collect(
+        const std::vector<std::string>& paths);
+
+    // Results in the order of files
+    std::vector<BatchResult> run(const std::vector<std::string>& files) const;
+
+    // Output path of input, the file name without its compression suffix
+    // and with the format's extension
+    std::string outputPath(const std::string& input) const;
+
+private:
+    std::string _outputDir;
+    OutputFormat _format;
+    unsigned _jobs;
+    CANdb::TextEncoding _encoding;
+};
+
+// Table of per-file timings followed by the totals
+std::string summary(const std::vector<BatchResult>& results, double totalMs);
+
+#endif /* end of include guard: BATCH_CONVERTER_HPP_R7WQ2KXD */
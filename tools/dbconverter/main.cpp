@@ -1,8 +1,12 @@
+#include <chrono>
 #include <fstream>
 #include <iostream>
 
+#include "batch_converter.hpp"
 #include "dbcparser.h"
+#include "input_stream.h"
 #include "log.hpp"
+#include "stream_writer.h"
 #include "vsi_serializer.hpp"
 
 #include <cereal/archives/binary.hpp>
@@ -14,31 +18,95 @@
 #include <cxxopts.hpp>
 #include <spdlog/fmt/fmt.h>
 
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
 namespace {
+// Plain, gzip or zstd compressed
 std::string loadDBCFile(const std::string& filename)
 {
-    const std::string path = filename;
+    return CANdb::readAll(*CANdb::openInput(filename));
+}
 
-    std::fstream file{ path.c_str() };
+template <typename Archive>
+void serialize(const std::string& filename, const CANdb_t& db)
+{
+    Archive ar{ std::cout };
+    ar(db);
+}
 
-    if (!file.good()) {
-        throw std::runtime_error(
-            fmt::format("File {} does not exists", filename));
+// Same output as the cereal archives, streamed to stdout with write(2)
+void stream(const CANdb_t& db, bool xml)
+{
+#ifndef _WIN32
+    std::cout.flush();
+    CANdb::OutputBuffer out{ STDOUT_FILENO };
+    if (xml) {
+        CANdb::writeXml(db, out);
+    } else {
+        CANdb::writeJson(db, out);
     }
+    out.flush();
+#else
+    if (xml) {
+        serialize<cereal::XMLOutputArchive>("dbc.xml", db);
+    } else {
+        serialize<cereal::JSONOutputArchive>("dbc.json", db);
+    }
+#endif
+}
 
-    std::string buff;
-    std::copy(std::istreambuf_iterator<char>(file),
-        std::istreambuf_iterator<char>(), std::back_inserter(buff));
-
-    file.close();
-    return buff;
+// false for an encoding name the converter does not know
+bool parseEncoding(const std::string& name, CANdb::TextEncoding& encoding)
+{
+    if (name == "utf8") {
+        encoding = CANdb::TextEncoding::Utf8;
+    } else if (name == "cp1252") {
+        encoding = CANdb::TextEncoding::Windows1252;
+    } else if (name == "detect") {
+        encoding = CANdb::TextEncoding::Detect;
+    } else {
+        std::cerr << fmt::format("Encoding {} is not supported", name)
+                  << std::endl;
+        return false;
+    }
+    return true;
 }
 
-template <typename Archive>
-void serialize(const std::string& filename, CANdb_t& db)
+int batch(cxxopts::Options& options, CANdb::TextEncoding encoding)
 {
-    Archive ar{ std::cout };
-    ar(db);
+    if (options.count("o") == 0) {
+        std::cerr << options.help({ "" }) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const auto name = options["f"].as<std::string>();
+    OutputFormat format;
+    if (name == "json") {
+        format = OutputFormat::Json;
+    } else if (name == "xml") {
+        format = OutputFormat::Xml;
+    } else if (name == "cvsi") {
+        format = OutputFormat::Cvsi;
+    } else {
+        std::cerr << fmt::format("Format {} is not supported by --batch", name)
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const BatchConverter converter{ options["o"].as<std::string>(), format,
+        options["j"].as<unsigned>(), encoding };
+    const auto results = converter.run(BatchConverter::collect(
+        options["b"].as<std::vector<std::string>>()));
+    const std::chrono::duration<double, std::milli> elapsed
+        = std::chrono::steady_clock::now() - start;
+
+    std::cout << summary(results, elapsed.count());
+    const auto failed = std::count_if(results.begin(), results.end(),
+        [](const BatchResult& r) { return r.output.empty(); });
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
 } // namespace
@@ -72,8 +140,13 @@ int main(int argc, char* argv[])
     // clang-format off
     options.add_options()
     ("i,input", "Input file",cxxopts::value<std::string>(),"[path to file]")
+    ("b,batch", "Convert files and directories of *.dbc(.gz|.zst) files into --output", cxxopts::value<std::vector<std::string>>(), "[paths]")
+    ("o,output", "Output directory of --batch", cxxopts::value<std::string>(), "[directory]")
+    ("j,jobs", "Worker threads of --batch, 0 for one per core", cxxopts::value<unsigned>()->default_value("0"))
     ("d, debug", "Enable debug output")
     ("f, format", "Format to use", cxxopts::value<std::string>()->default_value("json"),"[xml|json|binary|cvsi]")
+    ("n,no-index", "cvsi: omit the can_message_index table of 11-bit ids")
+    ("e,encoding", "Encoding of --input and --batch files, detect picks cp1252 unless it is UTF-8", cxxopts::value<std::string>()->default_value("utf8"), "[utf8|cp1252|detect]")
     ("h,help", "show help message");
     // clang-format on
 
@@ -88,21 +161,33 @@ int main(int argc, char* argv[])
         kDefaultLogger->set_level(spdlog::level::debug);
     }
 
+    CANdb::TextEncoding encoding;
+    if (!parseEncoding(options["e"].as<std::string>(), encoding)) {
+        return EXIT_FAILURE;
+    }
+
+    if (options.count("b") != 0) {
+        return batch(options, encoding);
+    }
+
     if (options.count("i") == 0) {
         std::cerr << options.help({ "" }) << std::endl;
         return EXIT_FAILURE;
     }
 
+    CANdb::DBCParser parser;
+    parser.setEncoding(encoding);
+
     try {
-        CANdb::DBCParser parser;
         parser.parse(loadDBCFile(options["i"].as<std::string>()));
-        auto db = parser.getDb();
+        const auto& db = parser.getDb();
         if (options["f"].as<std::string>() == "xml") {
-            serialize<cereal::XMLOutputArchive>("dbc.xml", db);
+            stream(db, true);
         } else if (options["f"].as<std::string>() == "json") {
-            serialize<cereal::JSONOutputArchive>("dbc.json", db);
+            stream(db, false);
         } else if (options["f"].as<std::string>() == "cvsi") {
-            serialize<VSISerializer>("dbc.c", db);
+            VSISerializer ar{ std::cout, options.count("n") == 0 };
+            ar(db);
         } else {
             // serialize<cereal::BinaryOutputArchive>("dbc.bin", db);
         }
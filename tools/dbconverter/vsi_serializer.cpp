@@ -1,80 +1,146 @@
 #include "vsi_serializer.hpp"
 #include "cantypes.hpp"
+#include "stream_writer.h"
 
-#include <spdlog/fmt/fmt.h>
+#include <cstring>
+#include <vector>
 
-std::string getType(const CANsignal& signal)
+namespace {
+constexpr std::uint32_t kDirectIndexSize = 2048;
+
+const char* getType(const CANsignal& signal)
 {
-    if (signal.byteOrder < 2) {
-        if (signal.value_type == "+") {
-            return "UNSIGNED_INT";
-        }
-        return "SIGNED_INT";
-    }
-    switch (signal.byteOrder) {
-    case 2:
-        return "SP_FLOAT";
-        break;
-    case 3:
-        return "DP_FLOAT";
-        break;
-    case 4:
+    switch (signal.type) {
+    case CANsignalType::Float:
+        return signal.signalSize == 64 ? "DP_FLOAT" : "SP_FLOAT";
+    case CANsignalType::String:
         return "STRING";
+    case CANsignalType::Int:
         break;
     }
+    return signal.value_type == "-" ? "SIGNED_INT" : "UNSIGNED_INT";
+}
 
-    throw std::runtime_error("Can't map signal to type");
-    return "";
+// Last bit of a signal in the startBit numbering of its byte order
+unsigned endBit(const CANsignal& signal)
+{
+    const unsigned size = signal.signalSize == 0 ? 1 : signal.signalSize;
+    if (signal.byteOrder == 1) {
+        return signal.startBit + size - 1;
+    }
+    // Motorola: count in big endian stream order from the MSB to the LSB
+    const unsigned msb = (signal.startBit / 8) * 8 + (7 - signal.startBit % 8);
+    const unsigned lsb = msb + size - 1;
+    return (lsb / 8) * 8 + (7 - lsb % 8);
 }
 
-std::string dumpMessages(
-    const std::map<CANmessage, std::vector<CANsignal>>& msgs)
+void append(CANdb::OutputBuffer& out, const char* text)
 {
-    std::string buff;
-    for (const auto& p : msgs) {
+    out.append(text, std::strlen(text));
+}
 
-        for (const auto& signal : p.second) {
-            auto signal_c_desc =
-                R"({{
-                .canId = 0x{can_id:x}
-                .sigId = {signal_id}
-                .sigName = "{signal_name}"
-                .start = {start},
-                .end = 0,
-                .min = {min},
-                .max = {max},
-                .type = {type}
-}},)";
-            using namespace fmt::literals;
-            auto ss = fmt::format(signal_c_desc, "can_id"_a = p.first.id,
-                "signal_id"_a = 0, "signal_name"_a = signal.signal_name,
-                "start"_a = signal.startBit, "min"_a = signal.min,
-                "max"_a = signal.max, "type"_a = getType(signal));
-            buff += ss + std::string{ "\n" };
-        }
-    }
-    return buff;
+void appendSignal(CANdb::OutputBuffer& out, std::uint32_t canId,
+    std::size_t sigId, const CANsignal& signal)
+{
+    append(out, "    {\n        .canId = 0x");
+    out.appendHex(canId);
+    append(out, ",\n        .sigId = ");
+    out.appendUnsigned(sigId);
+    append(out, ",\n        .sigName = \"");
+    out.append(signal.signal_name);
+    append(out, "\",\n        .start = ");
+    out.appendUnsigned(signal.startBit);
+    append(out, ",\n        .end = ");
+    out.appendUnsigned(endBit(signal));
+    append(out, ",\n        .min = ");
+    out.appendSigned(signal.min);
+    append(out, ",\n        .max = ");
+    out.appendSigned(signal.max);
+    append(out, ",\n        .type = ");
+    append(out, getType(signal));
+    append(out, "\n    },\n");
 }
+} // namespace
 
-VSISerializer::VSISerializer(std::ostream& os)
+VSISerializer::VSISerializer(std::ostream& os, bool directIndex)
     : _os(os)
+    , _directIndex(directIndex)
 {
 }
 
 void VSISerializer::operator()(const CANdb_t& db)
 {
-    const auto messages = db.messages;
-    auto dbc_c_file =
-        R"(#include <stdint.h>
-#include "can-signals.h"
+    std::size_t signalCount = 0;
+    for (const auto& msg : db.messages) {
+        signalCount += msg.second.size();
+    }
+
+    // Sized for the whole file up front, so the buffer never reallocates
+    // for typical names
+    CANdb::OutputBuffer out{ 512 + signalCount * 256
+        + db.messages.size() * 64 + (_directIndex ? kDirectIndexSize * 8 : 0) };
+
+    append(out,
+        "#include <stdint.h>\n"
+        "#include \"can-signals.h\"\n\n"
+        "#ifndef CAN_MESSAGE_DEFINED\n"
+        "#define CAN_MESSAGE_DEFINED\n"
+        "struct CanMessage {\n"
+        "    uint32_t canId;\n"
+        "    uint32_t offset; /* first signal in can_signal_array */\n"
+        "    uint32_t count;\n"
+        "};\n"
+        "#endif\n\n"
+        "struct CanSignal can_signal_array[] = {\n");
+    std::size_t sigId = 0;
+    for (const auto& msg : db.messages) {
+        for (const auto& signal : msg.second) {
+            appendSignal(out, msg.first.id, sigId++, signal);
+        }
+    }
+    append(out, "};\n\n");
+
+    // Map order is id order, so the table is sorted for a binary search
+    append(out, "struct CanMessage can_message_array[] = {\n");
+    std::vector<std::uint32_t> directIndex;
+    std::size_t offset = 0;
+    std::size_t slot = 0;
+    for (const auto& msg : db.messages) {
+        append(out, "    { .canId = 0x");
+        out.appendHex(msg.first.id);
+        append(out, ", .offset = ");
+        out.appendUnsigned(offset);
+        append(out, ", .count = ");
+        out.appendUnsigned(msg.second.size());
+        append(out, " },\n");
 
-struct CanSignal {struct_name}[] = {{
-    {messages}
-}}
-)";
+        if (_directIndex && msg.first.id < kDirectIndexSize && slot < 0xFFFF) {
+            directIndex.resize(kDirectIndexSize, 0);
+            directIndex[msg.first.id] = static_cast<std::uint32_t>(slot + 1);
+        }
+        offset += msg.second.size();
+        ++slot;
+    }
+    append(out, "};\n\n");
+
+    append(out, "const uint32_t can_signal_count = ");
+    out.appendUnsigned(signalCount);
+    append(out, ";\nconst uint32_t can_message_count = ");
+    out.appendUnsigned(db.messages.size());
+    append(out, ";\n");
+
+    if (!directIndex.empty()) {
+        append(out,
+            "\n/* can_message_array slot + 1 of every 11-bit id, 0 if "
+            "unknown */\n"
+            "const uint16_t can_message_index[2048] = {");
+        for (std::size_t i = 0; i < directIndex.size(); ++i) {
+            append(out, i % 16 == 0 ? "\n    " : " ");
+            out.appendUnsigned(directIndex[i]);
+            out.put(',');
+        }
+        append(out, "\n};\n");
+    }
 
-    using namespace fmt::literals;
-    _os << fmt::format(dbc_c_file, "messages"_a = dumpMessages(messages),
-               "struct_name"_a = "can_signal_array")
-        << std::endl;
+    _os.write(out.str().data(), static_cast<std::streamsize>(out.str().size()));
 }
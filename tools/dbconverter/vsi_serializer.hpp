@@ -1,16 +1,23 @@
 #ifndef VSI_SERIALIZER_HPP_HLKO0MUA
 #define VSI_SERIALIZER_HPP_HLKO0MUA
 
-#include <fstream>
+#include "cantypes.hpp"
 
-struct CANdb_t;
+#include <fstream>
 
+/**
+ * C source for VSI consumers: can_signal_array with the signals of all
+ * messages, can_message_array sorted by canId with the offset and count of
+ * every message's signals (binary search) and, unless disabled,
+ * can_message_index mapping 11-bit ids to can_message_array slots.
+ */
 struct VSISerializer {
-    VSISerializer(std::ostream& os);
+    VSISerializer(std::ostream& os, bool directIndex = true);
     void operator()(const CANdb_t& db);
 
 private:
     std::ostream& _os;
+    bool _directIndex;
 };
 
 